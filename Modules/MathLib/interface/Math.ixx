@@ -2,25 +2,63 @@ module;
 
 export module Math;
 
+import <span>;
+
 export namespace Math
 {
     constexpr float Pi = 3.14159265359f;
     constexpr float TwoPi = 2.0f * Pi;
     constexpr float HalfPi = Pi / 2.0f;
 
+    // Logs each conversion (see Print module).
     float RadiansToDegrees(float radians);
 
     float DegressToRadians(float degrees);
 
+    // Same conversions without logging, usable in constant expressions.
+    constexpr float ToDegrees(float radians)
+    {
+        return radians * (180.0f / Pi);
+    }
+
+    constexpr float ToRadians(float degrees)
+    {
+        return degrees * (Pi / 180.0f);
+    }
+
+    // Converts all the angles, 4 at a time with SIMD when available, without logging.
+    // Output can be the same span as the input. Only min(input.size(), output.size())
+    // elements are written.
+    void RadiansToDegrees(std::span<const float> radians, std::span<float> degrees);
+
+    void DegressToRadians(std::span<const float> degrees, std::span<float> radians);
+
     template<typename T>
-    const T& Max(const T& lhs, const T& rhs)
+    constexpr const T& Max(const T& lhs, const T& rhs)
     {
         return (lhs > rhs) ? lhs : rhs;
     }
 
     template<typename T>
-    const T& Min(const T& lhs, const T& rhs)
+    constexpr const T& Min(const T& lhs, const T& rhs)
     {
         return (lhs < rhs) ? lhs : rhs;
     }
+
+    template<typename T>
+    constexpr const T& Clamp(const T& value, const T& min, const T& max)
+    {
+        return Min(Max(value, min), max);
+    }
+
+    // Smallest and biggest values, with SIMD when available. Min returns +infinity and Max
+    // -infinity for empty spans. With NaNs the result depends on their positions.
+    float Min(std::span<const float> values);
+
+    float Max(std::span<const float> values);
+
+    // Clamps all the values, with SIMD when available. Same results as the scalar Clamp.
+    // Output can be the same span as the input. Only min(input.size(), output.size())
+    // elements are written.
+    void Clamp(std::span<const float> values, float min, float max, std::span<float> output);
 }
@@ -1,23 +1,141 @@
 module;
 
+// Define MATH_SSE2 as 0 to use the scalar version on x86 too.
+#ifndef MATH_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SSE2 1
+#else
+#define MATH_SSE2 0
+#endif
+#endif
+
+#if MATH_SSE2
+#include <emmintrin.h>
+#endif
+
 module Math;
 
-import <format>;
+import <span>;
+import <limits>;
+import <algorithm>;
 import Print;
 
 namespace Math
 {
+    namespace
+    {
+        // Multiplies all the values by the factor, 4 at a time.
+        void Scale(std::span<const float> input, float factor, std::span<float> output)
+        {
+            const std::size_t count = std::min(input.size(), output.size());
+            std::size_t i = 0;
+#if MATH_SSE2
+            const __m128 factors = _mm_set1_ps(factor);
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(output.data() + i, _mm_mul_ps(_mm_loadu_ps(input.data() + i), factors));
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                output[i] = input[i] * factor;
+            }
+        }
+    }
+
     float RadiansToDegrees(float radians)
     {
-        const float degrees = radians * 180.0f / Pi;
-        Print::PrintMsg(std::format("RadiansToDegrees {} -> {}", radians, degrees));
+        const float degrees = ToDegrees(radians);
+        Print::Debug("RadiansToDegrees {} -> {}", radians, degrees);
         return degrees;
     }
 
     float DegressToRadians(float degrees)
     {
-        const float radians = degrees * Pi / 180.0f;
-        Print::PrintMsg(std::format("DegressToRadians {} -> {}", degrees, radians));
+        const float radians = ToRadians(degrees);
+        Print::Debug("DegressToRadians {} -> {}", degrees, radians);
         return radians;
     }
+
+    // Same multiplication as ToDegrees and ToRadians, so the results are the same.
+    void RadiansToDegrees(std::span<const float> radians, std::span<float> degrees)
+    {
+        Scale(radians, 180.0f / Pi, degrees);
+    }
+
+    void DegressToRadians(std::span<const float> degrees, std::span<float> radians)
+    {
+        Scale(degrees, Pi / 180.0f, radians);
+    }
+
+    // The SIMD versions keep 4 minimums (or maximums), one per lane, combined at the end.
+    // _mm_min_ps(a, b) is (a < b) ? a : b, the same as Min(a, b), and _mm_max_ps the same as Max.
+    float Min(std::span<const float> values)
+    {
+        float result = std::numeric_limits<float>::infinity();
+        std::size_t i = 0;
+#if MATH_SSE2
+        if (values.size() >= 4)
+        {
+            __m128 minimums = _mm_loadu_ps(values.data());
+            for (i = 4; i + 4 <= values.size(); i += 4)
+            {
+                minimums = _mm_min_ps(minimums, _mm_loadu_ps(values.data() + i));
+            }
+
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, minimums);
+            result = Min(Min(lanes[0], lanes[1]), Min(lanes[2], lanes[3]));
+        }
+#endif
+        for (; i < values.size(); ++i)
+        {
+            result = Min(result, values[i]);
+        }
+        return result;
+    }
+
+    float Max(std::span<const float> values)
+    {
+        float result = -std::numeric_limits<float>::infinity();
+        std::size_t i = 0;
+#if MATH_SSE2
+        if (values.size() >= 4)
+        {
+            __m128 maximums = _mm_loadu_ps(values.data());
+            for (i = 4; i + 4 <= values.size(); i += 4)
+            {
+                maximums = _mm_max_ps(maximums, _mm_loadu_ps(values.data() + i));
+            }
+
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, maximums);
+            result = Max(Max(lanes[0], lanes[1]), Max(lanes[2], lanes[3]));
+        }
+#endif
+        for (; i < values.size(); ++i)
+        {
+            result = Max(result, values[i]);
+        }
+        return result;
+    }
+
+    void Clamp(std::span<const float> values, float min, float max, std::span<float> output)
+    {
+        const std::size_t count = std::min(values.size(), output.size());
+        std::size_t i = 0;
+#if MATH_SSE2
+        const __m128 minimums = _mm_set1_ps(min);
+        const __m128 maximums = _mm_set1_ps(max);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values.data() + i), minimums), maximums);
+            _mm_storeu_ps(output.data() + i, clamped);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            output[i] = Clamp(values[i], min, max);
+        }
+    }
 }
@@ -1,10 +1,99 @@
 module;
 
+// Messages below this level are removed at compile time, they cost nothing.
+// 0 Debug, 1 Info, 2 Warning, 3 Error, 4 Off. Set by PRINTLIB_MIN_LEVEL in CMake.
+#ifndef PRINT_MIN_LEVEL
+#define PRINT_MIN_LEVEL 0
+#endif
+
 export module Print;
 
 import <string>;
+import <string_view>;
+import <format>;
+import <algorithm>;
+import <utility>;
+
+// --------------------------------------------------------------------------------
+// Asynchronous print
+//
+// Messages are formatted with std::format_to_n into a buffer on the stack (no allocations),
+// and copied into a buffer of the calling thread without locks. A background thread
+// prints the messages of all the threads in batches, so the thread logging doesn't wait
+// for the console. Messages of the same thread are printed in order, but messages of
+// different threads can be printed in a different order than they were logged.
+//
+// When the buffer of a thread is full, the thread waits for the background thread to
+// print it, messages are never lost. Flush waits until all the messages are printed.
+// At exit the pending messages are printed, and the later ones (logged while static
+// objects are destroyed) are printed right away by the thread logging them.
+// --------------------------------------------------------------------------------
 
 export namespace Print
 {
+    enum class Level
+    {
+        Debug,
+        Info,
+        Warning,
+        Error,
+        Off,
+    };
+
+    constexpr Level MinLevel = static_cast<Level>(PRINT_MIN_LEVEL);
+
+    // Longer messages are truncated.
+    constexpr std::size_t MaxMessageSize = 512;
+
+    // Messages below this level are skipped at runtime, before formatting them.
+    void SetLevel(Level level);
+    Level GetLevel();
+
+    // Adds the message to the buffer of the calling thread.
+    void Write(Level level, std::string_view message);
+
+    // Prints all the messages logged before by any thread.
+    void Flush();
+
+    template<Level level, typename... Args>
+    void Log(std::format_string<Args...> format, Args&&... args)
+    {
+        if constexpr (level >= MinLevel && level != Level::Off)
+        {
+            if (level >= GetLevel())
+            {
+                char message[MaxMessageSize];
+                const auto result = std::format_to_n(message, MaxMessageSize, format, std::forward<Args>(args)...);
+                Write(level, std::string_view(message, std::min<std::size_t>(result.size, MaxMessageSize)));
+            }
+        }
+    }
+
+    template<typename... Args>
+    void Debug(std::format_string<Args...> format, Args&&... args)
+    {
+        Log<Level::Debug>(format, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void Info(std::format_string<Args...> format, Args&&... args)
+    {
+        Log<Level::Info>(format, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void Warning(std::format_string<Args...> format, Args&&... args)
+    {
+        Log<Level::Warning>(format, std::forward<Args>(args)...);
+    }
+
+    template<typename... Args>
+    void Error(std::format_string<Args...> format, Args&&... args)
+    {
+        Log<Level::Error>(format, std::forward<Args>(args)...);
+    }
+
+    // Prints the message and a new line right away, without the level. Messages logged
+    // before by any thread are printed first.
     void PrintMsg(const std::string& msg);
 }
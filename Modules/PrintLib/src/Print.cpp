@@ -3,11 +3,331 @@ module;
 module Print;
 
 import <string>;
+import <string_view>;
+import <cstdio>;
+import <cstdlib>;
+import <cstdint>;
+import <cstring>;
+import <atomic>;
+import <memory>;
+import <vector>;
+import <mutex>;
+import <condition_variable>;
+import <thread>;
+import <stop_token>;
+import <chrono>;
+import <algorithm>;
 
 namespace Print
 {
+    namespace
+    {
+        const char* const LevelNames[] = { "Debug", "Info", "Warning", "Error" };
+
+        std::atomic<Level> RuntimeLevel = Level::Debug;
+
+        // Messages of one thread. Ring buffer of bytes with a single producer (the thread)
+        // and a single consumer (the thread printing them while holding the sink's mutex),
+        // so adding and removing messages doesn't need locks.
+        // Each message is stored as a header with its level and size, followed by its chars.
+        class ThreadBuffer
+        {
+        public:
+            static constexpr std::size_t Capacity = 64 * 1024; // Power of 2
+
+            ThreadBuffer()
+                : m_data(std::make_unique<char[]>(Capacity))
+            {
+            }
+
+            // Returns false when there is no room for the message.
+            bool TryPush(Level level, std::string_view message)
+            {
+                const std::uint32_t header = (static_cast<std::uint32_t>(level) << 24) | static_cast<std::uint32_t>(message.size());
+                const std::size_t messageSize = sizeof(header) + message.size();
+
+                const std::size_t write = m_write.load(std::memory_order_relaxed);
+                const std::size_t read = m_read.load(std::memory_order_acquire);
+                if (Capacity - (write - read) < messageSize)
+                {
+                    return false;
+                }
+
+                CopyIn(write, &header, sizeof(header));
+                CopyIn(write + sizeof(header), message.data(), message.size());
+                m_write.store(write + messageSize, std::memory_order_release);
+                return true;
+            }
+
+            bool IsHalfFull() const
+            {
+                return m_write.load(std::memory_order_relaxed) - m_read.load(std::memory_order_relaxed) >= Capacity / 2;
+            }
+
+            // Appends the messages to the text, one per line.
+            void Drain(std::string& text)
+            {
+                std::size_t read = m_read.load(std::memory_order_relaxed);
+                const std::size_t write = m_write.load(std::memory_order_acquire);
+                while (read != write)
+                {
+                    std::uint32_t header;
+                    CopyOut(read, &header, sizeof(header));
+                    const std::size_t size = header & 0x00FFFFFF;
+
+                    text += '[';
+                    text += LevelNames[header >> 24];
+                    text += "] ";
+                    const std::size_t start = text.size();
+                    text.resize(start + size);
+                    CopyOut(read + sizeof(header), text.data() + start, size);
+                    text += '\n';
+
+                    read += sizeof(header) + size;
+                }
+                m_read.store(read, std::memory_order_release);
+            }
+
+            // Set when the thread ends, the buffer is removed once it's drained.
+            void SetThreadFinished()
+            {
+                m_isThreadFinished.store(true, std::memory_order_release);
+            }
+
+            bool IsThreadFinished() const
+            {
+                return m_isThreadFinished.load(std::memory_order_acquire);
+            }
+
+        private:
+            void CopyIn(std::size_t position, const void* data, std::size_t size)
+            {
+                const std::size_t offset = position & (Capacity - 1);
+                const std::size_t firstSize = std::min(size, Capacity - offset);
+                std::memcpy(m_data.get() + offset, data, firstSize);
+                std::memcpy(m_data.get(), static_cast<const char*>(data) + firstSize, size - firstSize);
+            }
+
+            void CopyOut(std::size_t position, void* data, std::size_t size) const
+            {
+                const std::size_t offset = position & (Capacity - 1);
+                const std::size_t firstSize = std::min(size, Capacity - offset);
+                std::memcpy(data, m_data.get() + offset, firstSize);
+                std::memcpy(static_cast<char*>(data) + firstSize, m_data.get(), size - firstSize);
+            }
+
+            std::unique_ptr<char[]> m_data;
+            alignas(64) std::atomic<std::size_t> m_write = 0; // Only written by the producer
+            alignas(64) std::atomic<std::size_t> m_read = 0;  // Only written by the consumer
+            std::atomic<bool> m_isThreadFinished = false;
+        };
+
+        // Buffers of all the threads, and the thread that prints them every FlushInterval,
+        // or sooner when a buffer is half full.
+        class AsyncSink
+        {
+        public:
+            static constexpr std::chrono::milliseconds FlushInterval{ 10 };
+
+            // Intentionally leaked, so it outlives the static objects that log while they are
+            // destroyed (like the workers of a static ThreadPool). It's stopped at exit instead.
+            static AsyncSink& Get()
+            {
+                static AsyncSink* const sink = new AsyncSink();
+                return *sink;
+            }
+
+            // Prints the pending messages and stops the flush thread. Later messages are
+            // printed by the threads writing them (see WakeUp), so they are never lost.
+            void Stop()
+            {
+                m_flushThread.request_stop();
+                m_flushThread.join();
+
+                std::lock_guard lock(m_mutex);
+                m_isStopped.store(true);
+                PrintBuffers();
+            }
+
+            bool IsStopped() const
+            {
+                return m_isStopped.load();
+            }
+
+            // Only locks the first time a thread writes.
+            std::shared_ptr<ThreadBuffer> AddThreadBuffer()
+            {
+                auto buffer = std::make_shared<ThreadBuffer>();
+                std::lock_guard lock(m_mutex);
+                m_buffers.push_back(buffer);
+                return buffer;
+            }
+
+            // Without the lock, a wake up missed by the flush thread only delays it until FlushInterval.
+            // Once stopped there is no flush thread, so the calling thread prints the messages.
+            void WakeUp()
+            {
+                if (IsStopped())
+                {
+                    Flush();
+                }
+                else if (!m_isWakeUpRequested.exchange(true, std::memory_order_relaxed))
+                {
+                    m_wakeUp.notify_one();
+                }
+            }
+
+            void Flush()
+            {
+                std::lock_guard lock(m_mutex);
+                PrintBuffers();
+            }
+
+            // Prints the text right away, after the pending messages.
+            void WriteNow(std::string_view text)
+            {
+                std::lock_guard lock(m_mutex);
+                PrintBuffers();
+                std::fwrite(text.data(), sizeof(char), text.size(), stdout);
+                std::fflush(stdout);
+            }
+
+        private:
+            AsyncSink()
+                : m_flushThread([this](std::stop_token stopToken) { Run(stopToken); })
+            {
+                // Static objects constructed after the sink are destroyed before this runs.
+                std::atexit([]() { Get().Stop(); });
+            }
+
+            void Run(std::stop_token stopToken)
+            {
+                std::unique_lock lock(m_mutex);
+                while (!stopToken.stop_requested())
+                {
+                    m_wakeUp.wait_for(lock, stopToken, FlushInterval,
+                        [this]() { return m_isWakeUpRequested.load(std::memory_order_relaxed); });
+                    m_isWakeUpRequested.store(false, std::memory_order_relaxed);
+
+                    PrintBuffers();
+                }
+            }
+
+            // Called with the mutex locked, so there is only one consumer of the buffers.
+            // All the messages are printed with one fwrite.
+            void PrintBuffers()
+            {
+                m_batch.clear(); // Keeps capacity
+
+                std::erase_if(m_buffers, [this](const std::shared_ptr<ThreadBuffer>& buffer)
+                    {
+                        // Checked before draining, the thread can't add more messages once finished.
+                        const bool isThreadFinished = buffer->IsThreadFinished();
+                        buffer->Drain(m_batch);
+                        return isThreadFinished;
+                    });
+
+                if (!m_batch.empty())
+                {
+                    std::fwrite(m_batch.data(), sizeof(char), m_batch.size(), stdout);
+                    std::fflush(stdout);
+                }
+            }
+
+            std::mutex m_mutex;
+            std::condition_variable_any m_wakeUp;
+            std::atomic<bool> m_isWakeUpRequested = false;
+            std::atomic<bool> m_isStopped = false;
+            std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+            std::string m_batch;
+            std::jthread m_flushThread; // Last, it uses the other members
+        };
+
+        // Trivial, so it can be read after the thread variables are destroyed, by static
+        // objects destroyed after them in the main thread.
+        thread_local bool IsThreadBufferDestroyed = false;
+
+        // Each thread adds its buffer to the sink the first time it writes.
+        class ThreadBufferOwner
+        {
+        public:
+            ThreadBufferOwner()
+                : m_buffer(AsyncSink::Get().AddThreadBuffer())
+            {
+            }
+
+            ~ThreadBufferOwner()
+            {
+                m_buffer->SetThreadFinished();
+                IsThreadBufferDestroyed = true;
+            }
+
+            ThreadBuffer& GetBuffer()
+            {
+                return *m_buffer;
+            }
+
+        private:
+            std::shared_ptr<ThreadBuffer> m_buffer;
+        };
+    }
+
+    void SetLevel(Level level)
+    {
+        RuntimeLevel.store(level, std::memory_order_relaxed);
+    }
+
+    Level GetLevel()
+    {
+        return RuntimeLevel.load(std::memory_order_relaxed);
+    }
+
+    void Write(Level level, std::string_view message)
+    {
+        if (level >= Level::Off)
+        {
+            return;
+        }
+
+        if (IsThreadBufferDestroyed)
+        {
+            std::string text = "[";
+            text += LevelNames[static_cast<int>(level)];
+            text += "] ";
+            text += message.substr(0, MaxMessageSize);
+            text += '\n';
+            AsyncSink::Get().WriteNow(text);
+            return;
+        }
+
+        thread_local ThreadBufferOwner threadBufferOwner;
+        ThreadBuffer& buffer = threadBufferOwner.GetBuffer();
+        AsyncSink& sink = AsyncSink::Get();
+
+        message = message.substr(0, MaxMessageSize);
+        while (!buffer.TryPush(level, message))
+        {
+            sink.WakeUp();
+            std::this_thread::yield();
+        }
+
+        // Checked after adding the message, so a message added while stopping is printed
+        // either by Stop or here.
+        if (buffer.IsHalfFull() || sink.IsStopped())
+        {
+            sink.WakeUp();
+        }
+    }
+
+    void Flush()
+    {
+        AsyncSink::Get().Flush();
+    }
+
     void PrintMsg(const std::string& msg)
     {
-        printf("%s\n", msg.c_str());
+        std::string text = msg;
+        text += '\n';
+        AsyncSink::Get().WriteNow(text);
     }
 }
@@ -0,0 +1,270 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iterator>
+
+#include "../src/Benchmark.h"
+#include "../src/Instrumentation.h"
+
+void BenchmarkHashTables();
+void BenchmarkOrderedMaps();
+void BenchmarkArenas();
+void BenchmarkTrees();
+void BenchmarkTreeSearch();
+void BenchmarkGraphs(const BenchmarkOptions& options);
+void BenchmarkCounters();
+void BenchmarkReadMostly();
+void BenchmarkQueues();
+void BenchmarkAlgorithms(const BenchmarkOptions& options);
+void BenchmarkFiles();
+void BenchmarkStreams();
+
+// Benchmarks grouped by the file they are in, selected with --subsystems.
+struct Subsystem
+{
+    const char* m_name;
+    void (*m_run)(const BenchmarkOptions& options);
+};
+
+static const Subsystem Subsystems[] = {
+    { "datastructures", [](const BenchmarkOptions&) { BenchmarkHashTables(); BenchmarkOrderedMaps(); BenchmarkArenas(); } },
+    { "trees", [](const BenchmarkOptions&) { BenchmarkTrees(); BenchmarkTreeSearch(); } },
+    { "graphs", [](const BenchmarkOptions& options) { BenchmarkGraphs(options); } },
+    { "concurrency", [](const BenchmarkOptions&) { BenchmarkCounters(); BenchmarkReadMostly(); BenchmarkQueues(); } },
+    { "algorithms", [](const BenchmarkOptions& options) { BenchmarkAlgorithms(options); } },
+    { "files", [](const BenchmarkOptions&) { BenchmarkFiles(); } },
+    { "streams", [](const BenchmarkOptions&) { BenchmarkStreams(); } },
+};
+
+// Parses a comma separated list of positive numbers, with an optional K, M or G suffix
+// (powers of 1024) when allowSuffix is true. For example: 4K,1M,512M
+static bool ParseList(const char* text, bool allowSuffix, std::vector<std::size_t>& values)
+{
+    values.clear();
+    while (*text != '\0')
+    {
+        char* end = nullptr;
+        std::size_t value = std::strtoull(text, &end, 10);
+        if (end == text || value == 0)
+        {
+            return false;
+        }
+
+        if (allowSuffix)
+        {
+            switch (*end)
+            {
+            case 'K': value <<= 10; ++end; break;
+            case 'M': value <<= 20; ++end; break;
+            case 'G': value <<= 30; ++end; break;
+            default: break;
+            }
+        }
+
+        values.push_back(value);
+
+        if (*end == ',')
+        {
+            ++end;
+        }
+        else if (*end != '\0')
+        {
+            return false;
+        }
+        text = end;
+    }
+    return !values.empty();
+}
+
+// Parses a comma separated list of subsystem names, marking the selected ones.
+static bool ParseSubsystems(std::string_view text, std::vector<bool>& isSelected)
+{
+    isSelected.assign(std::size(Subsystems), false);
+    while (!text.empty())
+    {
+        const std::size_t comma = text.find(',');
+        const std::string_view name = text.substr(0, comma);
+
+        bool isFound = false;
+        for (std::size_t i = 0; i < std::size(Subsystems); ++i)
+        {
+            if (name == Subsystems[i].m_name)
+            {
+                isSelected[i] = true;
+                isFound = true;
+            }
+        }
+        if (!isFound)
+        {
+            return false;
+        }
+
+        text = (comma == std::string_view::npos) ? std::string_view() : text.substr(comma + 1);
+    }
+    return true;
+}
+
+static void WriteJsonString(FILE* file, const char* text)
+{
+    std::fputc('"', file);
+    for (const char* c = text; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            std::fprintf(file, "\\%c", *c);
+        }
+        else if (static_cast<unsigned char>(*c) < 0x20)
+        {
+            std::fprintf(file, "\\u%04x", static_cast<unsigned int>(*c));
+        }
+        else
+        {
+            std::fputc(*c, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+// One object per result, with the subsystem that printed it, and the zones measured
+// when the instrumentation is enabled (see Instrumentation.h).
+static bool WriteJson(const char* path, const std::vector<std::string>& resultSubsystems)
+{
+    FILE* file = nullptr;
+    if (fopen_s(&file, path, "w") != 0)
+    {
+        return false;
+    }
+
+    const std::vector<BenchmarkResult>& results = GetBenchmarkResults();
+
+    std::fprintf(file, "{\n  \"results\": [");
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        std::fprintf(file, "%s\n    { \"subsystem\": ", (i > 0) ? "," : "");
+        WriteJsonString(file, resultSubsystems[i].c_str());
+        std::fprintf(file, ", \"name\": ");
+        WriteJsonString(file, result.m_name.c_str());
+        std::fprintf(file, ", \"milliseconds\": %.6f, \"operations\": %zu, \"bytes\": %zu }",
+            result.m_milliseconds, result.m_operationCount, result.m_byteCount);
+    }
+    std::fprintf(file, "\n  ],\n  \"zones\": [");
+
+    bool isFirstZone = true;
+    for (const Instrumentation::Zone* zone : Instrumentation::GetZones())
+    {
+        const std::uint64_t callCount = zone->m_callCount.load(std::memory_order_relaxed);
+        if (callCount == 0)
+        {
+            continue;
+        }
+
+        std::fprintf(file, "%s\n    { \"name\": ", isFirstZone ? "" : ",");
+        WriteJsonString(file, zone->m_name);
+        std::fprintf(file, ", \"file\": ");
+        WriteJsonString(file, zone->m_file);
+        std::fprintf(file, ", \"line\": %d, \"calls\": %llu, \"milliseconds\": %.6f, \"allocations\": %llu, \"allocatedBytes\": %llu }",
+            zone->m_line,
+            static_cast<unsigned long long>(callCount),
+            Instrumentation::TicksToMilliseconds(zone->m_ticks.load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(zone->m_allocationCount.load(std::memory_order_relaxed)),
+            static_cast<unsigned long long>(zone->m_allocatedBytes.load(std::memory_order_relaxed)));
+        isFirstZone = false;
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+
+    const bool isWritten = std::ferror(file) == 0;
+    std::fclose(file);
+    return isWritten;
+}
+
+static void PrintUsage()
+{
+    std::printf(
+        "Usage: bench [--subsystems=<name>,...] [--sizes=<n>,<n>,...] [--threads=<n>,<n>,...] [--json=<file>]\n"
+        "  --subsystems  Benchmarks to run, all by default. Names:");
+    for (const Subsystem& subsystem : Subsystems)
+    {
+        std::printf(" %s", subsystem.m_name);
+    }
+    std::printf(
+        "\n"
+        "  --sizes       Problem sizes, with optional K, M or G suffix: number of elements of the\n"
+        "                algorithm benchmarks and number of vertices of the graph benchmarks.\n"
+        "                For example --sizes=4K,1M,512M. Ranges of 512M doubles take 4 GB each.\n"
+        "  --threads     Number of threads of the scaling benchmarks. For example --threads=1,2,4,8\n"
+        "  --json        Also writes the results to a JSON file, to compare them between versions.\n");
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    std::vector<bool> isSubsystemSelected(std::size(Subsystems), true);
+    const char* jsonPath = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        std::vector<std::size_t> values;
+
+        if (argument.starts_with("--sizes=") &&
+            ParseList(argv[i] + std::strlen("--sizes="), true, values))
+        {
+            options.m_sizes = values;
+        }
+        else if (argument.starts_with("--threads=") &&
+            ParseList(argv[i] + std::strlen("--threads="), false, values))
+        {
+            options.m_threadCounts.assign(values.begin(), values.end());
+        }
+        else if (argument.starts_with("--subsystems="))
+        {
+            if (!ParseSubsystems(argument.substr(std::strlen("--subsystems=")), isSubsystemSelected))
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (argument.starts_with("--json=") && argument.size() > std::strlen("--json="))
+        {
+            jsonPath = argv[i] + std::strlen("--json=");
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::printf("C++ Reminder Benchmarks\n\n");
+
+    // Subsystem of each result, in the same order as GetBenchmarkResults.
+    std::vector<std::string> resultSubsystems;
+
+    for (std::size_t i = 0; i < std::size(Subsystems); ++i)
+    {
+        if (isSubsystemSelected[i])
+        {
+            {
+                // Total of the subsystem, including the setup that isn't measured by the benchmarks.
+                const Instrumentation::ScopedTimer timer(Subsystems[i].m_name);
+                Subsystems[i].m_run(options);
+            }
+            std::printf("\n");
+            resultSubsystems.resize(GetBenchmarkResults().size(), Subsystems[i].m_name);
+        }
+    }
+
+    Instrumentation::PrintZones();
+
+    if (jsonPath && !WriteJson(jsonPath, resultSubsystems))
+    {
+        std::printf("Couldn't write %s\n", jsonPath);
+        return 1;
+    }
+
+    return 0;
+}
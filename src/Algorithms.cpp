@@ -3,6 +3,17 @@
 #include <algorithm>
 #include <numeric>
 #include <execution>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+#include "ThreadPool.h"
+#include "Benchmark.h"
+#include "Instrumentation.h"
 
 // Characteristic to classify the algorithms:
 // - Index Viewed: 1 Index means 1 lookup in the range. 2 Index means 2 lookups in the range (current and next).
@@ -24,17 +35,23 @@ namespace
     }
 
     // std::adjacent_reduce doesn't exist in STL, but it can be written
-    // as an specialization of transform_reduce.
+    // as an specialization of transform_reduce (see the version with execution policy).
+    // 
+    // NOTE: std::transform_reduce can reorder the operations even without execution policy
+    //       (and some implementations do), so it requires the reduce operator to be associative,
+    //       commutative and to accept transformed elements as accumulators. This version
+    //       accumulates in order, so any accumulator works (like the string one in AdjacentReduce).
     template<class I, class A, class R, class T>
     auto adjacent_reduce(I begin, I end, A accInit, R reduce, T transform)
     {
-        // NOTE: Using a copy of begin instead of ++begin in the third parameter because the
-        // the order of execution of parameters in a function call is not determined. So if
-        // the third argument would be executed first, that would affect the value passed to
-        // the first argument. Making a copy avoids this issue.
-        I beginCopy = begin;
-
-        return std::transform_reduce(begin, --end, ++beginCopy, accInit, reduce, transform);
+        if (begin != end)
+        {
+            for (I next = std::next(begin); next != end; ++begin, ++next)
+            {
+                accInit = reduce(std::move(accInit), transform(*begin, *next));
+            }
+        }
+        return accInit;
     }
 
     // std::adjacent_inclusive_scan doesn't exist in STL.
@@ -77,21 +94,284 @@ namespace
             auto acc = accInit; // Accumulator starts with the provided initial value
             *out = acc;
 
-            // First accumulation operation with first element before starting loop using adjacent elements.
-            acc = accOp(acc, *begin);
-            *++out = acc;
             --end; // Since out has 1 more element due to the initial accumulation value, decrease the end by 1.
-
-            while (++begin != end)
+            if (begin != end)
             {
-                acc = accOp(acc, transformOp(*begin, prev));
+                // First accumulation operation with first element before starting loop using adjacent elements.
+                acc = accOp(acc, *begin);
                 *++out = acc;
-                prev = std::move(*begin);
+
+                while (++begin != end)
+                {
+                    acc = accOp(acc, transformOp(*begin, prev));
+                    *++out = acc;
+                    prev = std::move(*begin);
+                }
             }
             ++out;
         }
         return out;
     }
+
+    // std::adjacent_transform_filter_reduce doesn't exist in STL.
+    //
+    // It's the fusion of std::adjacent_difference, std::copy_if and std::reduce: transforms
+    // each pair of adjacent elements, and only the transformed elements that pass the filter are
+    // reduced. Done in one pass keeping the previous element, without writing the transformed
+    // elements to a temporary range. So it reads the input once, instead of reading it, writing
+    // and reading the transformed range (and the filtered one) as when chaining the algorithms.
+    //
+    // For example, the sum of the positive deltas (total ascent) of a series of heights:
+    // adjacent_transform_filter_reduce(begin, end, 0, std::plus<>(), [](int a, int b) { return b - a; }, [](int delta) { return delta > 0; })
+    //
+    // It works with input iterators (like std::istream_iterator), as each element is read once.
+    template<class I, class A, class R, class T, class F>
+    auto adjacent_transform_filter_reduce(I begin, I end, A accInit, R reduce, T transform, F filter)
+    {
+        if (begin != end)
+        {
+            auto prev = *begin;
+            while (++begin != end)
+            {
+                auto transformed = transform(prev, *begin);
+                if (filter(transformed))
+                {
+                    accInit = reduce(std::move(accInit), std::move(transformed));
+                }
+                prev = *begin;
+            }
+        }
+        return accInit;
+    }
+
+    // ----------------------------------------------------------------
+    // Versions with execution policy of the adjacent algorithms above.
+    //
+    // With std::execution::seq (or unseq) they behave like the versions without policy.
+    // With std::execution::par or par_unseq they run in parallel, so as with the parallel
+    // std algorithms the operations must not have side effects and:
+    // - adjacent_reduce: reduce operator must be associative and commutative, and accept
+    //   accumulators and transformed elements in any order (it's std::transform_reduce).
+    // - adjacent_inclusive_scan/adjacent_exclusive_scan: accumulator operator must be
+    //   associative and accept two accumulators, and the transformed elements must be
+    //   convertible to the accumulator (the element type).
+    // - adjacent_transform_filter_reduce: reduce operator must be associative and commutative,
+    //   accept two accumulators, and the accumulator must be constructible from a transformed element.
+    //
+    // Scans can't be parallelized with a single pass, as each output depends on the previous
+    // one. They use a two-pass blocked scan on the thread pool:
+    // 1. Each block calculates the accumulation of its elements, in parallel.
+    // 2. The accumulations of the previous blocks are combined to get each block's initial
+    //    accumulator, then each block scans its elements starting from it, in parallel.
+    // This takes twice the operations of the serial scan, so it's only worth it for large ranges.
+    //
+    // The loops of each block only have the operators and contiguous reads and writes, so the
+    // compiler can vectorize the ones it can reorder (for example, integer additions).
+
+    template<class ExecutionPolicy>
+    constexpr bool IsExecutionPolicy = std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>;
+
+    // The policies that allow using several threads.
+    template<class ExecutionPolicy>
+    constexpr bool IsParallelPolicy =
+        std::is_same_v<std::remove_cvref_t<ExecutionPolicy>, std::execution::parallel_policy> ||
+        std::is_same_v<std::remove_cvref_t<ExecutionPolicy>, std::execution::parallel_unsequenced_policy>;
+
+    // Smaller ranges run serially, and blocks are never smaller than this.
+    constexpr std::size_t ParallelMinBlockSize = 1 << 14;
+
+    template<class ExecutionPolicy, class I, class A, class R, class T>
+        requires IsExecutionPolicy<ExecutionPolicy>
+    auto adjacent_reduce(ExecutionPolicy&& policy, I begin, I end, A accInit, R reduce, T transform)
+    {
+        INSTRUMENT_ZONE("adjacent_reduce (policy)");
+
+        // std::transform_reduce can reorder the operations even with seq, so the other
+        // policies use the in order version.
+        if constexpr (IsParallelPolicy<ExecutionPolicy>)
+        {
+            if (begin == end)
+            {
+                return accInit;
+            }
+
+            // NOTE: Using a copy of begin instead of ++begin in the third parameter because the
+            // the order of execution of parameters in a function call is not determined. So if
+            // the third argument would be executed first, that would affect the value passed to
+            // the first argument. Making a copy avoids this issue.
+            I beginCopy = begin;
+
+            return std::transform_reduce(std::forward<ExecutionPolicy>(policy), begin, --end, ++beginCopy, accInit, reduce, transform);
+        }
+        else
+        {
+            return adjacent_reduce(begin, end, std::move(accInit), reduce, transform);
+        }
+    }
+
+    // Writes out[i] = [init accOp] y[0] accOp y[1] accOp ... accOp y[i], for i in [0, count),
+    // where y[0] = begin[0] and y[i] = transformOp(begin[i], begin[i - 1]).
+    template<class I, class O, class Acc, class BinOp1, class BinOp2>
+    void ParallelAdjacentScan(I begin, std::size_t count, O out, std::optional<Acc> init, BinOp1 accOp, BinOp2 transformOp,
+        ThreadPool& threadPool = ThreadPool::GetDefault())
+    {
+        const std::size_t maxBlockCount = 4 * static_cast<std::size_t>(threadPool.GetWorkerCount());
+        const std::size_t blockCount = std::clamp<std::size_t>(count / ParallelMinBlockSize, 1, maxBlockCount);
+        const std::size_t blockSize = (count + blockCount - 1) / blockCount;
+
+        auto element = [begin, &transformOp](std::size_t i) -> Acc
+            {
+                return (i == 0) ? Acc(begin[0]) : Acc(transformOp(begin[i], begin[i - 1]));
+            };
+
+        // Pass 1: Accumulation of each block, except the last one which is not needed.
+        std::vector<std::optional<Acc>> blockAccumulators(blockCount);
+        threadPool.ParallelFor(0, blockCount - 1, [&](std::size_t block)
+            {
+                const std::size_t first = block * blockSize;
+                const std::size_t last = first + blockSize;
+
+                Acc acc = element(first);
+                for (std::size_t i = first + 1; i < last; ++i)
+                {
+                    acc = accOp(std::move(acc), transformOp(begin[i], begin[i - 1]));
+                }
+                blockAccumulators[block].emplace(std::move(acc));
+            }, 1);
+
+        // Initial accumulator of each block, accumulating the previous blocks. Done serially
+        // as there are only a few blocks. Reuses the vector, shifting the values by one block.
+        std::optional<Acc> blockInit = std::move(init);
+        for (std::size_t block = 0; block < blockCount; ++block)
+        {
+            std::optional<Acc> blockAcc = std::move(blockAccumulators[block]);
+            blockAccumulators[block] = blockInit;
+            if (blockAcc)
+            {
+                blockInit.emplace(blockInit ? accOp(std::move(*blockInit), std::move(*blockAcc)) : std::move(*blockAcc));
+            }
+        }
+
+        // Pass 2: Scan of each block starting with its initial accumulator.
+        threadPool.ParallelFor(0, blockCount, [&](std::size_t block)
+            {
+                const std::size_t first = block * blockSize;
+                const std::size_t last = std::min(first + blockSize, count);
+
+                Acc acc = blockAccumulators[block]
+                    ? accOp(*blockAccumulators[block], element(first))
+                    : element(first);
+                out[first] = acc;
+                for (std::size_t i = first + 1; i < last; ++i)
+                {
+                    acc = accOp(std::move(acc), transformOp(begin[i], begin[i - 1]));
+                    out[i] = acc;
+                }
+            }, 1);
+    }
+
+    template<class ExecutionPolicy, class I, class O, class BinOp1, class BinOp2>
+        requires IsExecutionPolicy<ExecutionPolicy>
+    auto adjacent_inclusive_scan(ExecutionPolicy&&, I begin, I end, O out, BinOp1 accOp, BinOp2 transformOp)
+    {
+        INSTRUMENT_ZONE("adjacent_inclusive_scan (policy)");
+
+        if constexpr (IsParallelPolicy<ExecutionPolicy> && std::random_access_iterator<I> && std::random_access_iterator<O>)
+        {
+            const std::size_t count = static_cast<std::size_t>(std::distance(begin, end));
+            if (count >= 2 * ParallelMinBlockSize)
+            {
+                using Acc = std::iter_value_t<I>;
+                ParallelAdjacentScan(begin, count, out, std::optional<Acc>(), accOp, transformOp);
+                return out + count;
+            }
+        }
+
+        return adjacent_inclusive_scan(begin, end, out, accOp, transformOp);
+    }
+
+    template<class ExecutionPolicy, class I, class O, class A, class BinOp1, class BinOp2>
+        requires IsExecutionPolicy<ExecutionPolicy>
+    auto adjacent_exclusive_scan(ExecutionPolicy&&, I begin, I end, O out, A accInit, BinOp1 accOp, BinOp2 transformOp)
+    {
+        INSTRUMENT_ZONE("adjacent_exclusive_scan (policy)");
+
+        if constexpr (IsParallelPolicy<ExecutionPolicy> && std::random_access_iterator<I> && std::random_access_iterator<O>)
+        {
+            const std::size_t count = static_cast<std::size_t>(std::distance(begin, end));
+            if (count >= 2 * ParallelMinBlockSize)
+            {
+                // Same as the inclusive scan of the first count - 1 elements
+                // starting with accInit, after writing accInit.
+                using Acc = std::iter_value_t<I>;
+                *out = accInit;
+                ParallelAdjacentScan(begin, count - 1, out + 1, std::optional<Acc>(accInit), accOp, transformOp);
+                return out + count;
+            }
+        }
+
+        return adjacent_exclusive_scan(begin, end, out, accInit, accOp, transformOp);
+    }
+
+    // Each block of the range is reduced in parallel on the thread pool, reading the element after
+    // the end of the block as lookback, and then the accumulations of the blocks are reduced.
+    template<class ExecutionPolicy, class I, class A, class R, class T, class F>
+        requires IsExecutionPolicy<ExecutionPolicy>
+    auto adjacent_transform_filter_reduce(ExecutionPolicy&&, I begin, I end, A accInit, R reduce, T transform, F filter)
+    {
+        INSTRUMENT_ZONE("adjacent_transform_filter_reduce (policy)");
+
+        if constexpr (IsParallelPolicy<ExecutionPolicy> && std::random_access_iterator<I>)
+        {
+            const std::size_t count = static_cast<std::size_t>(std::distance(begin, end));
+            if (count >= 2 * ParallelMinBlockSize)
+            {
+                ThreadPool& threadPool = ThreadPool::GetDefault();
+
+                // Blocks of pairs of adjacent elements, pair i is (begin[i], begin[i + 1]).
+                const std::size_t pairCount = count - 1;
+                const std::size_t maxBlockCount = 4 * static_cast<std::size_t>(threadPool.GetWorkerCount());
+                const std::size_t blockCount = std::clamp<std::size_t>(pairCount / ParallelMinBlockSize, 1, maxBlockCount);
+                const std::size_t blockSize = (pairCount + blockCount - 1) / blockCount;
+
+                // Empty for blocks without elements passing the filter.
+                std::vector<std::optional<A>> blockAccumulators(blockCount);
+                threadPool.ParallelFor(0, blockCount, [&](std::size_t block)
+                    {
+                        const std::size_t first = block * blockSize;
+                        const std::size_t last = std::min(first + blockSize, pairCount);
+
+                        std::optional<A>& blockAcc = blockAccumulators[block];
+                        for (std::size_t i = first; i < last; ++i)
+                        {
+                            auto transformed = transform(begin[i], begin[i + 1]);
+                            if (filter(transformed))
+                            {
+                                if (blockAcc)
+                                {
+                                    blockAcc = reduce(std::move(*blockAcc), std::move(transformed));
+                                }
+                                else
+                                {
+                                    blockAcc.emplace(std::move(transformed));
+                                }
+                            }
+                        }
+                    }, 1);
+
+                for (std::optional<A>& blockAcc : blockAccumulators)
+                {
+                    if (blockAcc)
+                    {
+                        accInit = reduce(std::move(accInit), std::move(*blockAcc));
+                    }
+                }
+                return accInit;
+            }
+        }
+
+        return adjacent_transform_filter_reduce(begin, end, accInit, reduce, transform, filter);
+    }
 }
 
 // --------------------
@@ -421,6 +701,47 @@ void AdjacentReduce()
             return currentElement * nextElement;
         });
     std::printf("adjacent_reduce: %s\n", result.c_str());
+
+    // --------------------------------------------------------
+    // Version with execution policy, it uses std::transform_reduce with the same policy.
+    // The string accumulator above can't run in parallel, as its operator is not commutative.
+    std::vector<long long> largeNumbers(1000000);
+    std::iota(largeNumbers.begin(), largeNumbers.end(), 0ll);
+
+    const long long sumOfProducts = adjacent_reduce(std::execution::par_unseq,
+        largeNumbers.cbegin(), largeNumbers.cend(), 0ll, std::plus<>(), std::multiplies<>());
+    const long long serialSumOfProducts = adjacent_reduce(
+        largeNumbers.cbegin(), largeNumbers.cend(), 0ll, std::plus<>(), std::multiplies<>());
+    std::printf("adjacent_reduce with std::execution::par_unseq: %lld (same as serial? %s)\n",
+        sumOfProducts, (sumOfProducts == serialSumOfProducts) ? "YES" : "NO");
+
+    // --------------------------------------------------------
+    // Fused adjacent transform, filter and reduce in one pass, without intermediate ranges.
+    // Total ascent: sum of the deltas between adjacent elements that are positive.
+    auto delta = [](int currentElement, int nextElement) { return nextElement - currentElement; };
+    auto isAscent = [](int transformedElement) { return transformedElement > 0; };
+
+    const int totalAscent = adjacent_transform_filter_reduce(numbers.cbegin(), numbers.cend(), 0, std::plus<>(), delta, isAscent);
+    std::printf("adjacent_transform_filter_reduce total ascent: %d\n", totalAscent);
+
+    // Same result chaining the algorithms, which needs 2 temporary ranges.
+    std::vector<int> deltas(numbers.size());
+    std::adjacent_difference(numbers.cbegin(), numbers.cend(), deltas.begin());
+    std::vector<int> ascents;
+    std::copy_if(deltas.cbegin() + 1, deltas.cend(), std::back_inserter(ascents), isAscent);
+    std::printf("std::adjacent_difference + std::copy_if + std::reduce total ascent: %d\n",
+        std::reduce(ascents.cbegin(), ascents.cend(), 0));
+
+    const long long largeTotalAscent = adjacent_transform_filter_reduce(std::execution::par,
+        largeNumbers.cbegin(), largeNumbers.cend(), 0ll, std::plus<>(),
+        [](long long currentElement, long long nextElement) { return (nextElement % 7) - (currentElement % 7); },
+        [](long long transformedElement) { return transformedElement > 0; });
+    const long long serialLargeTotalAscent = adjacent_transform_filter_reduce(
+        largeNumbers.cbegin(), largeNumbers.cend(), 0ll, std::plus<>(),
+        [](long long currentElement, long long nextElement) { return (nextElement % 7) - (currentElement % 7); },
+        [](long long transformedElement) { return transformedElement > 0; });
+    std::printf("adjacent_transform_filter_reduce with std::execution::par: %lld (same as serial? %s)\n",
+        largeTotalAscent, (largeTotalAscent == serialLargeTotalAscent) ? "YES" : "NO");
 }
 
 // Indexes Viewed: 2
@@ -476,6 +797,36 @@ void AdjacentInclusiveScan_AdjacentExclusiveScan()
     std::printf("adjacent_exclusive_scan: ");
     PrintContainer(transformedNumbers);
     std::printf("\n");
+
+    // --------------------------------------------------------
+    // Versions with execution policy, parallel scans for large ranges.
+    // For example, decoding a time series of timestamps stored as deltas: inclusive scan
+    // adding the deltas, where deltas are the difference with the previous element.
+    std::vector<long long> timestamps(1000000);
+    for (std::size_t i = 0; i < timestamps.size(); ++i)
+    {
+        timestamps[i] = 1000000000ll + static_cast<long long>(i * 10 + i % 7);
+    }
+
+    std::vector<long long> deltas(timestamps.size());
+    std::adjacent_difference(std::execution::par_unseq, timestamps.cbegin(), timestamps.cend(), deltas.begin());
+
+    // The transform operator takes (current, previous) elements, here each delta is used as it is.
+    std::vector<long long> decodedTimestamps(timestamps.size());
+    adjacent_inclusive_scan(std::execution::par_unseq, deltas.cbegin(), deltas.cend(), decodedTimestamps.begin(),
+        std::plus<>(),
+        [](long long currDelta, long long) { return currDelta; });
+    std::printf("adjacent_inclusive_scan with std::execution::par_unseq decoded timestamps: %s\n",
+        (decodedTimestamps == timestamps) ? "YES" : "NO");
+
+    std::vector<long long> parallelScan(timestamps.size());
+    std::vector<long long> serialScan(timestamps.size());
+    adjacent_exclusive_scan(std::execution::par, timestamps.cbegin(), timestamps.cend(), parallelScan.begin(),
+        0ll, std::plus<>(), std::minus<>());
+    adjacent_exclusive_scan(timestamps.cbegin(), timestamps.cend(), serialScan.begin(),
+        0ll, std::plus<>(), std::minus<>());
+    std::printf("adjacent_exclusive_scan with std::execution::par same as serial? %s\n",
+        (parallelScan == serialScan) ? "YES" : "NO");
 }
 
 // ------------------------
@@ -596,3 +947,221 @@ void OtherAlgorithms()
     PrintContainer(iotaOutput);
     std::printf("\n");
 }
+
+// ------------------------------------
+// Benchmarks (run by bench executable)
+// ------------------------------------
+
+namespace
+{
+    // Default sizes go from ranges that fit in L1 cache (2K doubles are 16 KB)
+    // to ranges that only fit in main memory (16M doubles are 128 MB).
+    // Bigger sizes (GBs) can be given in the command line with --sizes.
+    const std::vector<std::size_t> DefaultAlgorithmSizes = { 1 << 11, 1 << 15, 1 << 20, 1 << 24 };
+
+    // Each benchmark is repeated until it processes about this many elements, at least 3 times.
+    constexpr std::size_t ElementsPerBenchmark = 1 << 26;
+
+    int GetRepetitionCount(std::size_t size)
+    {
+        return static_cast<int>(std::clamp<std::size_t>(ElementsPerBenchmark / std::max<std::size_t>(size, 1), 3, 100000));
+    }
+
+    // Powers of 2 up to the number of hardware threads, and the number of hardware threads.
+    std::vector<int> GetDefaultThreadCounts()
+    {
+        const int hardwareThreadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+        std::vector<int> threadCounts;
+        for (int threadCount = 1; threadCount < hardwareThreadCount; threadCount *= 2)
+        {
+            threadCounts.push_back(threadCount);
+        }
+        threadCounts.push_back(hardwareThreadCount);
+        return threadCounts;
+    }
+
+    // Calls function(policyName, policy) with each execution policy.
+    template<class Function>
+    void ForEachExecutionPolicy(Function function)
+    {
+        function("seq", std::execution::seq);
+        function("unseq", std::execution::unseq);
+        function("par", std::execution::par);
+        function("par_unseq", std::execution::par_unseq);
+    }
+}
+
+// Runs each family of algorithms with each execution policy and size, and the parallel
+// versions with different number of threads to see how they scale.
+//
+// Elements are doubles. The bytes per second count the bytes of all the ranges read and written,
+// so algorithms limited by memory bandwidth show similar GB/s for the biggest sizes.
+void BenchmarkAlgorithms(const BenchmarkOptions& options)
+{
+    const std::vector<std::size_t>& sizes = options.m_sizes.empty() ? DefaultAlgorithmSizes : options.m_sizes;
+    const std::vector<int> threadCounts = options.m_threadCounts.empty() ? GetDefaultThreadCounts() : options.m_threadCounts;
+
+    auto createInput = [](std::size_t size, unsigned int seed)
+    {
+        std::vector<double> input(size);
+        std::mt19937 randomEngine(seed);
+        std::uniform_real_distribution<double> distribution(0.0, 1.0);
+        std::ranges::generate(input, [&]() { return distribution(randomEngine); });
+        return input;
+    };
+
+    char name[64];
+
+    for (std::size_t size : sizes)
+    {
+        const std::vector<double> input1 = createInput(size, 42);
+        const std::vector<double> input2 = createInput(size, 43);
+        std::vector<double> output(size);
+
+        const int repetitionCount = GetRepetitionCount(size);
+        const std::size_t rangeBytes = size * sizeof(double);
+        std::printf("Algorithms with %zu elements (%zu KB per range, best of %d)\n", size, rangeBytes / 1024, repetitionCount);
+
+        // Range count is the number of ranges read and written by the algorithm.
+        auto benchmark = [&](const char* algorithmName, const char* policyName, std::size_t rangeCount, auto function)
+        {
+            std::snprintf(name, sizeof(name), "%s (%s)", algorithmName, policyName);
+            PrintThroughput(name, MeasureBestMilliseconds(repetitionCount, function), size, rangeCount * rangeBytes);
+        };
+
+        ForEachExecutionPolicy([&](const char* policyName, const auto& policy)
+            {
+                benchmark("std::reduce", policyName, 1, [&]()
+                    {
+                        DoNotOptimize(std::reduce(policy, input1.cbegin(), input1.cend(), 0.0));
+                    });
+                benchmark("std::transform_reduce 2 ranges", policyName, 2, [&]()
+                    {
+                        DoNotOptimize(std::transform_reduce(policy, input1.cbegin(), input1.cend(), input2.cbegin(), 0.0));
+                    });
+                benchmark("std::inclusive_scan", policyName, 2, [&]()
+                    {
+                        std::inclusive_scan(policy, input1.cbegin(), input1.cend(), output.begin());
+                        DoNotOptimize(output.back());
+                    });
+                benchmark("std::exclusive_scan", policyName, 2, [&]()
+                    {
+                        std::exclusive_scan(policy, input1.cbegin(), input1.cend(), output.begin(), 0.0);
+                        DoNotOptimize(output.back());
+                    });
+                benchmark("std::find (not found)", policyName, 1, [&]()
+                    {
+                        DoNotOptimize(std::find(policy, input1.cbegin(), input1.cend(), -1.0));
+                    });
+                benchmark("std::transform", policyName, 2, [&]()
+                    {
+                        std::transform(policy, input1.cbegin(), input1.cend(), output.begin(),
+                            [](double element) { return element * 2.0 + 1.0; });
+                        DoNotOptimize(output.back());
+                    });
+                benchmark("std::transform 2 ranges", policyName, 3, [&]()
+                    {
+                        std::transform(policy, input1.cbegin(), input1.cend(), input2.cbegin(), output.begin(), std::multiplies<double>());
+                        DoNotOptimize(output.back());
+                    });
+                benchmark("adjacent_reduce", policyName, 1, [&]()
+                    {
+                        DoNotOptimize(adjacent_reduce(policy, input1.cbegin(), input1.cend(), 0.0, std::plus<double>(), std::multiplies<double>()));
+                    });
+                benchmark("adjacent_inclusive_scan", policyName, 2, [&]()
+                    {
+                        adjacent_inclusive_scan(policy, input1.cbegin(), input1.cend(), output.begin(), std::plus<double>(), std::minus<double>());
+                        DoNotOptimize(output.back());
+                    });
+                benchmark("std::adjacent_difference", policyName, 2, [&]()
+                    {
+                        std::adjacent_difference(policy, input1.cbegin(), input1.cend(), output.begin());
+                        DoNotOptimize(output.back());
+                    });
+
+                // Total ascent fused in one pass, and chaining the algorithms with a temporary range
+                // (the transform_reduce does the filter, returning 0 for the deltas that don't pass it).
+                benchmark("adjacent_transform_filter_reduce", policyName, 1, [&]()
+                    {
+                        DoNotOptimize(adjacent_transform_filter_reduce(policy, input1.cbegin(), input1.cend(), 0.0, std::plus<double>(),
+                            [](double element, double nextElement) { return nextElement - element; },
+                            [](double delta) { return delta > 0.0; }));
+                    });
+                benchmark("adjacent_difference+transform_reduce", policyName, 3, [&]()
+                    {
+                        std::adjacent_difference(policy, input1.cbegin(), input1.cend(), output.begin());
+                        DoNotOptimize(std::transform_reduce(policy, output.cbegin() + 1, output.cend(), 0.0, std::plus<double>(),
+                            [](double delta) { return (delta > 0.0) ? delta : 0.0; }));
+                    });
+            });
+
+        std::printf("\n");
+    }
+
+    // Scaling by number of threads, with the biggest size.
+    //
+    // The number of threads used by std::execution::par can't be configured (it uses all the
+    // threads of the implementation's thread pool, like TBB or the Windows thread pool), so
+    // this uses a ThreadPool with each number of threads instead, splitting the range in chunks
+    // that run the unsequenced algorithms. The speedup is relative to the first thread count.
+    const std::size_t size = *std::ranges::max_element(sizes);
+    const std::vector<double> input = createInput(size, 42);
+    std::vector<double> output(size);
+
+    const int repetitionCount = GetRepetitionCount(size);
+    const std::size_t rangeBytes = size * sizeof(double);
+    std::printf("Algorithms scaling with %zu elements (%zu KB per range, best of %d)\n", size, rangeBytes / 1024, repetitionCount);
+
+    auto benchmarkScaling = [&](const char* algorithmName, std::size_t rangeCount, auto function)
+    {
+        double firstMilliseconds = 0.0;
+        for (int threadCount : threadCounts)
+        {
+            ThreadPool threadPool(threadCount);
+            const std::size_t chunkCount = 4 * static_cast<std::size_t>(threadCount);
+            const std::size_t grainSize = std::max<std::size_t>(1, (size + chunkCount - 1) / chunkCount);
+
+            // Measured from a worker, so the calling thread doesn't help with the chunks
+            // and exactly threadCount threads run them.
+            const double milliseconds = threadPool.Submit([&]()
+                {
+                    return MeasureBestMilliseconds(repetitionCount, [&]() { function(threadPool, grainSize); });
+                }).get();
+
+            if (firstMilliseconds == 0.0)
+            {
+                firstMilliseconds = milliseconds;
+            }
+
+            std::snprintf(name, sizeof(name), "%s %d threads (%.2fx)", algorithmName, threadCount, firstMilliseconds / milliseconds);
+            PrintThroughput(name, milliseconds, size, rangeCount * rangeBytes);
+        }
+    };
+
+    benchmarkScaling("reduce", 1, [&](ThreadPool& threadPool, std::size_t grainSize)
+        {
+            std::vector<double> chunkSums((size + grainSize - 1) / grainSize);
+            threadPool.ParallelForRange(0, size, [&](std::size_t first, std::size_t last)
+                {
+                    chunkSums[first / grainSize] = std::reduce(std::execution::unseq, input.cbegin() + first, input.cbegin() + last, 0.0);
+                }, grainSize);
+            DoNotOptimize(std::reduce(chunkSums.cbegin(), chunkSums.cend(), 0.0));
+        });
+    benchmarkScaling("transform", 2, [&](ThreadPool& threadPool, std::size_t grainSize)
+        {
+            threadPool.ParallelForRange(0, size, [&](std::size_t first, std::size_t last)
+                {
+                    std::transform(std::execution::unseq, input.cbegin() + first, input.cbegin() + last, output.begin() + first,
+                        [](double element) { return element * 2.0 + 1.0; });
+                }, grainSize);
+            DoNotOptimize(output.back());
+        });
+    benchmarkScaling("adjacent_inclusive_scan", 2, [&](ThreadPool& threadPool, std::size_t)
+        {
+            ParallelAdjacentScan(input.cbegin(), size, output.begin(), std::optional<double>(), std::plus<double>(), std::minus<double>(), threadPool);
+            DoNotOptimize(output.back());
+        });
+
+    std::printf("\n");
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdio>
+#include <algorithm>
+#include <cstddef>
+#include <chrono>
+#include <vector>
+#include <string>
+
+// --------------------------------------------------------------------------------
+// Benchmark helpers
+//
+// Used by the Benchmark functions of each file, which are run by the bench executable
+// (see bench/main.cpp) instead of main.
+//
+// Benchmarks must be compiled in Release, Debug builds measure mostly the debug checks.
+// --------------------------------------------------------------------------------
+
+class BenchmarkTimer
+{
+public:
+    BenchmarkTimer()
+        : m_start(std::chrono::steady_clock::now())
+    {
+    }
+
+    void Restart()
+    {
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    double GetElapsedMilliseconds() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Time in milliseconds that takes to call the function once.
+template<typename Function>
+double MeasureMilliseconds(Function&& function)
+{
+    BenchmarkTimer timer;
+    function();
+    return timer.GetElapsedMilliseconds();
+}
+
+// Minimum time in milliseconds of calling the function several times.
+// The minimum discards the repetitions slowed down by cold caches or other processes.
+template<typename Function>
+double MeasureBestMilliseconds(int repetitionCount, Function&& function)
+{
+    double bestMilliseconds = MeasureMilliseconds(function);
+    for (int i = 1; i < repetitionCount; ++i)
+    {
+        bestMilliseconds = std::min(bestMilliseconds, MeasureMilliseconds(function));
+    }
+    return bestMilliseconds;
+}
+
+// Prevents the compiler from removing the calculation of a value that is never used.
+template<typename T>
+void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+    // Reading the value through a volatile pointer forces it to be calculated.
+    [[maybe_unused]] volatile char sink = *reinterpret_cast<const volatile char*>(&value);
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// Result of a benchmark, as printed by PrintBenchmark or PrintThroughput.
+struct BenchmarkResult
+{
+    std::string m_name;
+    double m_milliseconds = 0.0;
+    std::size_t m_operationCount = 0;
+    std::size_t m_byteCount = 0; // 0 when printed without throughput
+};
+
+// All the results printed so far, for the JSON output of the bench executable.
+inline std::vector<BenchmarkResult>& GetBenchmarkResults()
+{
+    static std::vector<BenchmarkResult> results;
+    return results;
+}
+
+// Prints a line with the time and the time per operation.
+inline void PrintBenchmark(const char* name, double milliseconds, std::size_t operationCount)
+{
+    const double nanosecondsPerOperation = (operationCount > 0)
+        ? milliseconds * 1000000.0 / static_cast<double>(operationCount)
+        : 0.0;
+
+    std::printf("%-48s %10.3f ms %10.2f ns/op\n", name, milliseconds, nanosecondsPerOperation);
+    GetBenchmarkResults().push_back({ name, milliseconds, operationCount, 0 });
+}
+
+// Prints a line with the time, the elements per second and the bytes per second.
+// Bytes are the ones read and written by the operation, to compare them with the memory bandwidth.
+inline void PrintThroughput(const char* name, double milliseconds, std::size_t elementCount, std::size_t byteCount)
+{
+    const double seconds = milliseconds / 1000.0;
+    const double megaelementsPerSecond = (seconds > 0.0) ? static_cast<double>(elementCount) / seconds / 1e6 : 0.0;
+    const double gigabytesPerSecond = (seconds > 0.0) ? static_cast<double>(byteCount) / seconds / 1e9 : 0.0;
+
+    std::printf("%-48s %10.3f ms %10.2f Melem/s %8.2f GB/s\n", name, milliseconds, megaelementsPerSecond, gigabytesPerSecond);
+    GetBenchmarkResults().push_back({ name, milliseconds, elementCount, byteCount });
+}
+
+// Options of the bench executable, given in its command line (see bench/main.cpp).
+// Benchmarks that don't use them run with their own fixed sizes.
+struct BenchmarkOptions
+{
+    // Problem sizes: number of elements of the ranges in Algorithms, number of vertices
+    // in Graphs. Empty to use the default sizes of each benchmark.
+    std::vector<std::size_t> m_sizes;
+
+    // Number of threads for the scaling benchmarks. Empty to use the default thread counts.
+    std::vector<int> m_threadCounts;
+};
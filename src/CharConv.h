@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <ranges>
+#include <string_view>
+#include <vector>
+#include <limits>
+#include <bit>
+#include <ostream>
+#include <type_traits>
+#include <system_error>
+
+// --------------------------------------------------------------------------------
+// Char Conversions
+//
+// Numbers to and from text with std::from_chars and std::to_chars (<charconv>), instead of
+// streams (operator>> and operator<<). Streams are slower because each number goes through
+// the locale (digit grouping, decimal point) and through virtual calls to the stream buffer.
+// std::from_chars and std::to_chars are locale-free: they always use '.' and no grouping,
+// they don't allocate nor throw, and they round-trip floating point numbers exactly.
+//
+// NumberTokenizer: reads numbers separated by whitespace from a buffer of text (for example,
+// a whole file read at once or a MemoryMappedFile). ParseNumbers parses all of them into a
+// vector in one call. Integers have a fast path that converts 8 digits at once (SWAR, SIMD
+// Within A Register: the 8 chars are loaded in a 64-bit integer and computed together).
+//
+// BufferedWriter: writes numbers and text into its own buffer, and only writes to the stream
+// when the buffer is full, so the stream is called once every many numbers.
+// --------------------------------------------------------------------------------
+
+namespace CharConvDetail
+{
+    inline bool IsSeparator(char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    // True when the 8 chars are all digits. Each byte is a digit ('0' is 0x30, '9' is 0x39)
+    // when its high half is 3, and adding 6 doesn't carry into the high half.
+    inline bool AreEightDigits(std::uint64_t chars)
+    {
+        return ((chars & 0xF0F0F0F0F0F0F0F0) |
+            (((chars + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+    }
+
+    // Value of 8 digits loaded as a little endian integer (the first char is the lowest byte).
+    // Combines pairs of digits, then pairs of 2 digits and then pairs of 4 digits, 3 multiplications
+    // instead of 8. From "Faster Integer Parsing" by Daniel Lemire.
+    inline std::uint64_t ParseEightDigits(std::uint64_t chars)
+    {
+        chars -= 0x3030303030303030;
+        chars = (chars * 10) + (chars >> 8);
+        chars = (((chars & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+            (((chars >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+        return chars;
+    }
+
+    // Fast path of integers with at most 19 digits, which fit in an uint64_t without overflowing.
+    // Returns false to use std::from_chars instead, for numbers with more digits.
+    template<typename T>
+    bool TryParseInteger(const char* first, const char* last, T& value, const char*& end)
+    {
+        const bool isNegative = std::is_signed_v<T> && first != last && *first == '-';
+        const char* position = first + (isNegative ? 1 : 0);
+        const char* digitsStart = position;
+
+        std::uint64_t magnitude = 0;
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            std::uint64_t chars;
+            while (last - position >= 8 && position - digitsStart <= 11 &&
+                (std::memcpy(&chars, position, 8), AreEightDigits(chars)))
+            {
+                magnitude = magnitude * 100000000 + ParseEightDigits(chars);
+                position += 8;
+            }
+        }
+
+        while (position != last && position - digitsStart < 19 &&
+            static_cast<unsigned char>(*position - '0') <= 9)
+        {
+            magnitude = magnitude * 10 + static_cast<unsigned char>(*position - '0');
+            ++position;
+        }
+
+        if (position == digitsStart ||
+            (position != last && static_cast<unsigned char>(*position - '0') <= 9))
+        {
+            return false; // Not a number, or more than 19 digits
+        }
+
+        using Unsigned = std::make_unsigned_t<T>;
+        const std::uint64_t maxMagnitude = static_cast<std::uint64_t>(std::numeric_limits<T>::max()) + (isNegative ? 1 : 0);
+        if (magnitude > maxMagnitude)
+        {
+            return false; // Out of range
+        }
+
+        value = isNegative
+            ? static_cast<T>(Unsigned(0) - static_cast<Unsigned>(magnitude))
+            : static_cast<T>(magnitude);
+        end = position;
+        return true;
+    }
+}
+
+// Reads the numbers of a text one by one. The text must outlive the tokenizer.
+// A token is invalid when it isn't a number of the type read, it's out of range, or it has
+// other chars after the number ("12ab"). Numbers are in std::from_chars format: no '+',
+// no "0x" and no locale.
+class NumberTokenizer
+{
+public:
+    explicit NumberTokenizer(std::string_view text)
+        : m_position(text.data())
+        , m_end(text.data() + text.size())
+    {
+    }
+
+    // True when there are no more tokens.
+    bool IsEnd()
+    {
+        SkipSeparators();
+        return m_position == m_end;
+    }
+
+    // Reads the next token. Returns false at the end, or if the token is invalid,
+    // in which case the tokenizer stays at the invalid token.
+    template<typename T>
+        requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+    bool Next(T& value)
+    {
+        SkipSeparators();
+        if (m_position == m_end)
+        {
+            return false;
+        }
+
+        const char* end = nullptr;
+        if constexpr (std::is_integral_v<T>)
+        {
+            if (!CharConvDetail::TryParseInteger(m_position, m_end, value, end))
+            {
+                const auto [ptr, error] = std::from_chars(m_position, m_end, value);
+                if (error != std::errc())
+                {
+                    return false;
+                }
+                end = ptr;
+            }
+        }
+        else
+        {
+            const auto [ptr, error] = std::from_chars(m_position, m_end, value);
+            if (error != std::errc())
+            {
+                return false;
+            }
+            end = ptr;
+        }
+
+        if (end != m_end && !CharConvDetail::IsSeparator(*end))
+        {
+            return false;
+        }
+
+        m_position = end;
+        return true;
+    }
+
+    // Position of the next token, or the invalid token.
+    const char* GetPosition() const
+    {
+        return m_position;
+    }
+
+private:
+    void SkipSeparators()
+    {
+        while (m_position != m_end && CharConvDetail::IsSeparator(*m_position))
+        {
+            ++m_position;
+        }
+    }
+
+    const char* m_position = nullptr;
+    const char* m_end = nullptr;
+};
+
+// Parses all the numbers of the text, adding them to the vector.
+// Returns false if there is an invalid token, the numbers before it are added.
+template<typename T>
+bool ParseNumbers(std::string_view text, std::vector<T>& numbers)
+{
+    // Numbers have at least 2 chars with their separator, reserving for all of them
+    // would be too much for long numbers, a quarter of the text is a better estimate.
+    numbers.reserve(numbers.size() + text.size() / 4);
+
+    NumberTokenizer tokenizer(text);
+    T value;
+    while (tokenizer.Next(value))
+    {
+        numbers.push_back(value);
+    }
+    return tokenizer.IsEnd();
+}
+
+// Writes into a buffer of its own and writes the buffer to the stream when it's full,
+// when flushing and when destroyed. Floating point numbers are written in the shortest
+// format that reads back to the same value.
+class BufferedWriter
+{
+public:
+    static constexpr std::size_t DefaultBufferSize = 64 * 1024;
+
+    explicit BufferedWriter(std::ostream& stream, std::size_t bufferSize = DefaultBufferSize)
+        : m_stream(stream)
+        , m_buffer(std::max(bufferSize, MaxNumberSize))
+    {
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    ~BufferedWriter()
+    {
+        Flush();
+    }
+
+    template<typename T>
+        requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+    void Write(T value)
+    {
+        if (m_buffer.size() - m_size < MaxNumberSize)
+        {
+            Flush();
+        }
+
+        const auto [ptr, error] = std::to_chars(m_buffer.data() + m_size, m_buffer.data() + m_buffer.size(), value);
+        m_size = ptr - m_buffer.data(); // Can't fail, there is room for any number
+    }
+
+    void Write(char c)
+    {
+        if (m_size == m_buffer.size())
+        {
+            Flush();
+        }
+        m_buffer[m_size++] = c;
+    }
+
+    // Text bigger than the buffer is written directly to the stream.
+    void Write(std::string_view text)
+    {
+        if (m_buffer.size() - m_size < text.size())
+        {
+            Flush();
+            if (text.size() > m_buffer.size())
+            {
+                m_stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        std::memcpy(m_buffer.data() + m_size, text.data(), text.size());
+        m_size += text.size();
+    }
+
+    // Writes the numbers with the separator after each of them.
+    template<std::ranges::input_range Range>
+    void WriteNumbers(const Range& numbers, char separator = '\n')
+    {
+        for (const auto& number : numbers)
+        {
+            Write(number);
+            Write(separator);
+        }
+    }
+
+    void Flush()
+    {
+        if (m_size > 0)
+        {
+            m_stream.write(m_buffer.data(), static_cast<std::streamsize>(m_size));
+            m_size = 0;
+        }
+    }
+
+private:
+    // Enough chars for any integer or the shortest format of any floating point number.
+    static constexpr std::size_t MaxNumberSize = 64;
+
+    std::ostream& m_stream;
+    std::vector<char> m_buffer;
+    std::size_t m_size = 0;
+};
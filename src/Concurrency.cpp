@@ -6,6 +6,20 @@
 #include <shared_mutex>
 #include <future>
 #include <numeric>
+#include <latch>
+#include <new>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <queue>
+#include <condition_variable>
+
+#include "ThreadPool.h"
+#include "LockFreeQueue.h"
+#include "Benchmark.h"
 
 // Helpers
 namespace
@@ -296,9 +310,14 @@ public:
     // Only one thread/writer can increment/write the counter's value.
     void Increment(int threadId)
     {
-        std::unique_lock<std::shared_mutex> lock(m_sharedMutex);
-        ++m_value;
-        printf("Thread %d) Increment Counter %d -> %d\n", threadId, m_value - 1, m_value);
+        int value = 0;
+        {
+            std::unique_lock<std::shared_mutex> lock(m_sharedMutex);
+            value = ++m_value;
+        }
+
+        // Printing after unlocking, so other threads don't wait for it.
+        printf("Thread %d) Increment Counter %d -> %d\n", threadId, value - 1, value);
     }
 
     // Only one thread/writer can reset/write the counter's value.
@@ -403,6 +422,533 @@ void Atomics()
     printf("Main Thread) Threads finished. Counter: %d\n\n", atomicCounter.load());
 }
 
+// Sharded Counters
+//
+// When many threads increment the same std::atomic (or take the same mutex), the cache line
+// with the counter keeps moving between the cores' caches (cache-line ping-pong), so each
+// increment waits for the previous core to give the line back and it doesn't scale.
+//
+// A sharded counter splits the counter into several shards, each one in its own cache line,
+// and each thread only increments its shard. Increments don't touch the other threads' cache
+// lines, so they scale with the number of cores. Reading the counter sums all the shards.
+
+#if defined(__cpp_lib_hardware_interference_size)
+constexpr std::size_t CacheLineSize = std::hardware_destructive_interference_size;
+#else
+constexpr std::size_t CacheLineSize = 64;
+#endif
+
+class ShardedCounter
+{
+public:
+    // Number of shards, 0 to use enough for all hardware threads.
+    explicit ShardedCounter(std::size_t shardCount = 0)
+        : m_shardCount(std::bit_ceil(std::max<std::size_t>(
+            (shardCount > 0) ? shardCount : std::thread::hardware_concurrency(), 1)))
+        , m_shards(std::make_unique<Shard[]>(m_shardCount))
+    {
+    }
+
+    // Only touches the shard of the calling thread.
+    void Add(long long value)
+    {
+        m_shards[GetThreadIndex() & (m_shardCount - 1)].m_value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void Increment()
+    {
+        Add(1);
+    }
+
+    // Sum of all the shards. Exact when there are no increments at the same time,
+    // otherwise it's a value between the ones before and after the call.
+    // It never blocks writers, but it reads all the shards' cache lines.
+    long long Get() const
+    {
+        long long sum = 0;
+        for (std::size_t i = 0; i < m_shardCount; ++i)
+        {
+            sum += m_shards[i].m_value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    // Approximate value, the sum of all the shards calculated at most maxAge ago.
+    // Readers calling it often don't read the shards each time, so writers keep their
+    // cache lines. When the sum is too old, only one reader calculates it again while the
+    // others return the old one, so readers never wait for each other nor for writers.
+    long long GetApproximate(std::chrono::nanoseconds maxAge = std::chrono::milliseconds(1)) const
+    {
+        // Nanoseconds whatever the period of steady_clock is, to compare them with maxAge.
+        const long long now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        if (now - m_approximateTime.load(std::memory_order_acquire) > maxAge.count() &&
+            !m_isUpdatingApproximate.exchange(true, std::memory_order_acquire))
+        {
+            m_approximateValue.store(Get(), std::memory_order_relaxed);
+            m_approximateTime.store(now, std::memory_order_release);
+            m_isUpdatingApproximate.store(false, std::memory_order_release);
+        }
+
+        return m_approximateValue.load(std::memory_order_relaxed);
+    }
+
+    // Not thread safe
+    void Reset()
+    {
+        for (std::size_t i = 0; i < m_shardCount; ++i)
+        {
+            m_shards[i].m_value.store(0, std::memory_order_relaxed);
+        }
+        m_approximateValue.store(0, std::memory_order_relaxed);
+        m_approximateTime.store(std::numeric_limits<long long>::min() / 2, std::memory_order_relaxed);
+    }
+
+private:
+    // Padded to its own cache line to avoid false sharing between shards.
+    struct alignas(CacheLineSize) Shard
+    {
+        std::atomic<long long> m_value = 0;
+    };
+
+    // Threads get consecutive indices the first time they use a counter, so up to
+    // the number of shards threads never share a shard.
+    static std::size_t GetThreadIndex()
+    {
+        static std::atomic<std::size_t> nextThreadIndex = 0;
+        thread_local const std::size_t threadIndex = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+        return threadIndex;
+    }
+
+    std::size_t m_shardCount;
+    std::unique_ptr<Shard[]> m_shards;
+
+    // Approximate value, in its own cache line as it's only written by readers.
+    alignas(CacheLineSize) mutable std::atomic<long long> m_approximateValue = 0;
+    mutable std::atomic<long long> m_approximateTime = std::numeric_limits<long long>::min() / 2; // steady_clock nanoseconds
+    mutable std::atomic<bool> m_isUpdatingApproximate = false;
+};
+
+void ShardedCounters()
+{
+    ShardedCounter shardedCounter;
+
+    auto increment = [&shardedCounter](int n)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                shardedCounter.Increment();
+            }
+        };
+
+    const int numThreads = 10;
+
+    printf("Main Thread) Creating %d threads... \n", numThreads);
+
+    std::vector<std::unique_ptr<std::thread>> threads;
+    threads.reserve(numThreads);
+    for (int i = 0; i < numThreads; ++i)
+    {
+        threads.push_back(
+            std::make_unique<std::thread>(increment, 333));
+    }
+
+    // Reading while threads are incrementing gives a value in between.
+    printf("Main Thread) Counter while threads are running: %lld (approximate %lld)\n",
+        shardedCounter.Get(), shardedCounter.GetApproximate());
+
+    printf("Main Thread) Waiting for threads to finish...\n");
+
+    for (auto& thread : threads)
+    {
+        thread->join();
+    }
+
+    // The approximate value might still be the old one, until it's older than maxAge.
+    printf("Main Thread) Threads finished. Counter: %lld (approximate with max age 0: %lld)\n\n",
+        shardedCounter.Get(), shardedCounter.GetApproximate(std::chrono::nanoseconds(0)));
+}
+
+// Seqlock and RCU
+//
+// Even with a shared_lock, readers write to the shared_mutex to count how many are reading,
+// so the mutex's cache line keeps moving between the readers' cores. For data that is read
+// very often and written rarely (configurations, routing tables, etc.) there are alternatives
+// where readers don't write to any memory shared with other threads.
+//
+// Seqlock: for small trivially copyable values. The writer increments a sequence number
+// before and after writing the value (odd while writing). Readers copy the value and
+// check the sequence number didn't change during the copy, retrying if it did.
+// Readers never block the writer, but they retry while there are writes.
+//
+// RCU (Read-Copy-Update): for larger structures. The value is behind a pointer. Writers copy
+// the value, modify the copy and replace the pointer, so readers see the old or the new
+// value, never a partial one. The old value is deleted once no reader can be using it,
+// which writers know because each reader thread publishes in its own cache line the epoch
+// it started reading in.
+
+// Values are stored as atomic words, so copying them while the writer changes them is not
+// a data race, just a copy that is discarded.
+//
+// Boehm. Can Seqlocks Get Along With Programming Language Memory Models? (2012).
+template<typename T>
+    requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+class SeqLock
+{
+public:
+    explicit SeqLock(const T& value = T{})
+    {
+        WriteWords(value);
+    }
+
+    // Never writes shared memory. Retries while a write happens at the same time.
+    T Load() const
+    {
+        while (true)
+        {
+            const std::uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) == 0)
+            {
+                std::uint64_t words[WordCount];
+                for (std::size_t i = 0; i < WordCount; ++i)
+                {
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                }
+
+                // Loads of the words can't move after reading the sequence number again.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == sequence)
+                {
+                    T value;
+                    std::memcpy(&value, words, sizeof(T));
+                    return value;
+                }
+            }
+            std::this_thread::yield(); // Writer in progress
+        }
+    }
+
+    // Writers wait for each other.
+    void Store(const T& value)
+    {
+        // Odd sequence number while writing.
+        std::uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        while ((sequence & 1) != 0 ||
+            !m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            sequence = m_sequence.load(std::memory_order_relaxed);
+        }
+
+        // Stores of the words can't move before the odd sequence number.
+        std::atomic_thread_fence(std::memory_order_release);
+        WriteWords(value);
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t WordCount = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    void WriteWords(const T& value)
+    {
+        std::uint64_t words[WordCount] = {};
+        std::memcpy(words, &value, sizeof(T));
+        for (std::size_t i = 0; i < WordCount; ++i)
+        {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    alignas(CacheLineSize) std::atomic<std::uint32_t> m_sequence = 0;
+    std::atomic<std::uint64_t> m_words[WordCount];
+};
+
+namespace
+{
+    // Threads reading RCU snapshots, used by the writers to know when readers
+    // stopped using the old values. Shared by all RcuSnapshot objects.
+    class RcuDomain
+    {
+    public:
+        // One per reader thread, in its own cache line as the thread writes it on each read.
+        // Records are reused by new threads once their thread finishes, and never deleted.
+        struct alignas(CacheLineSize) ReaderRecord
+        {
+            std::atomic<std::uint64_t> m_epoch = 0; // 0 while not reading
+            std::atomic<bool> m_isUsed = false;
+            ReaderRecord* m_next = nullptr;
+            int m_nesting = 0; // Only accessed by its thread
+        };
+
+        static RcuDomain& GetInstance()
+        {
+            static RcuDomain domain;
+            return domain;
+        }
+
+        ReaderRecord& GetThreadRecord()
+        {
+            // Releases the record when the thread finishes.
+            struct ThreadRecord
+            {
+                ~ThreadRecord()
+                {
+                    if (m_record)
+                    {
+                        m_record->m_isUsed.store(false, std::memory_order_release);
+                    }
+                }
+
+                ReaderRecord* m_record = nullptr;
+            };
+            thread_local ThreadRecord threadRecord;
+
+            if (!threadRecord.m_record)
+            {
+                threadRecord.m_record = AcquireRecord();
+            }
+            return *threadRecord.m_record;
+        }
+
+        // Readers publish the epoch they start in. The seq_cst fence makes sure that either
+        // the writer sees this epoch, or this reader sees the pointer stored by the writer.
+        void ReadLock(ReaderRecord& record)
+        {
+            if (record.m_nesting++ == 0)
+            {
+                record.m_epoch.store(m_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        void ReadUnlock(ReaderRecord& record)
+        {
+            if (--record.m_nesting == 0)
+            {
+                record.m_epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        // Waits until all readers that started before the call have finished.
+        // Must not be called while reading, as it would wait for itself.
+        void Synchronize()
+        {
+            const std::uint64_t epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+            for (ReaderRecord* record = m_head.load(std::memory_order_acquire); record; record = record->m_next)
+            {
+                for (std::uint64_t readerEpoch = record->m_epoch.load(std::memory_order_seq_cst);
+                    readerEpoch != 0 && readerEpoch < epoch;
+                    readerEpoch = record->m_epoch.load(std::memory_order_seq_cst))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    private:
+        ReaderRecord* AcquireRecord()
+        {
+            // Reuse a record from a finished thread
+            for (ReaderRecord* record = m_head.load(std::memory_order_acquire); record; record = record->m_next)
+            {
+                bool isUsed = false;
+                if (!record->m_isUsed.load(std::memory_order_relaxed) &&
+                    record->m_isUsed.compare_exchange_strong(isUsed, true, std::memory_order_acquire))
+                {
+                    return record;
+                }
+            }
+
+            ReaderRecord* record = new ReaderRecord();
+            record->m_isUsed.store(true, std::memory_order_relaxed);
+            record->m_next = m_head.load(std::memory_order_relaxed);
+            while (!m_head.compare_exchange_weak(record->m_next, record, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+            return record;
+        }
+
+        std::atomic<std::uint64_t> m_epoch = 1;
+        std::atomic<ReaderRecord*> m_head = nullptr;
+    };
+}
+
+template<typename T>
+class RcuSnapshot
+{
+public:
+    explicit RcuSnapshot(std::unique_ptr<const T> value)
+        : m_value(value.release())
+    {
+    }
+
+    // No threads can be reading it.
+    ~RcuSnapshot()
+    {
+        delete m_value.load(std::memory_order_relaxed);
+    }
+
+    RcuSnapshot(const RcuSnapshot&) = delete;
+    RcuSnapshot& operator=(const RcuSnapshot&) = delete;
+
+    // Keeps the value alive while it exists. Writers wait for it to be destroyed
+    // to delete old values, so it must not be kept for long.
+    class ReadGuard
+    {
+    public:
+        ~ReadGuard()
+        {
+            RcuDomain::GetInstance().ReadUnlock(m_record);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T& operator*() const { return *m_value; }
+        const T* operator->() const { return m_value; }
+
+    private:
+        friend class RcuSnapshot;
+
+        ReadGuard(RcuDomain::ReaderRecord& record, const T* value)
+            : m_record(record)
+            , m_value(value)
+        {
+        }
+
+        RcuDomain::ReaderRecord& m_record;
+        const T* m_value;
+    };
+
+    // Only writes the reader record of the calling thread.
+    ReadGuard Read() const
+    {
+        RcuDomain& domain = RcuDomain::GetInstance();
+        RcuDomain::ReaderRecord& record = domain.GetThreadRecord();
+        domain.ReadLock(record);
+        return ReadGuard(record, m_value.load(std::memory_order_acquire));
+    }
+
+    // Replaces the value and deletes the old one once no reader uses it.
+    // Must not be called while the thread is reading.
+    void Update(std::unique_ptr<const T> value)
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        Replace(value.release());
+    }
+
+    // Copies the value, modifies the copy with the function and replaces the value with it.
+    // Writers wait for each other, so no modification is lost.
+    template<typename Function>
+    void Modify(Function&& modify)
+    {
+        std::lock_guard<std::mutex> lock(m_writerMutex);
+        auto value = std::make_unique<T>(*m_value.load(std::memory_order_relaxed));
+        modify(*value);
+        Replace(value.release());
+    }
+
+private:
+    void Replace(const T* value)
+    {
+        const T* oldValue = m_value.exchange(value, std::memory_order_seq_cst);
+        RcuDomain::GetInstance().Synchronize();
+        delete oldValue;
+    }
+
+    std::atomic<const T*> m_value;
+    std::mutex m_writerMutex;
+};
+
+void ReadMostlyData()
+{
+    // Seqlock: readers always see the 3 values from the same write.
+    struct Settings
+    {
+        int m_width;
+        int m_height;
+        double m_scale;
+    };
+    SeqLock<Settings> settings(Settings{ 0, 0, 0.0 });
+    std::atomic<bool> isWriting = true;
+    std::atomic<int> inconsistentReads = 0;
+
+    std::thread settingsWriter([&settings, &isWriting]()
+        {
+            for (int i = 1; i <= 10000; ++i)
+            {
+                settings.Store(Settings{ i, 2 * i, 3.0 * i });
+            }
+            isWriting = false;
+        });
+
+    std::vector<std::thread> settingsReaders;
+    for (int i = 0; i < 4; ++i)
+    {
+        settingsReaders.emplace_back([&settings, &isWriting, &inconsistentReads]()
+            {
+                while (isWriting)
+                {
+                    const Settings value = settings.Load();
+                    if (value.m_height != 2 * value.m_width || value.m_scale != 3.0 * value.m_width)
+                    {
+                        ++inconsistentReads;
+                    }
+                }
+            });
+    }
+
+    settingsWriter.join();
+    for (auto& thread : settingsReaders)
+    {
+        thread.join();
+    }
+
+    const Settings lastSettings = settings.Load();
+    printf("SeqLock last value %d %d %.1f, inconsistent reads %d\n",
+        lastSettings.m_width, lastSettings.m_height, lastSettings.m_scale, inconsistentReads.load());
+
+    // RCU: readers keep using the table they got while writers replace it.
+    RcuSnapshot<std::vector<int>> routingTable(std::make_unique<const std::vector<int>>());
+
+    std::thread tableWriter([&routingTable]()
+        {
+            for (int i = 1; i <= 100; ++i)
+            {
+                routingTable.Modify([i](std::vector<int>& table) { table.push_back(i); });
+            }
+        });
+
+    std::vector<std::thread> tableReaders;
+    for (int i = 0; i < 4; ++i)
+    {
+        tableReaders.emplace_back([&routingTable]()
+            {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    auto table = routingTable.Read();
+                    // A table with n routes always has 1..n
+                    const int sum = std::accumulate(table->begin(), table->end(), 0);
+                    const int size = static_cast<int>(table->size());
+                    if (sum != size * (size + 1) / 2)
+                    {
+                        printf("Inconsistent routing table\n");
+                    }
+                }
+            });
+    }
+
+    tableWriter.join();
+    for (auto& thread : tableReaders)
+    {
+        thread.join();
+    }
+
+    printf("RcuSnapshot has %zu routes\n\n", routingTable.Read()->size());
+}
+
 // Condition Variables
 //
 // Used for synchronization between threads. Allows one or more threads to wait for
@@ -626,3 +1172,357 @@ void PromiseAndFuture()
     int accumulate3 = futureResultFromTask.get();
     std::printf("result = %d\n", accumulate3);
 }
+
+// Thread Pool
+//
+// Creating threads for each piece of work is expensive. A thread pool creates its
+// worker threads once and reuses them for all the tasks, see ThreadPool.h.
+//
+// ThreadPool::GetDefault() is shared by the whole program, so code can schedule work
+// onto it without creating threads. For example, ParallelBreathFirstSearch in Graphs.cpp.
+
+void ThreadPools()
+{
+    ThreadPool threadPool(4);
+
+    // Submit returns a future with the result of the task.
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 4; ++i)
+    {
+        futures.push_back(threadPool.Submit([i, &threadPool]()
+            {
+                printf("Task %d) Running in worker %d\n", i, threadPool.GetCurrentWorkerIndex());
+                return i * i;
+            }));
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        printf("Task %d) Result %d\n", i, futures[i].get());
+    }
+
+    // Execute doesn't return anything, it's cheaper when the result is not needed.
+    // Tasks can add more tasks, which go to the deque of their worker and are
+    // stolen by other workers when they run out of tasks.
+    // Waiting inside a task (future::get, latch::wait, etc.) blocks its worker,
+    // so here only the calling thread waits.
+    std::latch tasksDone(8);
+    for (int i = 0; i < 4; ++i)
+    {
+        threadPool.Execute([&threadPool, &tasksDone]()
+            {
+                threadPool.Execute([&tasksDone]() { tasksDone.count_down(); });
+                tasksDone.count_down();
+            });
+    }
+    tasksDone.wait();
+    printf("Tasks done\n");
+
+    // ParallelFor splits the range into chunks executed by the workers and
+    // the calling thread, returning once all of them are done.
+    std::vector<int> numbers(100000);
+    threadPool.ParallelFor(0, numbers.size(), [&numbers](std::size_t i)
+        {
+            numbers[i] = static_cast<int>(i % 10);
+        });
+
+    std::atomic<long long> sum = 0;
+    threadPool.ParallelForRange(0, numbers.size(), [&numbers, &sum](std::size_t first, std::size_t last)
+        {
+            const long long chunkSum = std::accumulate(numbers.begin() + first, numbers.begin() + last, 0ll);
+            sum.fetch_add(chunkSum, std::memory_order_relaxed);
+        });
+    printf("ParallelFor sum = %lld\n", sum.load());
+}
+
+// Lock-free Queues
+//
+// Producer/consumer hand-offs with a std::mutex and std::condition_variable make all
+// threads contend on the same mutex. Lock-free queues let producers and consumers
+// claim slots with atomic operations, see LockFreeQueue.h.
+//
+// BoundedMPMCQueue supports any number of producers and consumers.
+// BoundedSPSCQueue is faster, but only for one producer and one consumer.
+
+void LockFreeQueues()
+{
+    const int producerCount = 2;
+    const int consumerCount = 2;
+    const int itemsPerThread = 1000;
+
+    BoundedMPMCQueue<int> mpmcQueue(64);
+    std::atomic<long long> consumedSum = 0;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producerCount; ++i)
+    {
+        threads.emplace_back([&mpmcQueue]()
+            {
+                for (int item = 1; item <= itemsPerThread; ++item)
+                {
+                    mpmcQueue.Push(item); // Waits while the queue is full
+                }
+            });
+    }
+    for (int i = 0; i < consumerCount; ++i)
+    {
+        threads.emplace_back([&mpmcQueue, &consumedSum]()
+            {
+                long long sum = 0;
+                for (int item = 0; item < itemsPerThread; ++item)
+                {
+                    sum += mpmcQueue.Pop(); // Waits while the queue is empty
+                }
+                consumedSum += sum;
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    printf("MPMC queue consumed sum = %lld\n", consumedSum.load());
+
+    // TryPush and TryPop never wait, they return false when the queue is full or empty.
+    BoundedSPSCQueue<std::string> spscQueue(2);
+    const bool pushedOne = spscQueue.TryPush("one");
+    const bool pushedTwo = spscQueue.TryPush("two");
+    const bool pushedThree = spscQueue.TryPush("three"); // Full
+    printf("SPSC queue TryPush: %d %d %d\n", pushedOne, pushedTwo, pushedThree);
+
+    std::thread consumer([&spscQueue]()
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                std::string text = spscQueue.Pop();
+                printf("SPSC queue Pop: %s\n", text.c_str());
+            }
+        });
+    spscQueue.Push("three");
+    consumer.join();
+}
+
+// Benchmarks (run by bench executable)
+
+namespace
+{
+    // Bounded queue with the std::mutex and std::condition_variable pattern,
+    // to compare against the lock-free queues.
+    template<typename T>
+    class ConditionVariableQueue
+    {
+    public:
+        explicit ConditionVariableQueue(std::size_t capacity)
+            : m_capacity(capacity)
+        {
+        }
+
+        void Push(T value)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_notFull.wait(lock, [this]() { return m_queue.size() < m_capacity; });
+                m_queue.push(std::move(value));
+            }
+            m_notEmpty.notify_one();
+        }
+
+        T Pop()
+        {
+            T value;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_notEmpty.wait(lock, [this]() { return !m_queue.empty(); });
+                value = std::move(m_queue.front());
+                m_queue.pop();
+            }
+            m_notFull.notify_one();
+            return value;
+        }
+
+    private:
+        std::size_t m_capacity;
+        std::queue<T> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_notFull;
+        std::condition_variable m_notEmpty;
+    };
+
+    // Time to pass itemCount items through the queue from the producers to the consumers.
+    template<typename Queue>
+    double MeasureQueueThroughput(Queue& queue, int producerCount, int consumerCount, int itemCount)
+    {
+        BenchmarkTimer timer;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < producerCount; ++i)
+        {
+            threads.emplace_back([&queue, producerCount, itemCount]()
+                {
+                    for (int item = 0; item < itemCount / producerCount; ++item)
+                    {
+                        queue.Push(item);
+                    }
+                });
+        }
+        for (int i = 0; i < consumerCount; ++i)
+        {
+            threads.emplace_back([&queue, consumerCount, itemCount]()
+                {
+                    long long sum = 0;
+                    for (int item = 0; item < itemCount / consumerCount; ++item)
+                    {
+                        sum += queue.Pop();
+                    }
+                    DoNotOptimize(sum);
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        return timer.GetElapsedMilliseconds();
+    }
+}
+
+// Time for threadCount threads to call increment incrementsPerThread times each.
+template<typename Function>
+static double MeasureIncrements(int threadCount, int incrementsPerThread, Function increment)
+{
+    BenchmarkTimer timer;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([incrementsPerThread, &increment]()
+            {
+                for (int i = 0; i < incrementsPerThread; ++i)
+                {
+                    increment();
+                }
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return timer.GetElapsedMilliseconds();
+}
+
+void BenchmarkCounters()
+{
+    const int incrementsPerThread = 1 << 20;
+    char name[64];
+
+    std::printf("Counters (%d increments per thread)\n", incrementsPerThread);
+
+    for (int threadCount : { 1, 2, 4, 8 })
+    {
+        const std::size_t incrementCount = static_cast<std::size_t>(threadCount) * incrementsPerThread;
+        {
+            std::atomic<long long> counter = 0;
+            std::snprintf(name, sizeof(name), "std::atomic %d threads", threadCount);
+            PrintBenchmark(name, MeasureIncrements(threadCount, incrementsPerThread,
+                [&counter]() { counter.fetch_add(1, std::memory_order_relaxed); }), incrementCount);
+            DoNotOptimize(counter);
+        }
+        {
+            ShardedCounter counter;
+            std::snprintf(name, sizeof(name), "ShardedCounter %d threads", threadCount);
+            PrintBenchmark(name, MeasureIncrements(threadCount, incrementsPerThread,
+                [&counter]() { counter.Increment(); }), incrementCount);
+            DoNotOptimize(counter.Get());
+        }
+    }
+
+    std::printf("\n");
+}
+
+// Time for threadCount threads to call read readsPerThread times each.
+template<typename Function>
+static double MeasureReads(int threadCount, int readsPerThread, Function read)
+{
+    BenchmarkTimer timer;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([readsPerThread, &read]()
+            {
+                long long sum = 0;
+                for (int i = 0; i < readsPerThread; ++i)
+                {
+                    sum += read();
+                }
+                DoNotOptimize(sum);
+            });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    return timer.GetElapsedMilliseconds();
+}
+
+void BenchmarkReadMostly()
+{
+    const int readsPerThread = 1 << 20;
+    char name[64];
+
+    std::printf("Read-mostly (%d reads per thread, no writers)\n", readsPerThread);
+
+    ThreadSafeCounter threadSafeCounter;
+    SeqLock<int> seqLock(0);
+    RcuSnapshot<int> rcuSnapshot(std::make_unique<const int>(0));
+
+    for (int threadCount : { 1, 2, 4, 8 })
+    {
+        const std::size_t readCount = static_cast<std::size_t>(threadCount) * readsPerThread;
+
+        std::snprintf(name, sizeof(name), "ThreadSafeCounter::Get %d threads", threadCount);
+        PrintBenchmark(name, MeasureReads(threadCount, readsPerThread,
+            [&threadSafeCounter]() { return threadSafeCounter.Get(); }), readCount);
+
+        std::snprintf(name, sizeof(name), "SeqLock::Load %d threads", threadCount);
+        PrintBenchmark(name, MeasureReads(threadCount, readsPerThread,
+            [&seqLock]() { return seqLock.Load(); }), readCount);
+
+        std::snprintf(name, sizeof(name), "RcuSnapshot::Read %d threads", threadCount);
+        PrintBenchmark(name, MeasureReads(threadCount, readsPerThread,
+            [&rcuSnapshot]() { return *rcuSnapshot.Read(); }), readCount);
+    }
+
+    std::printf("\n");
+}
+
+void BenchmarkQueues()
+{
+    const int itemCount = 1 << 20; // Divisible by the thread counts
+    const std::size_t capacity = 1024;
+    char name[64];
+
+    std::printf("Queues (%d items, capacity %zu)\n", itemCount, capacity);
+
+    for (int threadCount : { 1, 2, 4 })
+    {
+        {
+            ConditionVariableQueue<int> queue(capacity);
+            std::snprintf(name, sizeof(name), "condition_variable queue %dP %dC", threadCount, threadCount);
+            PrintBenchmark(name, MeasureQueueThroughput(queue, threadCount, threadCount, itemCount), itemCount);
+        }
+        {
+            BoundedMPMCQueue<int> queue(capacity);
+            std::snprintf(name, sizeof(name), "BoundedMPMCQueue %dP %dC", threadCount, threadCount);
+            PrintBenchmark(name, MeasureQueueThroughput(queue, threadCount, threadCount, itemCount), itemCount);
+        }
+        if (threadCount == 1)
+        {
+            BoundedSPSCQueue<int> queue(capacity);
+            PrintBenchmark("BoundedSPSCQueue 1P 1C", MeasureQueueThroughput(queue, 1, 1, itemCount), itemCount);
+        }
+    }
+
+    std::printf("\n");
+}
@@ -369,6 +369,7 @@ void Concepts()
 // --------------------------------------------------------------------------------
 
 #include <coroutine>
+#include <utility>
 
 // Coroutines are basically functions that can be paused and resumed.
 // Coroutines are designed to make writing asynchronous code easier.
@@ -418,10 +419,36 @@ struct CoroutineType
     {
     }
 
+    // The coroutine must be destroyed only once, so the type can't be copied,
+    // and moving it leaves the other object without handle.
+    CoroutineType(const CoroutineType&) = delete;
+    CoroutineType& operator=(const CoroutineType&) = delete;
+
+    CoroutineType(CoroutineType&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, {}))
+    {
+    }
+
+    CoroutineType& operator=(CoroutineType&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+
     ~CoroutineType()
     {
-        m_handle.destroy();
-        printf("Handle destroyed!\n");
+        if (m_handle)
+        {
+            m_handle.destroy();
+            printf("Handle destroyed!\n");
+        }
     }
 
     CoroutineHandle m_handle;
@@ -572,6 +599,111 @@ void Coroutines()
     printf("\n");
 }
 
+// -------------------------
+// CoroutineType above is only good to show the infrastructure. Task.h has the coroutine
+// types for real use: Task<T> for asynchronous work, Generator<T> for sequences of values,
+// ScheduleOn to continue in a thread pool and SyncWait to get the result from normal code.
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "Task.h"
+
+// Values are produced lazily, while the range is iterated.
+Generator<int> Fibonacci(int count)
+{
+    int a = 0;
+    int b = 1;
+    for (int i = 0; i < count; ++i)
+    {
+        co_yield a;
+        a = std::exchange(b, a + b);
+    }
+}
+
+Task<int> Double(int value)
+{
+    co_return value * 2;
+}
+
+// Awaiting a task starts it and continues here once it's finished.
+Task<int> SumOfDoubles(int a, int b)
+{
+    const int doubleA = co_await Double(a);
+    const int doubleB = co_await Double(b);
+    co_return doubleA + doubleB;
+}
+
+// Each task resumes the one that awaited it with symmetric transfer, so a long chain
+// of tasks doesn't overflow the stack. It relies on the compiler doing a tail call, which
+// some compilers only do in optimized builds (GCC and MSVC), so very long chains
+// can still overflow in debug builds.
+Task<int> CountDown(int n)
+{
+    if (n == 0)
+    {
+        co_return 0;
+    }
+    co_return 1 + co_await CountDown(n - 1);
+}
+
+// The file is read in a worker of the thread pool, not in the thread that awaits it.
+Task<int> CountLinesAsync(ThreadPool& threadPool, std::string fileName)
+{
+    co_await ScheduleOn(threadPool);
+
+    std::ifstream file(fileName);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open " + fileName);
+    }
+
+    int lineCount = 0;
+    for (std::string line; std::getline(file, line);)
+    {
+        ++lineCount;
+    }
+    co_return lineCount;
+}
+
+// Pipeline of asynchronous steps written as sequential code.
+Task<void> CountLinesPipeline(ThreadPool& threadPool)
+{
+    const int lineCount = co_await CountLinesAsync(threadPool, "CoroutineExample.txt");
+    printf("CoroutineExample.txt has %d lines (worker %d)\n", lineCount, threadPool.GetCurrentWorkerIndex());
+
+    try
+    {
+        co_await CountLinesAsync(threadPool, "MissingFile.txt");
+    }
+    catch (const std::exception& exception)
+    {
+        printf("Exception from task: %s\n", exception.what());
+    }
+}
+
+void CoroutineTasks()
+{
+    for (int value : Fibonacci(10))
+    {
+        printf("%d,", value); // 0,1,1,2,3,5,8,13,21,34,
+    }
+    printf("\n");
+
+    printf("SumOfDoubles %d\n", SyncWait(SumOfDoubles(10, 11))); // 42
+    printf("CountDown %d\n", SyncWait(CountDown(1000))); // 1000
+
+    if (std::ofstream file("CoroutineExample.txt"); file)
+    {
+        file << "One\nTwo\nThree\n";
+    }
+
+    ThreadPool threadPool(2);
+    SyncWait(CountLinesPipeline(threadPool));
+    printf("\n");
+}
+
 // --------------------------------------------------------------------------------
 // Modules
 // --------------------------------------------------------------------------------
@@ -727,6 +859,7 @@ void Coroutines()
 // Partitions are useful to isolate how the module is subdivided.
 
 import Math;
+import Print;
 
 void Modules()
 {
@@ -738,5 +871,18 @@ void Modules()
     auto degrees = Math::RadiansToDegrees(Math::Pi);
     auto radians= Math::DegressToRadians(180.0f);
 
+    // Math functions log asynchronously, waiting for their messages to be printed
+    Print::Flush();
+
+    // Without logging, in constant expressions and for whole arrays
+    static_assert(Math::ToDegrees(Math::Pi) > 179.99f && Math::ToDegrees(Math::Pi) < 180.01f);
+    static_assert(Math::Clamp(7, 0, 5) == 5);
+
+    float angles[] = { 0.0f, Math::HalfPi, Math::Pi, Math::TwoPi, -Math::Pi };
+    Math::RadiansToDegrees(angles, angles);
+    Math::Clamp(angles, -90.0f, 180.0f, angles);
+    printf("Degrees clamped: %0.1f %0.1f %0.1f %0.1f %0.1f (min %0.1f max %0.1f)\n",
+        angles[0], angles[1], angles[2], angles[3], angles[4], Math::Min(angles), Math::Max(angles));
+
     printf("\n");
 }
@@ -11,6 +11,17 @@
 #include <map>
 #include <unordered_set>
 #include <unordered_map>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <span>
+#include <memory_resource>
+
+#include "FlatHashMap.h"
+#include "FlatMap.h"
+#include "SmallVector.h"
+#include "MemoryResources.h"
+#include "Benchmark.h"
 
 // Helpers
 namespace
@@ -43,28 +54,63 @@ namespace
         int m_value = 0;
     };
 
+    // Transparent (is_transparent) to allow heterogeneous lookup with int in ordered containers.
     struct TypeLess
     {
+        using is_transparent = void;
+
         bool operator()(const Type& left, const Type& right) const
         {
             return left.getValue() < right.getValue();
         }
+
+        bool operator()(const Type& left, int right) const
+        {
+            return left.getValue() < right;
+        }
+
+        bool operator()(int left, const Type& right) const
+        {
+            return left < right.getValue();
+        }
     };
 
+    // Transparent (is_transparent) to allow heterogeneous lookup with int in unordered containers,
+    // without constructing a Type. It needs the operators for all the combinations of types.
     struct TypeEqual
     {
+        using is_transparent = void;
+
         bool operator()(const Type& left, const Type& right) const
         {
             return left.getValue() == right.getValue();
         }
+
+        bool operator()(const Type& left, int right) const
+        {
+            return left.getValue() == right;
+        }
+
+        bool operator()(int left, const Type& right) const
+        {
+            return left == right.getValue();
+        }
     };
 
+    // Hash of int must be the same as the hash of Type with that value.
     struct TypeHash
     {
+        using is_transparent = void;
+
         std::size_t operator()(const Type& element) const
         {
             return std::hash<int>{}(element.getValue());
         }
+
+        std::size_t operator()(int value) const
+        {
+            return std::hash<int>{}(value);
+        }
     };
 }
 
@@ -175,6 +221,64 @@ void Arrays()
     dynamicArray.clear(); // Removes all the elements. Keeps capacity.
 }
 
+// Small Vectors and Static Vectors
+// 
+// Dynamic arrays with storage for N elements inside the object (see SmallVector.h).
+// 
+// SmallVector only allocates when it has more than N elements, and StaticVector never
+// allocates, it can't have more than N elements. Good for the many short lists of a
+// data structure, like the children of a tree node or the edges of a graph vertex.
+//
+// Same complexity as dynamic arrays.
+//
+// + No allocations while the elements fit in the inline storage.
+//      push_back, emplace_back
+// + Elements are next to the object, no pointer to follow to read them.
+//      [], begin, end
+// - Bigger objects, they take the size of the N elements even when empty.
+// - Moving is O(n) while the elements are inline, it can't just steal the pointer.
+
+void SmallVectorsAndStaticVectors()
+{
+    // -----------------
+    // Small vector
+    SmallVector<int, 4> smallVector = { 1, 2, 3 };
+
+    // Elements fit in the inline storage, no allocations.
+    smallVector.push_back(4);
+    std::printf("Small vector: ");
+    PrintContainer(smallVector);
+    std::printf("(inline: %s)\n", smallVector.IsInline() ? "yes" : "no");
+
+    // One more element than the inline capacity moves the elements to allocated memory.
+    smallVector.push_back(5);
+    std::printf("Small vector: ");
+    PrintContainer(smallVector);
+    std::printf("(inline: %s)\n\n", smallVector.IsInline() ? "yes" : "no");
+
+    // Contiguous, so it converts to span to pass it to functions that take any array.
+    std::span<const int> smallVectorSpan = smallVector;
+
+    // -----------------
+    // Static vector
+    StaticVector<Type, 4> staticVector;
+    staticVector.emplace_back(1);
+    staticVector.emplace_back(2);
+
+    // Never allocates, adding elements when it's full throws std::length_error.
+    while (!staticVector.full())
+    {
+        staticVector.emplace_back(static_cast<int>(staticVector.size()) + 1);
+    }
+
+    std::printf("Static vector: ");
+    for (const Type& element : staticVector)
+    {
+        std::printf("%d ", element.getValue());
+    }
+    std::printf("\n\n");
+}
+
 // Linked Lists
 // 
 // A collection of nodes that together form a sequence. Each node contains data and
@@ -715,6 +819,76 @@ void Maps()
     multimap.clear(); // Removes all the elements.
 }
 
+// Flat Maps and Flat Sets
+// 
+// Same as std::map and std::set, but stored as a sorted vector instead of a tree (see FlatMap.h).
+// 
+// Good for data that is built once and searched many times: elements take only their size
+// (no nodes with pointers), searches are binary searches in contiguous memory and iterating
+// a range of keys reads memory sequentially. Bad for insertion and deletion of elements.
+//
+// Access: N/A
+// Search: O(log n)
+// Insert: O(n) (but O(n log n) to build it with all the elements at once)
+// Delete: O(n)
+//
+// + Elements continuous in memory, good for cache when searching and iterating through elements.
+//      find, lower_bound, upper_bound, equal_range, begin, end
+// - Bad for insertion and deletion of elements, it moves the elements after them.
+//      insert, emplace, try_emplace, erase
+
+void FlatMapsAndFlatSets()
+{
+    // Built at once from unsorted elements, sorted only once.
+    // Repeated keys are removed, keeping the first one.
+    using MyFlatSet = FlatSet<Type, TypeLess>;
+    MyFlatSet set(std::vector<Type>{ Type(4), Type(3), Type(2), Type(1), Type(3) });
+
+    // Insert elements. Slow, O(n).
+    std::pair<MyFlatSet::iterator, bool> insertedElementPair = set.insert(Type(6));
+
+    // Search is O(log n), with a branchless binary search.
+    MyFlatSet::const_iterator findIt = set.find(Type(3));
+    bool contains = set.contains(6); // Heterogeneous lookup, TypeLess is transparent
+
+    std::printf("Flat Set: ");
+    for (const auto& element : set)
+    {
+        std::printf("%d ", element.getValue());
+    }
+    std::printf("\n\n");
+
+    // ---------------------------
+    // Flat Maps
+    using MyFlatMap = FlatMap<Type, std::string, TypeLess>;
+    MyFlatMap map =
+    {
+        {Type(4), "four"},
+        {Type(3), "three"},
+        {Type(2), "two"},
+        {Type(1), "one"}
+    };
+
+    std::pair<MyFlatMap::iterator, bool> insertedPair = map.try_emplace(Type(6), "six");
+    insertedPair = map.insert_or_assign(Type(6), "six_override");
+    map[Type(9)] = "nine";
+    std::string value = map.at(Type(6));
+
+    // Range of keys [2, 6), sequential in memory.
+    std::printf("Flat Map keys in [2, 6): ");
+    for (auto it = map.lower_bound(2), last = map.lower_bound(6); it != last; ++it)
+    {
+        std::printf("{%d, \"%s\"} ", it->first.getValue(), it->second.c_str());
+    }
+    std::printf("\n");
+
+    // Elements are only the pairs, no nodes.
+    std::printf("Flat Map memory per element: %zu bytes\n\n", sizeof(MyFlatMap::value_type));
+
+    map.erase(Type(9));
+    map.clear();
+}
+
 // Unordered Sets
 // 
 // Same as std::set but using a hash table instead of a tree.
@@ -954,3 +1128,425 @@ void UnorderedMaps()
 
     multimap.clear(); // Removes all the elements.
 }
+
+// Flat Hash Maps and Flat Hash Sets
+// 
+// Same as std::unordered_map and std::unordered_set, but with open addressing (see FlatHashMap.h).
+// 
+// Elements are stored directly in an array of slots instead of a node per element, and
+// an array of control bytes (with 7 bits of the hash of each element) is compared 16 slots
+// at a time with SIMD instructions to find the candidates to compare with the key.
+// 
+// Good for searches, as they don't follow pointers and the memory is contiguous.
+// Bad that elements move when the table grows, so iterators and references are invalidated by insertions.
+//
+// Access: N/A
+// Search: O(1)
+// Insert: O(1)
+// Delete: O(1)
+//
+// + Element access is direct and fast, with fewer cache misses than std::unordered_* containers.
+//      [], at, find, contains
+// + Elements continuous in memory (with gaps), good for cache when iterating through elements.
+//      begin, end (with ++ operator only)
+// + Good for insertion and deletion of elements, without allocations per element.
+//      insert, emplace, try_emplace, insert_or_assign, erase, reserve, clear
+// - Insertions invalidate iterators, references and pointers to elements.
+
+void FlatHashTables()
+{
+    // Same hash and equal functors as std::unordered_set.
+    using MyFlatHashSet = FlatHashSet<Type, TypeHash, TypeEqual>;
+    MyFlatHashSet set = { Type(4), Type(3), Type(2), Type(1) };
+
+    // Insert elements. Fast.
+    std::pair<MyFlatHashSet::iterator, bool> insertedElementPair = set.insert(Type(6)); // pair.bool is true as it's new element.
+    insertedElementPair = set.insert(Type(6)); // pair.bool is false as it's already inserted.
+    insertedElementPair = set.emplace(9);
+
+    // Search is O(1), without following pointers.
+    MyFlatHashSet::iterator findIt = set.find(Type(3));
+
+    // Heterogeneous lookup, TypeHash and TypeEqual are transparent so it can search
+    // with an int directly without constructing a Type. It also works with std::unordered_set.
+    bool contains = set.contains(3);
+    std::printf("Flat Hash Set contains 3? %s (%d)\n", contains ? "YES" : "NO", findIt->getValue());
+
+    std::printf("Flat Hash Set: ");
+    for (const auto& element : set)
+    {
+        std::printf("%d ", element.getValue());
+    }
+    std::printf("\n\n");
+
+    // Erase elements. Fast.
+    MyFlatHashSet::iterator afterErasedIt = set.erase(set.begin());
+    std::size_t erasedCount = set.erase(9); // Heterogeneous erase
+
+    set.clear(); // Removes all the elements, keeps the capacity.
+
+    // ---------------------------
+    // Flat Hash Maps
+    using MyFlatHashMap = FlatHashMap<Type, std::string, TypeHash, TypeEqual>;
+    MyFlatHashMap map =
+    {
+        {Type(4), "four"},
+        {Type(3), "three"},
+        {Type(2), "two"},
+        {Type(1), "one"}
+    };
+
+    // Reserve avoids growing the table (moving all the elements) while inserting.
+    map.reserve(100);
+
+    // Insert elements. Fast.
+    std::pair<MyFlatHashMap::iterator, bool> insertedPair = map.insert({ Type(6), "six" });
+    insertedPair = map.try_emplace(Type(6), "six_2"); // Doesn't construct the value if the key is found.
+    insertedPair = map.insert_or_assign(Type(6), "six_override");
+
+    map[Type(9)] = "nine";
+    std::string value = map.at(Type(6));
+    MyFlatHashMap::iterator findIt2 = map.find(6); // Heterogeneous lookup
+
+    std::printf("Flat Hash Map: ");
+    for (const auto& pair : map)
+    {
+        std::printf("{%d, \"%s\"} ", pair.first.getValue(), pair.second.c_str());
+    }
+    std::printf("(capacity %zu, load factor %.2f)\n\n", map.capacity(), map.load_factor());
+
+    map.clear();
+}
+
+// Arenas (Memory Resources)
+// 
+// Containers with a polymorphic allocator (std::pmr::vector, pmr::FlatHashMap, pmr::FlatMap,
+// pmr::SmallVector...) allocate from a std::pmr::memory_resource (see MemoryResources.h).
+// Giving the same arena to all the containers of a request puts its whole working set in a few
+// big blocks, which are freed at once when the request finishes.
+//
+// + Allocating is moving a pointer (BumpResource) or taking a block from a free list (PoolResource).
+// + Freeing the whole working set is O(blocks), instead of a deallocation per element.
+// + Counters of the allocations of each request.
+// - The arena must outlive its containers, and nothing can use its memory after Release.
+// - BumpResource doesn't reuse deallocated memory until Release or Reset.
+
+void Arenas()
+{
+    // Whole working set of each request from the same arena, as a request handler would do.
+    BumpResource arena;
+    for (int request = 0; request < 3; ++request)
+    {
+        // Counters are totals since the arena was created, Reset doesn't restart them.
+        const AllocationStats statsBefore = arena.GetStats();
+        {
+            // Elements using an allocator get it from the container, so the strings are in the arena too.
+            pmr::FlatHashMap<int, std::pmr::string> names(&arena);
+            pmr::FlatMap<int, int> sortedValues(&arena);
+            std::pmr::vector<pmr::SmallVector<int, 4>> lists(64, &arena);
+
+            for (int i = 0; i < 100 * (request + 1); ++i)
+            {
+                names.try_emplace(i, "Name long enough to not fit in the string");
+                sortedValues.try_emplace(-i, i);
+                lists[i % lists.size()].push_back(i);
+            }
+        } // Destructors deallocate, which BumpResource ignores
+
+        const AllocationStats& stats = arena.GetStats();
+        std::printf("Request %d: %zu allocations, %zu bytes, %zu bytes of blocks from upstream\n",
+            request,
+            stats.m_allocationCount - statsBefore.m_allocationCount,
+            stats.m_allocatedBytes - statsBefore.m_allocatedBytes,
+            stats.m_upstreamBytes);
+
+        // Frees all the working set at once, keeping the biggest block for the next request.
+        arena.Reset();
+    }
+    std::printf("\n");
+
+    // Pool reuses the deallocated blocks, so the memory used is the peak, not the total.
+    PoolResource pool;
+    {
+        std::pmr::list<int> list(&pool);
+        for (int i = 0; i < 1000; ++i)
+        {
+            list.push_back(i);
+            if (i % 2 == 0)
+            {
+                list.pop_front();
+            }
+        }
+
+        const AllocationStats stats = pool.GetStats();
+        std::printf("Pool: %zu allocations, %zu deallocations, %zu bytes allocated, %zu bytes peak\n\n",
+            stats.m_allocationCount, stats.m_deallocationCount, stats.m_allocatedBytes, stats.m_peakBytes);
+    }
+    pool.Release();
+
+    // Counting what a container allocates with new/delete.
+    CountingResource counting(std::pmr::new_delete_resource());
+    {
+        std::pmr::vector<int> vector(&counting);
+        for (int i = 0; i < 1000; ++i)
+        {
+            vector.push_back(i);
+        }
+
+        const AllocationStats& stats = counting.GetStats();
+        std::printf("std::pmr::vector push_back 1000 times: %zu allocations, %zu bytes peak\n\n",
+            stats.m_allocationCount, stats.m_peakBytes);
+    }
+}
+
+// --------------------------------------------------------------------------------
+// Benchmarks (run by bench executable)
+// --------------------------------------------------------------------------------
+
+// Compares std::unordered_map with FlatHashMap, both with Type keys and the same
+// TypeHash and TypeEqual functors, in random order so caches don't help.
+// Miss looks for keys that are not in the map.
+void BenchmarkHashTables()
+{
+    const int elementCount = 1 << 20;
+
+    std::vector<int> keys(2 * elementCount);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::ranges::shuffle(keys, std::mt19937(42));
+
+    // First half of the keys are inserted, the second half are the misses.
+    const std::vector<int> insertedKeys(keys.begin(), keys.begin() + elementCount);
+    const std::vector<int> missingKeys(keys.begin() + elementCount, keys.end());
+
+    std::vector<int> lookupKeys = insertedKeys;
+    std::ranges::shuffle(lookupKeys, std::mt19937(43));
+
+    auto benchmarkMap = [&]<class Map>(const char* mapName, Map& map)
+    {
+        char name[64];
+
+        const double insertTime = MeasureMilliseconds([&]()
+            {
+                for (int key : insertedKeys)
+                {
+                    map.try_emplace(Type(key), key);
+                }
+            });
+        std::snprintf(name, sizeof(name), "%s Insert", mapName);
+        PrintBenchmark(name, insertTime, elementCount);
+
+        const double hitTime = MeasureMilliseconds([&]()
+            {
+                long long sum = 0;
+                for (int key : lookupKeys)
+                {
+                    sum += map.find(Type(key))->second;
+                }
+                DoNotOptimize(sum);
+            });
+        std::snprintf(name, sizeof(name), "%s Find hit", mapName);
+        PrintBenchmark(name, hitTime, elementCount);
+
+        const double missTime = MeasureMilliseconds([&]()
+            {
+                std::size_t count = 0;
+                for (int key : missingKeys)
+                {
+                    count += map.count(Type(key));
+                }
+                DoNotOptimize(count);
+            });
+        std::snprintf(name, sizeof(name), "%s Find miss", mapName);
+        PrintBenchmark(name, missTime, elementCount);
+
+        const double eraseTime = MeasureMilliseconds([&]()
+            {
+                for (int key : lookupKeys)
+                {
+                    map.erase(Type(key));
+                }
+            });
+        std::snprintf(name, sizeof(name), "%s Erase", mapName);
+        PrintBenchmark(name, eraseTime, elementCount);
+    };
+
+    {
+        std::unordered_map<Type, int, TypeHash, TypeEqual> map;
+        benchmarkMap("std::unordered_map", map);
+    }
+    {
+        std::unordered_map<Type, int, TypeHash, TypeEqual> map;
+        map.reserve(elementCount);
+        benchmarkMap("std::unordered_map (reserved)", map);
+    }
+    {
+        FlatHashMap<Type, int, TypeHash, TypeEqual> map;
+        benchmarkMap("FlatHashMap", map);
+    }
+    {
+        FlatHashMap<Type, int, TypeHash, TypeEqual> map;
+        map.reserve(elementCount);
+        benchmarkMap("FlatHashMap (reserved)", map);
+    }
+
+    std::printf("\n");
+}
+
+// Compares std::map with FlatMap built once with all the keys, both with Type keys and TypeLess.
+// Range scan sums the values of 1024 ranges of 1024 consecutive keys.
+void BenchmarkOrderedMaps()
+{
+    const int elementCount = 1 << 20;
+    const int rangeCount = 1024;
+    const int rangeSize = 1024;
+
+    // Even keys are inserted, odd keys are the misses.
+    std::vector<int> keys(elementCount);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::ranges::shuffle(keys, std::mt19937(42));
+
+    std::vector<int> lookupKeys = keys;
+    std::ranges::shuffle(lookupKeys, std::mt19937(43));
+
+    auto benchmarkMap = [&](const char* mapName, const auto& map, double buildTime)
+    {
+        char name[64];
+
+        std::snprintf(name, sizeof(name), "%s Build", mapName);
+        PrintBenchmark(name, buildTime, elementCount);
+
+        const double hitTime = MeasureMilliseconds([&]()
+            {
+                long long sum = 0;
+                for (int key : lookupKeys)
+                {
+                    sum += map.find(Type(2 * key))->second;
+                }
+                DoNotOptimize(sum);
+            });
+        std::snprintf(name, sizeof(name), "%s Find hit", mapName);
+        PrintBenchmark(name, hitTime, elementCount);
+
+        const double missTime = MeasureMilliseconds([&]()
+            {
+                std::size_t count = 0;
+                for (int key : lookupKeys)
+                {
+                    count += map.count(Type(2 * key + 1));
+                }
+                DoNotOptimize(count);
+            });
+        std::snprintf(name, sizeof(name), "%s Find miss", mapName);
+        PrintBenchmark(name, missTime, elementCount);
+
+        const double scanTime = MeasureMilliseconds([&]()
+            {
+                long long sum = 0;
+                for (int i = 0; i < rangeCount; ++i)
+                {
+                    const int first = 2 * lookupKeys[i];
+                    for (auto it = map.lower_bound(Type(first)), last = map.lower_bound(Type(first + 2 * rangeSize)); it != last; ++it)
+                    {
+                        sum += it->second;
+                    }
+                }
+                DoNotOptimize(sum);
+            });
+        std::snprintf(name, sizeof(name), "%s Range scan", mapName);
+        PrintBenchmark(name, scanTime, rangeCount * rangeSize);
+    };
+
+    {
+        std::map<Type, int, TypeLess> map;
+        const double buildTime = MeasureMilliseconds([&]()
+            {
+                for (int key : keys)
+                {
+                    map.emplace(Type(2 * key), key);
+                }
+            });
+        benchmarkMap("std::map", map, buildTime);
+    }
+    {
+        FlatMap<Type, int, TypeLess> map;
+        const double buildTime = MeasureMilliseconds([&]()
+            {
+                std::vector<std::pair<Type, int>> values;
+                values.reserve(elementCount);
+                for (int key : keys)
+                {
+                    values.emplace_back(Type(2 * key), key);
+                }
+                map = FlatMap<Type, int, TypeLess>(std::move(values));
+            });
+        benchmarkMap("FlatMap", map, buildTime);
+    }
+
+    std::printf("\n");
+}
+
+// Builds and destroys the working set of many small requests (a hash map of strings,
+// a sorted map and a vector), with new/delete and with an arena per request.
+// With arenas, freeing the working set is only resetting the arena.
+void BenchmarkArenas()
+{
+    const int requestCount = 1 << 12;
+    const int elementCount = 256;
+
+    auto runRequests = [&](auto getResource, auto endRequest)
+    {
+        for (int request = 0; request < requestCount; ++request)
+        {
+            {
+                std::pmr::memory_resource* resource = getResource();
+                pmr::FlatHashMap<int, std::pmr::string> names(resource);
+                pmr::FlatMap<int, int> sortedValues(resource);
+                std::pmr::vector<int> values(resource);
+
+                for (int i = 0; i < elementCount; ++i)
+                {
+                    names.try_emplace(i, "Name long enough to not fit in the string");
+                    sortedValues.try_emplace((i * 7919) % elementCount, i);
+                    values.push_back(i);
+                }
+                DoNotOptimize(names.size() + sortedValues.size() + values.size());
+            }
+            endRequest();
+        }
+    };
+
+    const double newDeleteTime = MeasureMilliseconds([&]()
+        {
+            runRequests([]() { return std::pmr::new_delete_resource(); }, []() {});
+        });
+    PrintBenchmark("Requests (new/delete)", newDeleteTime, requestCount);
+
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        const double monotonicTime = MeasureMilliseconds([&]()
+            {
+                runRequests([&arena]() { return &arena; }, [&arena]() { arena.release(); });
+            });
+        PrintBenchmark("Requests (std::pmr::monotonic_buffer_resource)", monotonicTime, requestCount);
+    }
+
+    {
+        BumpResource arena;
+        const double bumpTime = MeasureMilliseconds([&]()
+            {
+                runRequests([&arena]() { return &arena; }, [&arena]() { arena.Reset(); });
+            });
+        PrintBenchmark("Requests (BumpResource Reset)", bumpTime, requestCount);
+    }
+
+    {
+        PoolResource arena;
+        const double poolTime = MeasureMilliseconds([&]()
+            {
+                runRequests([&arena]() { return &arena; }, []() {});
+            });
+        PrintBenchmark("Requests (PoolResource)", poolTime, requestCount);
+    }
+
+    std::printf("\n");
+}
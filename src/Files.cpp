@@ -198,3 +198,139 @@ void FileSystem()
         }
     }
 }
+
+// ---------------------
+// Memory mapped files
+// 
+// Contents of the file without copies, as std::span<const std::byte> or std::string_view.
+// See MemoryMappedFile.h
+// ---------------------
+
+#include <ranges>
+#include <string_view>
+#include "MemoryMappedFile.h"
+
+void MemoryMappedFiles()
+{
+    printf("--------------------------------\n");
+    printf("Memory mapped files\n");
+    printf("--------------------------------\n");
+
+    const std::filesystem::path filePath("MemoryMappedFileExample.txt");
+
+    if (std::ofstream outFile(filePath, std::ofstream::out | std::ofstream::binary);
+        outFile.is_open())
+    {
+        outFile << "INFO Starting\nWARNING Low memory\r\nINFO Running\nERROR Out of memory"; // No '\n' at the end
+        outFile.close();
+    }
+
+    // Sequential hint because it's read from beginning to end
+    if (const MemoryMappedFile file(filePath, MemoryMappedFile::AccessHint::Sequential);
+        file.IsOpen())
+    {
+        printf("File '%s' mapped with %zu bytes\n", filePath.generic_string().c_str(), file.GetSize());
+
+        // Lines are views of the mapped memory, no copies nor allocations
+        for (std::string_view line : LinesView(file.GetText()))
+        {
+            printf("Line: '%.*s'\n", static_cast<int>(line.size()), line.data());
+        }
+
+        // It's a forward range, so it composes with other views
+        auto notInfoLines = LinesView(file.GetText())
+            | std::views::filter([](std::string_view line) { return !line.starts_with("INFO"); });
+        printf("Lines that are not INFO: %td\n", std::ranges::distance(notInfoLines));
+
+        // Binary files are read as bytes
+        const std::span<const std::byte> bytes = file.GetBytes();
+        printf("First byte: 0x%02X\n", std::to_integer<unsigned int>(bytes[0]));
+    } // File is unmapped when closed
+    printf("\n");
+}
+
+// ---------------------
+// Benchmarks (run by bench executable)
+// ---------------------
+
+#include <cstring>
+#include "Benchmark.h"
+
+// Counts the lines and the lines with "ERROR" of a log file of 256 MB,
+// reading it with std::getline, with std::ostringstream and memory mapped.
+// The file is read once before measuring, so all of them read from the file cache.
+void BenchmarkFiles()
+{
+    const std::size_t fileSize = std::size_t(256) << 20;
+    const std::filesystem::path filePath = std::filesystem::temp_directory_path() / "BenchmarkFiles.log";
+
+    if (std::ofstream outFile(filePath, std::ofstream::out | std::ofstream::binary);
+        outFile.is_open())
+    {
+        const char* levels[] = { "INFO", "INFO", "WARNING", "ERROR" };
+        char line[128];
+        for (std::size_t written = 0, i = 0; written < fileSize; written += std::strlen(line), ++i)
+        {
+            std::snprintf(line, sizeof(line), "2024-01-01 00:00:%02zu.%06zu %s Request %zu finished in %zu us\n",
+                i % 60, i % 1000000, levels[i % 4], i, (i * 7919) % 100000);
+            outFile.write(line, std::strlen(line));
+        }
+    }
+
+    const std::size_t byteCount = std::filesystem::file_size(filePath);
+
+    auto countLines = [](const auto& lines, std::size_t& lineCount, std::size_t& errorCount)
+    {
+        for (std::string_view line : lines)
+        {
+            ++lineCount;
+            errorCount += line.find("ERROR") != std::string_view::npos;
+        }
+    };
+
+    auto benchmark = [&](const char* name, auto readFile)
+    {
+        std::size_t lineCount = 0;
+        std::size_t errorCount = 0;
+        readFile(lineCount, errorCount); // Warms up the file cache
+
+        const double time = MeasureBestMilliseconds(3, [&]()
+            {
+                lineCount = 0;
+                errorCount = 0;
+                readFile(lineCount, errorCount);
+            });
+        DoNotOptimize(errorCount);
+        PrintThroughput(name, time, lineCount, byteCount);
+    };
+
+    benchmark("Count lines (std::getline)", [&](std::size_t& lineCount, std::size_t& errorCount)
+        {
+            std::ifstream inFile(filePath, std::ifstream::in | std::ifstream::binary);
+            std::string line;
+            while (std::getline(inFile, line))
+            {
+                ++lineCount;
+                errorCount += line.find("ERROR") != std::string::npos;
+            }
+        });
+
+    benchmark("Count lines (std::ostringstream)", [&](std::size_t& lineCount, std::size_t& errorCount)
+        {
+            std::ifstream inFile(filePath, std::ifstream::in | std::ifstream::binary);
+            std::ostringstream stringStream;
+            stringStream << inFile.rdbuf();
+            const std::string text = stringStream.str();
+            countLines(LinesView(text), lineCount, errorCount);
+        });
+
+    benchmark("Count lines (MemoryMappedFile)", [&](std::size_t& lineCount, std::size_t& errorCount)
+        {
+            const MemoryMappedFile file(filePath, MemoryMappedFile::AccessHint::Sequential);
+            countLines(LinesView(file.GetText()), lineCount, errorCount);
+        });
+
+    std::filesystem::remove(filePath);
+
+    std::printf("\n");
+}
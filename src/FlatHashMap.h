@@ -0,0 +1,1032 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <initializer_list>
+
+// Define FLAT_HASH_MAP_SSE2 as 0 to use the portable version (SWAR) on x86 too.
+#ifndef FLAT_HASH_MAP_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_MAP_SSE2 1
+#else
+#define FLAT_HASH_MAP_SSE2 0
+#endif
+#endif
+
+#if FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+// --------------------------------------------------------------------------------
+// Flat Hash Map and Flat Hash Set
+//
+// Hash tables with open addressing (Swiss table style), as an alternative to
+// std::unordered_map and std::unordered_set when lookups dominate.
+//
+// std::unordered_* containers allocate a node per element and each bucket is a linked list,
+// so every lookup follows at least one pointer to memory that is likely not in cache.
+// Flat hash tables store the elements directly in one array of slots, with no allocations
+// per element, and a second array with one control byte per slot:
+// - Empty (0x80), Deleted (0xFE, tombstone of an erased element), or
+// - Full (0x00 - 0x7F), with the 7 bits H2 of the element's hash.
+//
+// Slots are in groups of 16 (8 without SSE2). The other bits of the hash (H1) choose the first
+// group to look at. Lookups compare the 16 control bytes of a group with H2 at once with SSE2
+// (or 8 bytes in a 64-bit integer, SWAR), so only the slots with the same H2 (1/128 of the false
+// candidates) compare the keys. When the group has an empty slot the key is not in the table,
+// otherwise it continues with the next group of the probe sequence (quadratic, by groups).
+//
+// The table grows when 7/8 of the slots are full or deleted, so probe sequences stay short.
+//
+// Same as std::unordered_*, it accepts custom Hash and Equal functors, and when both
+// have 'is_transparent' it allows heterogeneous lookup (finding with types other than the key).
+//
+// Differences with std::unordered_*:
+// - Any insertion can invalidate iterators, references and pointers to elements, as elements
+//   move to the new slots when the table grows. Erasing only invalidates the erased element.
+// - No buckets interface, extract, merge or multi versions.
+// - value_type of maps is std::pair<const Key, Value>, so keys are copied when the table grows.
+//
+// Both arrays are allocated with the Allocator, pmr::FlatHashMap and pmr::FlatHashSet use
+// std::pmr::polymorphic_allocator to allocate them from a std::pmr::memory_resource.
+//
+// https://abseil.io/about/design/swisstables
+// https://www.youtube.com/watch?v=ncHmEUmJZf4 (CppCon 2017: Matt Kulukundis "Designing a Fast, Efficient, Cache-friendly Hash Table, Step by Step")
+// --------------------------------------------------------------------------------
+
+namespace FlatHashDetail
+{
+    enum class Control : std::int8_t
+    {
+        Empty = -128, // 0b10000000
+        Deleted = -2, // 0b11111110
+        // Full: 0b0xxxxxxx, where x are the 7 bits of H2.
+    };
+
+    inline bool IsFull(std::int8_t control)
+    {
+        return control >= 0;
+    }
+
+    // Bit mask with the slots of a group that matched, to iterate through them.
+    // Shift is the number of bits per slot minus 1 (0 for SSE2, 3 for SWAR).
+    template<typename T, int Shift>
+    class BitMask
+    {
+    public:
+        explicit BitMask(T mask)
+            : m_mask(mask)
+        {
+        }
+
+        explicit operator bool() const
+        {
+            return m_mask != 0;
+        }
+
+        int GetLowestIndex() const
+        {
+            return std::countr_zero(m_mask) >> Shift;
+        }
+
+        // Iteration through the indices of the slots, lowest first.
+        BitMask& operator++()
+        {
+            m_mask &= m_mask - 1;
+            return *this;
+        }
+
+        int operator*() const
+        {
+            return GetLowestIndex();
+        }
+
+        BitMask begin() const
+        {
+            return *this;
+        }
+
+        BitMask end() const
+        {
+            return BitMask(0);
+        }
+
+        bool operator!=(const BitMask& other) const
+        {
+            return m_mask != other.m_mask;
+        }
+
+    private:
+        T m_mask;
+    };
+
+#if FLAT_HASH_MAP_SSE2
+    // Group of 16 control bytes, compared at once with SSE2 instructions.
+    class Group
+    {
+    public:
+        static constexpr std::size_t Width = 16;
+
+        explicit Group(const std::int8_t* controls)
+            : m_controls(_mm_loadu_si128(reinterpret_cast<const __m128i*>(controls)))
+        {
+        }
+
+        BitMask<std::uint32_t, 0> Match(std::int8_t h2) const
+        {
+            return BitMask<std::uint32_t, 0>(static_cast<std::uint32_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_controls))));
+        }
+
+        BitMask<std::uint32_t, 0> MatchEmpty() const
+        {
+            return Match(static_cast<std::int8_t>(Control::Empty));
+        }
+
+        // Empty and Deleted are the only negative values, movemask takes the sign bits.
+        BitMask<std::uint32_t, 0> MatchEmptyOrDeleted() const
+        {
+            return BitMask<std::uint32_t, 0>(static_cast<std::uint32_t>(_mm_movemask_epi8(m_controls)));
+        }
+
+    private:
+        __m128i m_controls;
+    };
+#else
+    // Group of 8 control bytes, compared at once in a 64-bit integer (SWAR: SIMD within a register).
+    // Each slot that matches has the high bit of its byte set in the mask.
+    class Group
+    {
+    public:
+        static constexpr std::size_t Width = 8;
+
+        explicit Group(const std::int8_t* controls)
+        {
+            // Little endian: the first control byte is the lowest byte.
+            std::memcpy(&m_controls, controls, sizeof(m_controls));
+            if constexpr (std::endian::native == std::endian::big)
+            {
+                m_controls = ByteSwap(m_controls);
+            }
+        }
+
+        // Bytes equal to zero after the xor are the matches. It can have false positives
+        // (a byte after a real match), which is fine as the keys are compared afterwards.
+        BitMask<std::uint64_t, 3> Match(std::int8_t h2) const
+        {
+            const std::uint64_t x = m_controls ^ (LowBits * static_cast<std::uint8_t>(h2));
+            return BitMask<std::uint64_t, 3>((x - LowBits) & ~x & HighBits);
+        }
+
+        // Empty is the only value with the high bit set and bit 1 not set.
+        BitMask<std::uint64_t, 3> MatchEmpty() const
+        {
+            return BitMask<std::uint64_t, 3>(m_controls & ~(m_controls << 6) & HighBits);
+        }
+
+        BitMask<std::uint64_t, 3> MatchEmptyOrDeleted() const
+        {
+            return BitMask<std::uint64_t, 3>(m_controls & HighBits);
+        }
+
+    private:
+        static constexpr std::uint64_t LowBits = 0x0101010101010101ull;
+        static constexpr std::uint64_t HighBits = 0x8080808080808080ull;
+
+        static std::uint64_t ByteSwap(std::uint64_t value)
+        {
+            std::uint64_t result = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                result = (result << 8) | ((value >> (8 * i)) & 0xFF);
+            }
+            return result;
+        }
+
+        std::uint64_t m_controls = 0;
+    };
+#endif
+
+    // Hash functions like std::hash<int> can be the identity, which would put consecutive keys
+    // in the same group and leave H2 with the same value. Multiplying mixes all the bits,
+    // so H1 (low bits, folded with the high ones) and H2 (top 7 bits) are well distributed.
+    struct MixedHash
+    {
+        explicit MixedHash(std::size_t hash)
+        {
+            const std::uint64_t mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+            m_h1 = static_cast<std::size_t>(mixed ^ (mixed >> 32));
+            m_h2 = static_cast<std::int8_t>(mixed >> 57);
+        }
+
+        std::size_t m_h1;
+        std::int8_t m_h2;
+    };
+
+    template<typename Hash, typename Equal>
+    constexpr bool IsTransparent = requires
+    {
+        typename Hash::is_transparent;
+        typename Equal::is_transparent;
+    };
+
+    // Common implementation of FlatHashMap and FlatHashSet.
+    // GetKey obtains the key of a value (the value itself for sets, first for maps).
+    template<typename Key, typename Value, typename Hash, typename Equal, typename Allocator, typename GetKey>
+    class FlatHashTable
+    {
+        using AllocatorTraits = std::allocator_traits<Allocator>;
+        using ControlAllocator = typename AllocatorTraits::template rebind_alloc<std::int8_t>;
+
+    public:
+        using key_type = Key;
+        using value_type = Value;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using hasher = Hash;
+        using key_equal = Equal;
+        using allocator_type = Allocator;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+
+        template<bool IsConst>
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = FlatHashTable::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+            using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+
+            Iterator() = default;
+
+            // Non-const iterators convert to const iterators.
+            template<bool OtherIsConst>
+                requires (IsConst && !OtherIsConst)
+            Iterator(const Iterator<OtherIsConst>& other)
+                : m_controls(other.m_controls)
+                , m_slot(other.m_slot)
+                , m_end(other.m_end)
+            {
+            }
+
+            reference operator*() const
+            {
+                return *m_slot;
+            }
+
+            pointer operator->() const
+            {
+                return m_slot;
+            }
+
+            Iterator& operator++()
+            {
+                ++m_controls;
+                ++m_slot;
+                SkipNonFull();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            template<bool OtherIsConst>
+            bool operator==(const Iterator<OtherIsConst>& other) const
+            {
+                return m_slot == other.m_slot;
+            }
+
+        private:
+            friend class FlatHashTable;
+            template<bool> friend class Iterator;
+
+            Iterator(const std::int8_t* controls, pointer slot, const std::int8_t* end)
+                : m_controls(controls)
+                , m_slot(slot)
+                , m_end(end)
+            {
+            }
+
+            void SkipNonFull()
+            {
+                while (m_controls != m_end && !IsFull(*m_controls))
+                {
+                    ++m_controls;
+                    ++m_slot;
+                }
+            }
+
+            const std::int8_t* m_controls = nullptr;
+            pointer m_slot = nullptr;
+            const std::int8_t* m_end = nullptr;
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        FlatHashTable() = default;
+
+        explicit FlatHashTable(const Allocator& allocator)
+            : m_allocator(allocator)
+        {
+        }
+
+        explicit FlatHashTable(size_type capacity, const Hash& hash = Hash(), const Equal& equal = Equal(),
+            const Allocator& allocator = Allocator())
+            : m_hash(hash)
+            , m_equal(equal)
+            , m_allocator(allocator)
+        {
+            reserve(capacity);
+        }
+
+        FlatHashTable(const FlatHashTable& other)
+            : FlatHashTable(other, AllocatorTraits::select_on_container_copy_construction(other.m_allocator))
+        {
+        }
+
+        FlatHashTable(const FlatHashTable& other, const Allocator& allocator)
+            : m_hash(other.m_hash)
+            , m_equal(other.m_equal)
+            , m_allocator(allocator)
+        {
+            CopyElementsFrom(other);
+        }
+
+        FlatHashTable(FlatHashTable&& other) noexcept
+            : m_hash(std::move(other.m_hash))
+            , m_equal(std::move(other.m_equal))
+            , m_allocator(std::move(other.m_allocator))
+        {
+            Swap(other);
+        }
+
+        FlatHashTable& operator=(const FlatHashTable& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                if constexpr (AllocatorTraits::propagate_on_container_copy_assignment::value)
+                {
+                    if (m_allocator != other.m_allocator)
+                    {
+                        FreeStorage();
+                    }
+                    m_allocator = other.m_allocator;
+                }
+                m_hash = other.m_hash;
+                m_equal = other.m_equal;
+                CopyElementsFrom(other);
+            }
+            return *this;
+        }
+
+        // The storage can only be taken from the other table when it can be freed with this allocator,
+        // otherwise (pmr tables of different memory resources) the elements are moved one by one.
+        FlatHashTable& operator=(FlatHashTable&& other)
+            noexcept(AllocatorTraits::propagate_on_container_move_assignment::value || AllocatorTraits::is_always_equal::value)
+        {
+            if (this != &other)
+            {
+                m_hash = std::move(other.m_hash);
+                m_equal = std::move(other.m_equal);
+                if (AllocatorTraits::propagate_on_container_move_assignment::value || m_allocator == other.m_allocator)
+                {
+                    FreeStorage();
+                    if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+                    {
+                        m_allocator = std::move(other.m_allocator);
+                    }
+                    Swap(other);
+                }
+                else
+                {
+                    clear();
+                    reserve(other.size());
+                    for (value_type& value : other)
+                    {
+                        const MixedHash hash(m_hash(GetKey::Get(value)));
+                        ConstructAt(FindInsertIndex(hash), hash, std::move(value));
+                    }
+                    other.clear();
+                }
+            }
+            return *this;
+        }
+
+        ~FlatHashTable()
+        {
+            DestroySlots();
+            Deallocate();
+        }
+
+        allocator_type get_allocator() const
+        {
+            return m_allocator;
+        }
+
+        iterator begin()
+        {
+            iterator it(m_controls, m_slots, m_controls + m_capacity);
+            it.SkipNonFull();
+            return it;
+        }
+
+        const_iterator begin() const
+        {
+            const_iterator it(m_controls, m_slots, m_controls + m_capacity);
+            it.SkipNonFull();
+            return it;
+        }
+
+        iterator end()
+        {
+            return iterator(m_controls + m_capacity, m_slots + m_capacity, m_controls + m_capacity);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(m_controls + m_capacity, m_slots + m_capacity, m_controls + m_capacity);
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        // Number of slots.
+        size_type capacity() const
+        {
+            return m_capacity;
+        }
+
+        float load_factor() const
+        {
+            return (m_capacity > 0) ? static_cast<float>(m_size) / static_cast<float>(m_capacity) : 0.0f;
+        }
+
+        // Makes room for count elements without growing.
+        void reserve(size_type count)
+        {
+            if (count > m_size + m_growthLeft)
+            {
+                Rehash(GetCapacityFor(count));
+            }
+        }
+
+        void clear()
+        {
+            DestroySlots();
+            if (m_capacity > 0)
+            {
+                std::memset(m_controls, static_cast<int>(Control::Empty), m_capacity);
+            }
+            m_size = 0;
+            m_growthLeft = GetMaxSize(m_capacity);
+        }
+
+        iterator find(const Key& key)
+        {
+            return IteratorAt(FindIndex(key));
+        }
+
+        const_iterator find(const Key& key) const
+        {
+            return IteratorAt(FindIndex(key));
+        }
+
+        template<typename K>
+            requires IsTransparent<Hash, Equal>
+        iterator find(const K& key)
+        {
+            return IteratorAt(FindIndex(key));
+        }
+
+        template<typename K>
+            requires IsTransparent<Hash, Equal>
+        const_iterator find(const K& key) const
+        {
+            return IteratorAt(FindIndex(key));
+        }
+
+        bool contains(const Key& key) const
+        {
+            return FindIndex(key) != m_capacity;
+        }
+
+        template<typename K>
+            requires IsTransparent<Hash, Equal>
+        bool contains(const K& key) const
+        {
+            return FindIndex(key) != m_capacity;
+        }
+
+        size_type count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        template<typename K>
+            requires IsTransparent<Hash, Equal>
+        size_type count(const K& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        // Returns the iterator to the element after the erased one.
+        iterator erase(const_iterator position)
+        {
+            const size_type index = static_cast<size_type>(position.m_controls - m_controls);
+            EraseAt(index);
+
+            iterator next(m_controls + index, m_slots + index, m_controls + m_capacity);
+            next.SkipNonFull();
+            return next;
+        }
+
+        iterator erase(iterator position)
+        {
+            return erase(const_iterator(position));
+        }
+
+        size_type erase(const Key& key)
+        {
+            return EraseKey(key);
+        }
+
+        template<typename K>
+            requires (IsTransparent<Hash, Equal> &&
+                !std::is_convertible_v<const K&, iterator> && !std::is_convertible_v<const K&, const_iterator>)
+        size_type erase(const K& key)
+        {
+            return EraseKey(key);
+        }
+
+        hasher hash_function() const
+        {
+            return m_hash;
+        }
+
+        key_equal key_eq() const
+        {
+            return m_equal;
+        }
+
+    protected:
+        // Finds the key, or constructs the value with the arguments if it's not found.
+        // Arguments are only used when inserting.
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> TryEmplaceImpl(const K& key, Args&&... args)
+        {
+            const MixedHash hash(m_hash(key));
+            if (const size_type index = FindIndex(key, hash); index != m_capacity)
+            {
+                return { IteratorAt(index), false };
+            }
+
+            // Tables are allocated with the first insertion.
+            if (m_capacity == 0)
+            {
+                Rehash(GetCapacityFor(1));
+            }
+
+            // Reusing a deleted slot doesn't reduce the empty slots, so it doesn't need to grow.
+            size_type index = FindInsertIndex(hash);
+            // It doubles the capacity, unless at least half of the used slots are deleted,
+            // then rehashing with the same capacity is enough to remove them.
+            if (m_growthLeft == 0 && m_controls[index] == static_cast<std::int8_t>(Control::Empty))
+            {
+                Rehash((m_size + 1 <= GetMaxSize(m_capacity) / 2) ? m_capacity : 2 * m_capacity);
+                index = FindInsertIndex(hash);
+            }
+
+            ConstructAt(index, hash, std::forward<Args>(args)...);
+            return { IteratorAt(index), true };
+        }
+
+    private:
+        static constexpr size_type GroupWidth = Group::Width;
+
+        // Elements allowed before growing (7/8 of the slots).
+        static size_type GetMaxSize(size_type capacity)
+        {
+            return capacity - capacity / 8;
+        }
+
+        // Smallest capacity (power of 2 number of groups) with room for count elements.
+        static size_type GetCapacityFor(size_type count)
+        {
+            size_type capacity = GroupWidth;
+            while (GetMaxSize(capacity) < count)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+
+        // Returned by the functions of Probe to continue with the next group.
+        static constexpr size_type ContinueProbe = static_cast<size_type>(-1);
+
+        // Calls function(groupStart) for the groups of the probe sequence until it returns
+        // something other than ContinueProbe. Probe sequence by groups: H1, H1 + 1, H1 + 1 + 2, ...
+        // With a power of 2 number of groups these triangular numbers visit all the groups.
+        template<typename Function>
+        size_type Probe(const MixedHash& hash, Function function) const
+        {
+            const size_type groupMask = m_capacity / GroupWidth - 1;
+            size_type group = hash.m_h1 & groupMask;
+            for (size_type step = 1; ; ++step)
+            {
+                if (const size_type result = function(group * GroupWidth); result != ContinueProbe)
+                {
+                    return result;
+                }
+                group = (group + step) & groupMask;
+            }
+        }
+
+        template<typename K>
+        size_type FindIndex(const K& key) const
+        {
+            return FindIndex(key, MixedHash(m_hash(key)));
+        }
+
+        // Index of the slot with the key, or capacity if it's not found.
+        template<typename K>
+        size_type FindIndex(const K& key, const MixedHash& hash) const
+        {
+            if (m_capacity == 0)
+            {
+                return m_capacity;
+            }
+
+            return Probe(hash, [&](size_type groupStart)
+                {
+                    const Group group(m_controls + groupStart);
+                    for (int i : group.Match(hash.m_h2))
+                    {
+                        if (m_equal(GetKey::Get(m_slots[groupStart + i]), key))
+                        {
+                            return groupStart + i;
+                        }
+                    }
+
+                    // The key would have been inserted in this group if it were in the table.
+                    return group.MatchEmpty() ? m_capacity : ContinueProbe;
+                });
+        }
+
+        // Index of the first empty or deleted slot of the probe sequence.
+        // There is always one, as the table never gets full.
+        size_type FindInsertIndex(const MixedHash& hash) const
+        {
+            return Probe(hash, [&](size_type groupStart)
+                {
+                    const auto mask = Group(m_controls + groupStart).MatchEmptyOrDeleted();
+                    return mask ? groupStart + mask.GetLowestIndex() : ContinueProbe;
+                });
+        }
+
+        // The control byte is set after constructing, so the slot stays empty if it throws.
+        template<typename... Args>
+        void ConstructAt(size_type index, const MixedHash& hash, Args&&... args)
+        {
+            AllocatorTraits::construct(m_allocator, m_slots + index, std::forward<Args>(args)...);
+
+            if (m_controls[index] == static_cast<std::int8_t>(Control::Empty))
+            {
+                --m_growthLeft;
+            }
+            m_controls[index] = hash.m_h2;
+            ++m_size;
+        }
+
+        // If the group has an empty slot, no probe sequence continued after this group
+        // so the slot can be empty again. Otherwise it's deleted, so the lookups of keys
+        // in later groups of the probe sequence don't stop here.
+        void EraseAt(size_type index)
+        {
+            AllocatorTraits::destroy(m_allocator, m_slots + index);
+            --m_size;
+
+            const size_type groupStart = index - index % GroupWidth;
+            if (Group(m_controls + groupStart).MatchEmpty())
+            {
+                m_controls[index] = static_cast<std::int8_t>(Control::Empty);
+                ++m_growthLeft;
+            }
+            else
+            {
+                m_controls[index] = static_cast<std::int8_t>(Control::Deleted);
+            }
+        }
+
+        template<typename K>
+        size_type EraseKey(const K& key)
+        {
+            const size_type index = FindIndex(key);
+            if (index == m_capacity)
+            {
+                return 0;
+            }
+            EraseAt(index);
+            return 1;
+        }
+
+        // Moves the elements to a new table with the capacity, which also removes the deleted slots.
+        void Rehash(size_type newCapacity)
+        {
+            FlatHashTable newTable(m_allocator);
+            newTable.Allocate(newCapacity);
+
+            for (size_type i = 0; i < m_capacity; ++i)
+            {
+                if (IsFull(m_controls[i]))
+                {
+                    const MixedHash hash(m_hash(GetKey::Get(m_slots[i])));
+                    newTable.ConstructAt(newTable.FindInsertIndex(hash), hash, std::move(m_slots[i]));
+                }
+            }
+
+            Swap(newTable);
+        }
+
+        // Only for tables without storage. If allocating the slots throws, the table
+        // keeps the empty control bytes, which the destructor frees.
+        void Allocate(size_type capacity)
+        {
+            ControlAllocator controlAllocator(m_allocator);
+            m_controls = std::allocator_traits<ControlAllocator>::allocate(controlAllocator, capacity);
+            std::memset(m_controls, static_cast<int>(Control::Empty), capacity);
+            m_capacity = capacity;
+            m_slots = AllocatorTraits::allocate(m_allocator, capacity);
+            m_growthLeft = GetMaxSize(capacity);
+        }
+
+        void Deallocate()
+        {
+            if (m_controls)
+            {
+                ControlAllocator controlAllocator(m_allocator);
+                std::allocator_traits<ControlAllocator>::deallocate(controlAllocator, m_controls, m_capacity);
+            }
+            if (m_slots)
+            {
+                AllocatorTraits::deallocate(m_allocator, m_slots, m_capacity);
+            }
+        }
+
+        // Destroys the elements and frees the storage, leaving the table without capacity.
+        void FreeStorage()
+        {
+            DestroySlots();
+            Deallocate();
+            m_controls = nullptr;
+            m_slots = nullptr;
+            m_capacity = 0;
+            m_size = 0;
+            m_growthLeft = 0;
+        }
+
+        // Keys are unique already, no need to look for them.
+        void CopyElementsFrom(const FlatHashTable& other)
+        {
+            reserve(other.size());
+            for (const value_type& value : other)
+            {
+                const MixedHash hash(m_hash(GetKey::Get(value)));
+                ConstructAt(FindInsertIndex(hash), hash, value);
+            }
+        }
+
+        void DestroySlots()
+        {
+            if constexpr (!std::is_trivially_destructible_v<value_type>)
+            {
+                for (size_type i = 0; i < m_capacity; ++i)
+                {
+                    if (IsFull(m_controls[i]))
+                    {
+                        AllocatorTraits::destroy(m_allocator, m_slots + i);
+                    }
+                }
+            }
+        }
+
+        // Swaps the storage, not the functors.
+        void Swap(FlatHashTable& other) noexcept
+        {
+            std::swap(m_controls, other.m_controls);
+            std::swap(m_slots, other.m_slots);
+            std::swap(m_capacity, other.m_capacity);
+            std::swap(m_size, other.m_size);
+            std::swap(m_growthLeft, other.m_growthLeft);
+        }
+
+        iterator IteratorAt(size_type index)
+        {
+            return iterator(m_controls + index, m_slots + index, m_controls + m_capacity);
+        }
+
+        const_iterator IteratorAt(size_type index) const
+        {
+            return const_iterator(m_controls + index, m_slots + index, m_controls + m_capacity);
+        }
+
+        std::int8_t* m_controls = nullptr;
+        value_type* m_slots = nullptr;
+        size_type m_capacity = 0;
+        size_type m_size = 0;
+        size_type m_growthLeft = 0; // Empty slots that can be used before growing.
+
+        [[no_unique_address]] Hash m_hash;
+        [[no_unique_address]] Equal m_equal;
+        [[no_unique_address]] Allocator m_allocator;
+    };
+
+    struct SetGetKey
+    {
+        template<typename T>
+        static const T& Get(const T& value)
+        {
+            return value;
+        }
+    };
+
+    struct MapGetKey
+    {
+        template<typename Pair>
+        static const auto& Get(const Pair& pair)
+        {
+            return pair.first;
+        }
+    };
+}
+
+template<typename Key, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>,
+    typename Allocator = std::allocator<Key>>
+class FlatHashSet : public FlatHashDetail::FlatHashTable<Key, Key, Hash, Equal, Allocator, FlatHashDetail::SetGetKey>
+{
+    using Base = FlatHashDetail::FlatHashTable<Key, Key, Hash, Equal, Allocator, FlatHashDetail::SetGetKey>;
+
+public:
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+
+    using Base::Base;
+
+    FlatHashSet(std::initializer_list<Key> values, const Allocator& allocator = Allocator())
+        : Base(allocator)
+    {
+        this->reserve(values.size());
+        for (const Key& value : values)
+        {
+            insert(value);
+        }
+    }
+
+    std::pair<iterator, bool> insert(const Key& value)
+    {
+        return this->TryEmplaceImpl(value, value);
+    }
+
+    std::pair<iterator, bool> insert(Key&& value)
+    {
+        return this->TryEmplaceImpl(value, std::move(value));
+    }
+
+    // The key is constructed first to find it.
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return insert(Key(std::forward<Args>(args)...));
+    }
+};
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>,
+    typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class FlatHashMap : public FlatHashDetail::FlatHashTable<Key, std::pair<const Key, Value>, Hash, Equal, Allocator, FlatHashDetail::MapGetKey>
+{
+    using Base = FlatHashDetail::FlatHashTable<Key, std::pair<const Key, Value>, Hash, Equal, Allocator, FlatHashDetail::MapGetKey>;
+
+public:
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+    using typename Base::value_type;
+    using mapped_type = Value;
+
+    using Base::Base;
+
+    FlatHashMap(std::initializer_list<value_type> values, const Allocator& allocator = Allocator())
+        : Base(allocator)
+    {
+        this->reserve(values.size());
+        for (const value_type& value : values)
+        {
+            insert(value);
+        }
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        return this->TryEmplaceImpl(value.first, value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        return this->TryEmplaceImpl(value.first, std::move(value));
+    }
+
+    // The pair is constructed first to find its key.
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    // Value is only constructed with the arguments if the key is not found.
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+    {
+        return this->TryEmplaceImpl(key, std::piecewise_construct,
+            std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+    {
+        return this->TryEmplaceImpl(key, std::piecewise_construct,
+            std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename V>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value)
+    {
+        auto result = try_emplace(key, std::forward<V>(value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    Value& operator[](const Key& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    Value& operator[](Key&& key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    Value& at(const Key& key)
+    {
+        auto it = this->find(key);
+        if (it == this->end())
+        {
+            throw std::out_of_range("FlatHashMap::at: key not found");
+        }
+        return it->second;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        auto it = this->find(key);
+        if (it == this->end())
+        {
+            throw std::out_of_range("FlatHashMap::at: key not found");
+        }
+        return it->second;
+    }
+};
+
+namespace pmr
+{
+    template<typename Key, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+    using FlatHashSet = ::FlatHashSet<Key, Hash, Equal, std::pmr::polymorphic_allocator<Key>>;
+
+    template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+    using FlatHashMap = ::FlatHashMap<Key, Value, Hash, Equal, std::pmr::polymorphic_allocator<std::pair<const Key, Value>>>;
+}
@@ -0,0 +1,539 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <tuple>
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+
+// --------------------------------------------------------------------------------
+// Flat Map and Flat Set
+//
+// Ordered containers stored as a sorted std::vector, as an alternative to std::map and
+// std::set for data that is built once (or rarely modified) and searched many times.
+//
+// std::map and std::set allocate a node per element of a red-black tree. Each node has the
+// element, 3 pointers and the color (48 bytes for a pair of 2 ints on 64-bit platforms, plus
+// the allocation overhead), and a search follows log(n) pointers to nodes spread in memory.
+// Flat containers only take sizeof(value_type) per element, and searches are binary searches
+// in contiguous memory. Iterating through a range of keys reads memory sequentially.
+//
+// Bad for insertion and deletion of elements, which move all the elements after them, O(n).
+// To build them from many elements, construct them with all the elements at once (unsorted),
+// which sorts them once, O(n log n), instead of inserting one by one, O(n^2).
+//
+// Searches use a branchless binary search: it always does log(n) steps, and each step
+// chooses the half with a conditional move instead of a branch. Branches are unpredictable
+// in binary searches (50% taken), and each misprediction costs more than the extra steps.
+//
+// Differences with std::map and std::set:
+// - Insertions and deletions invalidate iterators, references and pointers to elements.
+// - value_type of maps is std::pair<Key, Value>, its keys must not be modified through iterators.
+//
+// Same as std::map and std::set, when Compare has 'is_transparent' it allows heterogeneous
+// lookup (searching with types other than the key).
+//
+// The vector uses the Allocator, pmr::FlatMap and pmr::FlatSet use std::pmr::polymorphic_allocator
+// to allocate it from a std::pmr::memory_resource.
+// --------------------------------------------------------------------------------
+
+// Tag for constructing from elements already sorted and without repeated keys.
+struct SortedUniqueTag
+{
+};
+inline constexpr SortedUniqueTag SortedUnique;
+
+namespace FlatMapDetail
+{
+    template<typename Compare>
+    constexpr bool IsTransparent = requires
+    {
+        typename Compare::is_transparent;
+    };
+
+    // Index of the first element for which isBefore is false, where all the elements
+    // for which isBefore is true are at the beginning. The range of possible results
+    // [base, base + count] halves each step, moving base without branches.
+    template<typename T, typename IsBefore>
+    std::size_t BranchlessPartitionPoint(const T* elements, std::size_t count, IsBefore isBefore)
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+
+        const T* base = elements;
+        while (count > 1)
+        {
+            const std::size_t half = count / 2;
+            base = isBefore(base[half]) ? base + half : base;
+            count -= half;
+        }
+        return static_cast<std::size_t>(base - elements) + (isBefore(*base) ? 1 : 0);
+    }
+
+    // Common implementation of FlatMap and FlatSet.
+    // GetKey obtains the key of a value (the value itself for sets, first for maps).
+    template<typename Key, typename Value, typename Compare, typename Allocator, typename GetKey>
+    class FlatSortedTable
+    {
+    public:
+        using container_type = std::vector<Value, Allocator>;
+        using key_type = Key;
+        using value_type = Value;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using key_compare = Compare;
+        using allocator_type = Allocator;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using const_iterator = typename container_type::const_iterator;
+        // Same as const_iterator when the values are the keys (sets, like std::set),
+        // writing them could break the order the binary searches rely on.
+        using iterator = std::conditional_t<GetKey::IsValueTheKey, const_iterator, typename container_type::iterator>;
+
+        FlatSortedTable() = default;
+
+        explicit FlatSortedTable(const Allocator& allocator)
+            : m_values(allocator)
+        {
+        }
+
+        // Sorts the values and removes the repeated keys, keeping the first one (as if inserting them in order).
+        // The table uses the allocator of the values.
+        explicit FlatSortedTable(container_type values, const Compare& compare = Compare())
+            : m_values(std::move(values))
+            , m_compare(compare)
+        {
+            std::stable_sort(m_values.begin(), m_values.end(), [this](const Value& left, const Value& right)
+                {
+                    return m_compare(GetKey::Get(left), GetKey::Get(right));
+                });
+
+            auto last = std::unique(m_values.begin(), m_values.end(), [this](const Value& left, const Value& right)
+                {
+                    return !m_compare(GetKey::Get(left), GetKey::Get(right));
+                });
+            m_values.erase(last, m_values.end());
+        }
+
+        // The values must be sorted and without repeated keys.
+        FlatSortedTable(SortedUniqueTag, container_type values, const Compare& compare = Compare())
+            : m_values(std::move(values))
+            , m_compare(compare)
+        {
+        }
+
+        FlatSortedTable(std::initializer_list<Value> values, const Compare& compare = Compare(),
+            const Allocator& allocator = Allocator())
+            : FlatSortedTable(container_type(values, allocator), compare)
+        {
+        }
+
+        iterator begin()
+        {
+            return m_values.begin();
+        }
+
+        const_iterator begin() const
+        {
+            return m_values.begin();
+        }
+
+        const_iterator cbegin() const
+        {
+            return m_values.cbegin();
+        }
+
+        iterator end()
+        {
+            return m_values.end();
+        }
+
+        const_iterator end() const
+        {
+            return m_values.end();
+        }
+
+        const_iterator cend() const
+        {
+            return m_values.cend();
+        }
+
+        bool empty() const
+        {
+            return m_values.empty();
+        }
+
+        size_type size() const
+        {
+            return m_values.size();
+        }
+
+        void reserve(size_type count)
+        {
+            m_values.reserve(count);
+        }
+
+        void shrink_to_fit()
+        {
+            m_values.shrink_to_fit();
+        }
+
+        void clear()
+        {
+            m_values.clear();
+        }
+
+        // Sorted values, contiguous in memory.
+        const container_type& GetValues() const
+        {
+            return m_values;
+        }
+
+        allocator_type get_allocator() const
+        {
+            return m_values.get_allocator();
+        }
+
+        iterator lower_bound(const Key& key)
+        {
+            return begin() + LowerBoundIndex(key);
+        }
+
+        const_iterator lower_bound(const Key& key) const
+        {
+            return begin() + LowerBoundIndex(key);
+        }
+
+        iterator upper_bound(const Key& key)
+        {
+            return begin() + UpperBoundIndex(key);
+        }
+
+        const_iterator upper_bound(const Key& key) const
+        {
+            return begin() + UpperBoundIndex(key);
+        }
+
+        iterator find(const Key& key)
+        {
+            return begin() + FindIndex(key);
+        }
+
+        const_iterator find(const Key& key) const
+        {
+            return begin() + FindIndex(key);
+        }
+
+        bool contains(const Key& key) const
+        {
+            return FindIndex(key) != size();
+        }
+
+        size_type count(const Key& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        std::pair<iterator, iterator> equal_range(const Key& key)
+        {
+            return { lower_bound(key), upper_bound(key) };
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const Key& key) const
+        {
+            return { lower_bound(key), upper_bound(key) };
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        iterator lower_bound(const K& key)
+        {
+            return begin() + LowerBoundIndex(key);
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        const_iterator lower_bound(const K& key) const
+        {
+            return begin() + LowerBoundIndex(key);
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        iterator upper_bound(const K& key)
+        {
+            return begin() + UpperBoundIndex(key);
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        const_iterator upper_bound(const K& key) const
+        {
+            return begin() + UpperBoundIndex(key);
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        iterator find(const K& key)
+        {
+            return begin() + FindIndex(key);
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        const_iterator find(const K& key) const
+        {
+            return begin() + FindIndex(key);
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        bool contains(const K& key) const
+        {
+            return FindIndex(key) != size();
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        size_type count(const K& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        std::pair<iterator, iterator> equal_range(const K& key)
+        {
+            return { lower_bound(key), upper_bound(key) };
+        }
+
+        template<typename K>
+            requires IsTransparent<Compare>
+        std::pair<const_iterator, const_iterator> equal_range(const K& key) const
+        {
+            return { lower_bound(key), upper_bound(key) };
+        }
+
+        // O(n), it moves all the elements after the inserted one.
+        std::pair<iterator, bool> insert(const Value& value)
+        {
+            return TryEmplaceImpl(GetKey::Get(value), value);
+        }
+
+        std::pair<iterator, bool> insert(Value&& value)
+        {
+            return TryEmplaceImpl(GetKey::Get(value), std::move(value));
+        }
+
+        // The value is constructed first to find its key.
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            return insert(Value(std::forward<Args>(args)...));
+        }
+
+        // O(n), it moves all the elements after the erased ones.
+        iterator erase(const_iterator position)
+        {
+            return m_values.erase(position);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            return m_values.erase(first, last);
+        }
+
+        size_type erase(const Key& key)
+        {
+            return EraseKey(key);
+        }
+
+        template<typename K>
+            requires (IsTransparent<Compare> &&
+                !std::is_convertible_v<const K&, iterator> && !std::is_convertible_v<const K&, const_iterator>)
+        size_type erase(const K& key)
+        {
+            return EraseKey(key);
+        }
+
+        key_compare key_comp() const
+        {
+            return m_compare;
+        }
+
+    protected:
+        // Finds the key, or inserts the value constructed with the arguments at its sorted position.
+        // Arguments are only used when inserting.
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> TryEmplaceImpl(const K& key, Args&&... args)
+        {
+            const size_type index = LowerBoundIndex(key);
+            if (index != size() && !m_compare(key, GetKey::Get(m_values[index])))
+            {
+                return { begin() + index, false };
+            }
+            return { m_values.emplace(begin() + index, std::forward<Args>(args)...), true };
+        }
+
+    private:
+        template<typename K>
+        size_type LowerBoundIndex(const K& key) const
+        {
+            return BranchlessPartitionPoint(m_values.data(), m_values.size(), [&](const Value& value)
+                {
+                    return m_compare(GetKey::Get(value), key);
+                });
+        }
+
+        template<typename K>
+        size_type UpperBoundIndex(const K& key) const
+        {
+            return BranchlessPartitionPoint(m_values.data(), m_values.size(), [&](const Value& value)
+                {
+                    return !m_compare(key, GetKey::Get(value));
+                });
+        }
+
+        // Index of the element with the key, or size if it's not found.
+        template<typename K>
+        size_type FindIndex(const K& key) const
+        {
+            const size_type index = LowerBoundIndex(key);
+            return (index != size() && !m_compare(key, GetKey::Get(m_values[index]))) ? index : size();
+        }
+
+        template<typename K>
+        size_type EraseKey(const K& key)
+        {
+            const size_type index = FindIndex(key);
+            if (index == size())
+            {
+                return 0;
+            }
+            m_values.erase(begin() + index);
+            return 1;
+        }
+
+        container_type m_values;
+        [[no_unique_address]] Compare m_compare;
+    };
+
+    struct SetGetKey
+    {
+        static constexpr bool IsValueTheKey = true;
+
+        template<typename T>
+        static const T& Get(const T& value)
+        {
+            return value;
+        }
+    };
+
+    struct MapGetKey
+    {
+        static constexpr bool IsValueTheKey = false;
+
+        template<typename Pair>
+        static const auto& Get(const Pair& pair)
+        {
+            return pair.first;
+        }
+    };
+}
+
+template<typename Key, typename Compare = std::less<Key>, typename Allocator = std::allocator<Key>>
+class FlatSet : public FlatMapDetail::FlatSortedTable<Key, Key, Compare, Allocator, FlatMapDetail::SetGetKey>
+{
+    using Base = FlatMapDetail::FlatSortedTable<Key, Key, Compare, Allocator, FlatMapDetail::SetGetKey>;
+
+public:
+    using Base::Base;
+};
+
+template<typename Key, typename Value, typename Compare = std::less<Key>,
+    typename Allocator = std::allocator<std::pair<Key, Value>>>
+class FlatMap : public FlatMapDetail::FlatSortedTable<Key, std::pair<Key, Value>, Compare, Allocator, FlatMapDetail::MapGetKey>
+{
+    using Base = FlatMapDetail::FlatSortedTable<Key, std::pair<Key, Value>, Compare, Allocator, FlatMapDetail::MapGetKey>;
+
+public:
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+    using typename Base::value_type;
+    using mapped_type = Value;
+
+    using Base::Base;
+
+    // Value is only constructed with the arguments if the key is not found.
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+    {
+        return this->TryEmplaceImpl(key, std::piecewise_construct,
+            std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+    {
+        return this->TryEmplaceImpl(key, std::piecewise_construct,
+            std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template<typename V>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value)
+    {
+        auto result = try_emplace(key, std::forward<V>(value));
+        if (!result.second)
+        {
+            result.first->second = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    Value& operator[](const Key& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    Value& operator[](Key&& key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    Value& at(const Key& key)
+    {
+        auto it = this->find(key);
+        if (it == this->end())
+        {
+            throw std::out_of_range("FlatMap::at: key not found");
+        }
+        return it->second;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        auto it = this->find(key);
+        if (it == this->end())
+        {
+            throw std::out_of_range("FlatMap::at: key not found");
+        }
+        return it->second;
+    }
+};
+
+namespace pmr
+{
+    template<typename Key, typename Compare = std::less<Key>>
+    using FlatSet = ::FlatSet<Key, Compare, std::pmr::polymorphic_allocator<Key>>;
+
+    template<typename Key, typename Value, typename Compare = std::less<Key>>
+    using FlatMap = ::FlatMap<Key, Value, Compare, std::pmr::polymorphic_allocator<std::pair<Key, Value>>>;
+}
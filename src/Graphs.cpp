@@ -3,8 +3,31 @@
 #include <list>
 #include <stack>
 #include <queue>
+#include <cstdint>
 #include <algorithm>
+#include <iterator>
+#include <numeric>
 #include <ranges>
+#include <span>
+#include <atomic>
+#include <bit>
+#include <random>
+#include <limits>
+#include <cmath>
+#include <type_traits>
+#include <memory_resource>
+#include <memory>
+#include <optional>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+#include "ThreadPool.h"
+#include "SmallVector.h"
+#include "MemoryResources.h"
+#include "MemoryMappedFile.h"
+#include "Benchmark.h"
+#include "Instrumentation.h"
 
 // --------------------------------------------------------------------------------
 // Graph
@@ -36,6 +59,19 @@ struct Edge
     float m_weight = 0.0f;
 };
 
+// Graphs without arena use the default memory resource (new/delete).
+static std::pmr::memory_resource* ArenaOrDefault(std::pmr::memory_resource* arena)
+{
+    return arena ? arena : std::pmr::get_default_resource();
+}
+
+// Besides the virtual interface, every graph representation also provides a non-virtual
+// 'Edges(int v)' function that returns a view of the edges of a vertex. Unlike GetEdges,
+// it doesn't copy the edges into a new vector, so it makes no allocations.
+//
+// All the representations can allocate their memory from an arena (std::pmr::memory_resource),
+// for example to build a graph per request and free all its memory at once with the arena.
+// The arena must outlive the graph.
 class Graph
 {
 public:
@@ -49,6 +85,23 @@ public:
     virtual float GetEdge(int v1, int v2) const = 0;
     virtual void SetEdge(int v1, int v2, float weight) = 0;
     virtual void Print() const = 0;
+    virtual int GetVertexCount() const = 0;
+
+    // Adds a batch of edges, same as calling SetEdge with each of them.
+    // Representations override it to add all the edges in one pass,
+    // reserving the memory needed once instead of growing per edge.
+    virtual void SetEdges(std::span<const Edge> edges)
+    {
+        for (const Edge& edge : edges)
+        {
+            SetEdge(edge.m_vertex1, edge.m_vertex2, edge.m_weight);
+        }
+    }
+
+    bool IsDirected() const
+    {
+        return m_isDirected;
+    }
 
 protected:
     bool m_isDirected = true;
@@ -62,52 +115,165 @@ protected:
 // + Simple
 // - To get the list of edges of a vertex or to check if a vertex is connected to another
 //   we have to search the entire edge list. O(e)
-// - Number of nodes information is not directly stored, extra data is necessary to keep it.
+// - Number of nodes information is not directly stored, it's deduced from the edges added.
+// 
+// Optionally it can keep a hash index of the edges by their vertices, which makes
+// checking if a vertex is connected to another O(1). It also allows SetEdge to update
+// the edges that already exist instead of adding them again.
 // --------------------------------------------------------------------------------
 
-using EdgeList = std::vector<Edge>;
+using EdgeList = std::pmr::vector<Edge>;
 
-class GraphEdgeList : public Graph
+// Hash table from the vertices of an edge to its position in the edge list.
+// 
+// It uses open addressing with linear probing: all the slots are in one array and
+// collisions use the next free slot, so a lookup usually reads a single cache line.
+// Edges are never removed from the edge list, so there is no need to support removals.
+class EdgeHashIndex
 {
 public:
-    GraphEdgeList(bool isDirected = true)
-        : Graph(isDirected)
+    explicit EdgeHashIndex(std::pmr::memory_resource* arena = nullptr)
+        : m_slots(ArenaOrDefault(arena))
     {
     }
 
-    std::vector<Edge> GetEdges(int v) const override
+    // Position of the edge in the edge list, -1 if not found.
+    int Find(int v1, int v2) const
     {
-        std::vector<Edge> edges;
-        edges.reserve(m_edgeList.size());
+        if (m_slots.empty())
+        {
+            return -1;
+        }
 
-        if (m_isDirected)
+        const std::uint64_t key = MakeKey(v1, v2);
+        for (std::size_t i = Hash(key) & m_mask; m_slots[i].m_edgeIndex >= 0; i = (i + 1) & m_mask)
         {
-            for (const auto& edge : m_edgeList)
+            if (m_slots[i].m_key == key)
             {
-                if (edge.m_vertex1 == v)
-                {
-                    edges.push_back(edge);
-                }
+                return m_slots[i].m_edgeIndex;
             }
         }
-        else
+        return -1;
+    }
+
+    // Edge must not be in the index already.
+    void Insert(int v1, int v2, int edgeIndex)
+    {
+        // Growing at 50% load keeps the probe sequences short.
+        if (2 * (m_size + 1) > m_slots.size())
+        {
+            Rehash(std::max<std::size_t>(16, 2 * m_slots.size()));
+        }
+
+        InsertKey(MakeKey(v1, v2), edgeIndex);
+        ++m_size;
+    }
+
+private:
+    struct Slot
+    {
+        std::uint64_t m_key = 0;
+        int m_edgeIndex = -1; // -1 when empty
+    };
+
+    static std::uint64_t MakeKey(int v1, int v2)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(v1)) << 32) | static_cast<std::uint32_t>(v2);
+    }
+
+    // Mixes all the bits of the key, so vertices close to each other don't collide.
+    static std::size_t Hash(std::uint64_t key)
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ull;
+        key ^= key >> 33;
+        return static_cast<std::size_t>(key);
+    }
+
+    void InsertKey(std::uint64_t key, int edgeIndex)
+    {
+        std::size_t i = Hash(key) & m_mask;
+        while (m_slots[i].m_edgeIndex >= 0)
         {
-            for (const auto& edge : m_edgeList)
+            i = (i + 1) & m_mask;
+        }
+        m_slots[i] = { key, edgeIndex };
+    }
+
+    // Capacity must be a power of 2.
+    void Rehash(std::size_t capacity)
+    {
+        std::pmr::vector<Slot> oldSlots(capacity, m_slots.get_allocator());
+        oldSlots.swap(m_slots);
+        m_mask = capacity - 1;
+
+        for (const Slot& slot : oldSlots)
+        {
+            if (slot.m_edgeIndex >= 0)
             {
-                if (edge.m_vertex1 == v ||
-                    edge.m_vertex2 == v)
-                {
-                    edges.push_back(edge);
-                }
+                InsertKey(slot.m_key, slot.m_edgeIndex);
             }
         }
+    }
+
+    std::pmr::vector<Slot> m_slots;
+    std::size_t m_mask = 0;
+    std::size_t m_size = 0;
+};
+
+class GraphEdgeList : public Graph
+{
+public:
+    GraphEdgeList(bool isDirected = true, bool isIndexed = false, std::pmr::memory_resource* arena = nullptr)
+        : Graph(isDirected)
+        , m_edgeList(ArenaOrDefault(arena))
+        , m_isIndexed(isIndexed)
+        , m_edgeIndex(arena)
+    {
+    }
+
+    // View of the edges of the vertex. No allocations, but it still
+    // has to search the entire edge list. O(e)
+    // 
+    // When graph is undirected the edges are given from v to the other vertex.
+    auto Edges(int v) const
+    {
+        return m_edgeList
+            | std::views::filter([this, v](const Edge& edge)
+                {
+                    return edge.m_vertex1 == v || (!m_isDirected && edge.m_vertex2 == v);
+                })
+            | std::views::transform([v](const Edge& edge)
+                {
+                    return (edge.m_vertex1 == v)
+                        ? edge
+                        : Edge{ v, edge.m_vertex1, edge.m_weight };
+                });
+    }
+
+    std::vector<Edge> GetEdges(int v) const override
+    {
+        auto vertexEdges = Edges(v);
 
-        edges.shrink_to_fit();
+        // Counting first so there is only one allocation.
+        std::vector<Edge> edges;
+        edges.reserve(std::ranges::distance(vertexEdges));
+        std::ranges::copy(vertexEdges, std::back_inserter(edges));
         return edges;
     }
 
     float GetEdge(int v1, int v2) const override
     {
+        if (m_isIndexed)
+        {
+            const int edgeIndex = FindIndexed(v1, v2);
+            return (edgeIndex >= 0)
+                ? m_edgeList[edgeIndex].m_weight
+                : 0.0f;
+        }
+
         auto it = std::ranges::find_if(m_edgeList,
             [&](const Edge& edge)
             {
@@ -135,8 +301,50 @@ public:
             return;
         }
 
-        // NOTE: It should check if edge already exists. Not doing it for simplicity.
+        if (m_isIndexed)
+        {
+            // Updating the edge if it already exists.
+            if (const int edgeIndex = FindIndexed(v1, v2);
+                edgeIndex >= 0)
+            {
+                m_edgeList[edgeIndex].m_weight = weight;
+                return;
+            }
+
+            if (m_isDirected)
+            {
+                m_edgeIndex.Insert(v1, v2, static_cast<int>(m_edgeList.size()));
+            }
+            else
+            {
+                m_edgeIndex.Insert(std::min(v1, v2), std::max(v1, v2), static_cast<int>(m_edgeList.size()));
+            }
+        }
+
+        // NOTE: Without index it doesn't check if edge already exists, as it'd be O(e).
         m_edgeList.emplace_back(v1, v2, weight);
+
+        m_vertexCount = std::max({ m_vertexCount, v1 + 1, v2 + 1 });
+    }
+
+    void SetEdges(std::span<const Edge> edges) override
+    {
+        // Indexed graph has to check each edge.
+        if (m_isIndexed)
+        {
+            Graph::SetEdges(edges);
+            return;
+        }
+
+        m_edgeList.reserve(m_edgeList.size() + edges.size());
+        for (const Edge& edge : edges)
+        {
+            if (edge.m_weight != 0.0f)
+            {
+                m_edgeList.push_back(edge);
+                m_vertexCount = std::max({ m_vertexCount, edge.m_vertex1 + 1, edge.m_vertex2 + 1 });
+            }
+        }
     }
 
     void Print() const override
@@ -149,8 +357,35 @@ public:
         std::printf("\n");
     }
 
+    int GetVertexCount() const override
+    {
+        return m_vertexCount;
+    }
+
+    const EdgeList& GetEdgeList() const
+    {
+        return m_edgeList;
+    }
+
+    bool IsIndexed() const
+    {
+        return m_isIndexed;
+    }
+
 private:
+    // Undirected edges are indexed with the lower vertex first,
+    // so both orders of the vertices find the same edge.
+    int FindIndexed(int v1, int v2) const
+    {
+        return m_isDirected
+            ? m_edgeIndex.Find(v1, v2)
+            : m_edgeIndex.Find(std::min(v1, v2), std::max(v1, v2));
+    }
+
     EdgeList m_edgeList;
+    int m_vertexCount = 0;
+    bool m_isIndexed = false;
+    EdgeHashIndex m_edgeIndex;
 };
 
 void GraphsAsEdgeList()
@@ -167,6 +402,16 @@ void GraphsAsEdgeList()
     graph.SetEdge(4, 5, 4.0f);
 
     graph.Print();
+
+    // Indexed graph updates existing edges instead of adding them again
+    GraphEdgeList indexedGraph(false, true);
+    indexedGraph.SetEdge(0, 1, 7.0f);
+    indexedGraph.SetEdge(1, 3, 5.0f);
+    indexedGraph.SetEdge(1, 0, 2.0f);
+
+    indexedGraph.Print();
+
+    std::printf("Edge 0 -> 1: %.1f\n\n", indexedGraph.GetEdge(0, 1));
 }
 
 // ---------------------------------------------
@@ -179,55 +424,182 @@ void GraphsAsEdgeList()
 // - To get the list of edges of a vertex we have to search
 //   its entire row of vertices. O(v)
 // - Uses O(v^2) space, which is a waste if graph has few edges.
+// 
+// The matrix is stored in one contiguous buffer, row after row, instead of a vector
+// per vertex. Besides the weights, it keeps a matrix of bits telling which cells
+// are connected, so searching a row checks 64 vertices at a time, jumping directly
+// to the connected ones. Unweighted graphs only keep the bits, using 1 bit per cell
+// instead of 4 bytes, and all their edges have weight 1.
 // ---------------------------------------------
 
-using AdjecencyMatrix = std::vector<std::vector<float>>;
-
-class GraphAdjecencyMatrix : public Graph
+// Bidirectional view of the indices of the bits set in an array of 64-bit words.
+// Iterating skips the words without bits set, and finds the next bit set within
+// a word with a single instruction (countr_zero / countl_zero).
+class SetBitsView : public std::ranges::view_interface<SetBitsView>
 {
 public:
-    GraphAdjecencyMatrix(int vertexCount, bool isDirected = true)
-        : Graph(isDirected)
-        , m_matrix(vertexCount)
+    class Iterator
     {
-        std::ranges::for_each(m_matrix,
-            [vertexCount](std::vector<float>& vertexEdges)
-            {
-                vertexEdges.resize(vertexCount, 0.0f);
-            });
-    }
+    public:
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::bidirectional_iterator_tag;
+
+        Iterator() = default;
+        Iterator(const std::uint64_t* words, int bitCount, int bit)
+            : m_words(words)
+            , m_bitCount(bitCount)
+            , m_bit(bit)
+        {
+        }
 
-    std::vector<Edge> GetEdges(int v) const override
-    {
-        if (v >= m_matrix.size())
+        int operator*() const
         {
-            return {};
+            return m_bit;
         }
 
-        std::vector<Edge> edges;
-        edges.reserve(m_matrix[v].size());
+        // Finds the next bit set, or the end when there are no more.
+        Iterator& operator++()
+        {
+            const int wordCount = (m_bitCount + 63) / 64;
+            const int nextBit = m_bit + 1;
+
+            int w = nextBit / 64;
+            if (w >= wordCount)
+            {
+                m_bit = m_bitCount;
+                return *this;
+            }
+
+            // Removing the bits already visited from the first word.
+            std::uint64_t word = m_words[w] & (~std::uint64_t{ 0 } << (nextBit % 64));
+            while (word == 0 && ++w < wordCount)
+            {
+                word = m_words[w];
+            }
 
-        for (int v2 = 0; v2 < m_matrix[v].size(); ++v2)
+            m_bit = (word != 0) ? w * 64 + std::countr_zero(word) : m_bitCount;
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        // Finds the previous bit set. Decrementing the first bit set is undefined, like any other iterator.
+        Iterator& operator--()
         {
-            if (m_matrix[v][v2] != 0.0f)
+            const int previousBit = m_bit - 1;
+
+            int w = previousBit / 64;
+
+            // Removing the bits after the previous bit from the first word.
+            std::uint64_t word = m_words[w] & (~std::uint64_t{ 0 } >> (63 - previousBit % 64));
+            while (word == 0 && w > 0)
             {
-                edges.emplace_back(v, v2, m_matrix[v][v2]);
+                word = m_words[--w];
             }
+
+            m_bit = w * 64 + 63 - std::countl_zero(word);
+            return *this;
+        }
+
+        Iterator operator--(int)
+        {
+            Iterator it = *this;
+            --(*this);
+            return it;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return m_bit == other.m_bit;
+        }
+
+    private:
+        const std::uint64_t* m_words = nullptr;
+        int m_bitCount = 0;
+        int m_bit = 0;
+    };
+
+    SetBitsView() = default;
+
+    // Bits after bitCount in the last word must be 0.
+    SetBitsView(std::span<const std::uint64_t> words, int bitCount)
+        : m_words(words.data())
+        , m_bitCount(bitCount)
+    {
+    }
+
+    Iterator begin() const
+    {
+        return ++Iterator(m_words, m_bitCount, -1);
+    }
+
+    Iterator end() const
+    {
+        return Iterator(m_words, m_bitCount, m_bitCount);
+    }
+
+private:
+    const std::uint64_t* m_words = nullptr;
+    int m_bitCount = 0;
+};
+
+class GraphAdjecencyMatrix : public Graph
+{
+public:
+    GraphAdjecencyMatrix(int vertexCount, bool isDirected = true, bool isWeighted = true,
+        std::pmr::memory_resource* arena = nullptr)
+        : Graph(isDirected)
+        , m_vertexCount(vertexCount)
+        , m_wordsPerRow((vertexCount + 63) / 64)
+        , m_isWeighted(isWeighted)
+        , m_bits(static_cast<std::size_t>(vertexCount) * m_wordsPerRow, 0, ArenaOrDefault(arena))
+        , m_weights(ArenaOrDefault(arena))
+    {
+        if (m_isWeighted)
+        {
+            m_weights.resize(static_cast<std::size_t>(vertexCount) * vertexCount, 0.0f);
         }
+    }
+
+    // View of the edges of the vertex. No allocations, but it still
+    // has to search its entire row of vertices, 64 vertices at a time. O(v)
+    auto Edges(int v) const
+    {
+        const SetBitsView row = (v >= 0 && v < m_vertexCount)
+            ? SetBitsView(GetRowBits(v), m_vertexCount)
+            : SetBitsView();
+
+        return row
+            | std::views::transform([this, v](int v2)
+                {
+                    return Edge{ v, v2, GetWeight(v, v2) };
+                });
+    }
 
-        edges.shrink_to_fit();
+    std::vector<Edge> GetEdges(int v) const override
+    {
+        // Counting first so there is only one allocation.
+        std::vector<Edge> edges;
+        edges.reserve(GetDegree(v));
+        std::ranges::copy(Edges(v), std::back_inserter(edges));
         return edges;
     }
 
     float GetEdge(int v1, int v2) const override
     {
-        if (v1 >= m_matrix.size() ||
-            v2 >= m_matrix.size())
+        if (v1 < 0 || v1 >= m_vertexCount ||
+            v2 < 0 || v2 >= m_vertexCount)
         {
             return 0.0f;
         }
 
-        return m_matrix[v1][v2];
+        return IsConnected(v1, v2) ? GetWeight(v1, v2) : 0.0f;
     }
 
     void SetEdge(int v1, int v2, float weight) override
@@ -237,47 +609,124 @@ public:
             return;
         }
 
-        if (v1 >= m_matrix.size() ||
-            v2 >= m_matrix.size())
+        if (v1 < 0 || v1 >= m_vertexCount ||
+            v2 < 0 || v2 >= m_vertexCount)
         {
             return;
         }
 
-        m_matrix[v1][v2] = weight;
+        SetCell(v1, v2, weight);
         if (!m_isDirected)
         {
-            m_matrix[v2][v1] = weight;
+            SetCell(v2, v1, weight);
+        }
+    }
+
+    void SetEdges(std::span<const Edge> edges) override
+    {
+        // Matrix has no memory to reserve, but it sets the cells directly without virtual calls.
+        for (const Edge& edge : edges)
+        {
+            if (edge.m_weight == 0.0f ||
+                edge.m_vertex1 < 0 || edge.m_vertex1 >= m_vertexCount ||
+                edge.m_vertex2 < 0 || edge.m_vertex2 >= m_vertexCount)
+            {
+                continue;
+            }
+
+            SetCell(edge.m_vertex1, edge.m_vertex2, edge.m_weight);
+            if (!m_isDirected)
+            {
+                SetCell(edge.m_vertex2, edge.m_vertex1, edge.m_weight);
+            }
         }
     }
 
     void Print() const override
     {
         std::printf("    ");
-        for (int i = 0; i < m_matrix.size(); ++i)
+        for (int i = 0; i < m_vertexCount; ++i)
         {
             std::printf("%d   ", i);
         }
         std::printf("\n");
         std::printf("    ");
-        for (int i = 0; i < m_matrix.size(); ++i)
+        for (int i = 0; i < m_vertexCount; ++i)
         {
             std::printf("----");
         }
         std::printf("\n");
-        for (int i = 0; i < m_matrix.size(); ++i)
+        for (int i = 0; i < m_vertexCount; ++i)
         {
             std::printf("%d | ", i);
-            for (int j = 0; j < m_matrix[i].size(); ++j)
+            for (int j = 0; j < m_vertexCount; ++j)
             {
-                std::printf("%.1f ", m_matrix[i][j]);
+                std::printf("%.1f ", GetEdge(i, j));
             }
             std::printf("\n");
         }
         std::printf("\n");
     }
 
+    int GetVertexCount() const override
+    {
+        return m_vertexCount;
+    }
+
+    bool IsWeighted() const
+    {
+        return m_isWeighted;
+    }
+
+    // Number of edges of the vertex, counting the bits of its row. O(v / 64)
+    int GetDegree(int v) const
+    {
+        if (v < 0 || v >= m_vertexCount)
+        {
+            return 0;
+        }
+
+        int degree = 0;
+        for (std::uint64_t word : GetRowBits(v))
+        {
+            degree += std::popcount(word);
+        }
+        return degree;
+    }
+
+    // Bits of the row of the vertex, bit v2 is set when there is an edge to v2.
+    std::span<const std::uint64_t> GetRowBits(int v) const
+    {
+        return std::span<const std::uint64_t>(m_bits).subspan(static_cast<std::size_t>(v) * m_wordsPerRow, m_wordsPerRow);
+    }
+
 private:
-    AdjecencyMatrix m_matrix;
+    bool IsConnected(int v1, int v2) const
+    {
+        return m_bits[static_cast<std::size_t>(v1) * m_wordsPerRow + v2 / 64] & (std::uint64_t{ 1 } << (v2 % 64));
+    }
+
+    float GetWeight(int v1, int v2) const
+    {
+        return m_isWeighted
+            ? m_weights[static_cast<std::size_t>(v1) * m_vertexCount + v2]
+            : 1.0f;
+    }
+
+    void SetCell(int v1, int v2, float weight)
+    {
+        m_bits[static_cast<std::size_t>(v1) * m_wordsPerRow + v2 / 64] |= std::uint64_t{ 1 } << (v2 % 64);
+        if (m_isWeighted)
+        {
+            m_weights[static_cast<std::size_t>(v1) * m_vertexCount + v2] = weight;
+        }
+    }
+
+    int m_vertexCount = 0;
+    int m_wordsPerRow = 0;
+    bool m_isWeighted = true;
+    std::pmr::vector<std::uint64_t> m_bits; // Size: vertices x words per row
+    std::pmr::vector<float> m_weights;      // Size: vertices x vertices. Empty when unweighted.
 };
 
 void GraphsAsAdjacencyMatrix()
@@ -295,6 +744,18 @@ void GraphsAsAdjacencyMatrix()
     graph.SetEdge(4, 5, 4.0f);
 
     graph.Print();
+
+    // Unweighted graph only uses 1 bit per cell
+    GraphAdjecencyMatrix unweightedGraph(graphVertexCount, true, false);
+    unweightedGraph.SetEdge(0, 1, 1.0f);
+    unweightedGraph.SetEdge(1, 3, 1.0f);
+    unweightedGraph.SetEdge(2, 0, 1.0f);
+    unweightedGraph.SetEdge(2, 1, 1.0f);
+    unweightedGraph.SetEdge(2, 4, 1.0f);
+
+    unweightedGraph.Print();
+
+    std::printf("Degree of vertex 2: %d\n\n", unweightedGraph.GetDegree(2));
 }
 
 // ---------------------------------------------
@@ -310,20 +771,28 @@ void GraphsAsAdjacencyMatrix()
 
 // The list of edges can be represented using different
 // data structures: vector, list, balanced binary search tree, hash table.
-using AdjecencyList = std::vector<Edge>;
-
-class GraphAdjecencyList : public Graph
+// Edges(v) needs them contiguous in memory, like vector or SmallVector.
+// SmallAdjecencyList keeps up to 4 edges inside the vertex, so vertices
+// with a low degree never allocate their list.
+// Both are pmr containers, so the lists are allocated from the arena of the graph.
+using AdjecencyList = std::pmr::vector<Edge>;
+using SmallAdjecencyList = pmr::SmallVector<Edge, 4>;
+
+template<typename AdjecencyListType = AdjecencyList>
+class BasicGraphAdjecencyList : public Graph
 {
 public:
-    GraphAdjecencyList(int vertexCount, bool isDirected = true)
+    // The arena is given to the list of each vertex too.
+    BasicGraphAdjecencyList(int vertexCount, bool isDirected = true, std::pmr::memory_resource* arena = nullptr)
         : Graph(isDirected)
-        , m_vertices(vertexCount)
+        , m_vertices(vertexCount, ArenaOrDefault(arena))
     {
     }
 
-    std::vector<Edge> GetEdges(int v) const override
+    // View of the edges of the vertex. No allocations. O(1)
+    std::span<const Edge> Edges(int v) const
     {
-        if (v >= m_vertices.size())
+        if (v < 0 || v >= m_vertices.size())
         {
             return {};
         }
@@ -331,6 +800,12 @@ public:
         return m_vertices[v];
     }
 
+    std::vector<Edge> GetEdges(int v) const override
+    {
+        const auto vertexEdges = Edges(v);
+        return { vertexEdges.begin(), vertexEdges.end() };
+    }
+
     float GetEdge(int v1, int v2) const override
     {
         if (v1 >= m_vertices.size() ||
@@ -371,6 +846,54 @@ public:
         }
     }
 
+    void SetEdges(std::span<const Edge> edges) override
+    {
+        const int vertexCount = GetVertexCount();
+
+        auto isValid = [vertexCount](const Edge& edge)
+        {
+            return edge.m_weight != 0.0f &&
+                edge.m_vertex1 >= 0 && edge.m_vertex1 < vertexCount &&
+                edge.m_vertex2 >= 0 && edge.m_vertex2 < vertexCount;
+        };
+
+        // First pass counts the new edges of each vertex (mirrored ones too)
+        // to reserve the exact memory, so each list grows only once...
+        std::vector<int> newEdgeCounts(vertexCount, 0);
+        for (const Edge& edge : edges)
+        {
+            if (isValid(edge))
+            {
+                ++newEdgeCounts[edge.m_vertex1];
+                if (!m_isDirected)
+                {
+                    ++newEdgeCounts[edge.m_vertex2];
+                }
+            }
+        }
+
+        for (int v = 0; v < vertexCount; ++v)
+        {
+            if (newEdgeCounts[v] > 0)
+            {
+                m_vertices[v].reserve(m_vertices[v].size() + newEdgeCounts[v]);
+            }
+        }
+
+        // ...and second pass adds them, with their mirrored edges when undirected.
+        for (const Edge& edge : edges)
+        {
+            if (isValid(edge))
+            {
+                m_vertices[edge.m_vertex1].push_back(edge);
+                if (!m_isDirected)
+                {
+                    m_vertices[edge.m_vertex2].emplace_back(edge.m_vertex2, edge.m_vertex1, edge.m_weight);
+                }
+            }
+        }
+    }
+
     void Print() const override
     {
         for (int v = 0; v < m_vertices.size(); ++v)
@@ -385,10 +908,23 @@ public:
         std::printf("\n");
     }
 
+    int GetVertexCount() const override
+    {
+        return static_cast<int>(m_vertices.size());
+    }
+
+    const AdjecencyListType& GetAdjecencyList(int v) const
+    {
+        return m_vertices[v];
+    }
+
 private:
-    std::vector<AdjecencyList> m_vertices;
+    std::pmr::vector<AdjecencyListType> m_vertices;
 };
 
+using GraphAdjecencyList = BasicGraphAdjecencyList<>;
+using SmallGraphAdjecencyList = BasicGraphAdjecencyList<SmallAdjecencyList>;
+
 void GraphsAsAdjacencyList()
 {
     const int graphVertexCount = 6;
@@ -404,106 +940,1501 @@ void GraphsAsAdjacencyList()
     graph.SetEdge(4, 5, 4.0f);
 
     graph.Print();
+
+    // Adding all the edges at once
+    const Edge edges[] = {
+        { 0, 1, 7.0f }, { 1, 3, 5.0f }, { 2, 0, 2.0f },
+        { 2, 1, 1.0f }, { 2, 4, 6.0f }, { 3, 5, 7.0f },
+        { 4, 1, 3.0f }, { 4, 3, 9.0f }, { 4, 5, 4.0f } };
+
+    GraphAdjecencyList undirectedGraph(graphVertexCount, false);
+    undirectedGraph.SetEdges(edges);
+
+    undirectedGraph.Print();
+
+    // Same graph with the edges inside the vertices, no vertex has more than 4 edges
+    SmallGraphAdjecencyList smallUndirectedGraph(graphVertexCount, false);
+    smallUndirectedGraph.SetEdges(edges);
+
+    smallUndirectedGraph.Print();
+}
+
+// ---------------------------------------------
+// Graph Representation: Compressed Sparse Row (CSR)
+// 
+// Immutable representation built once from another graph. It keeps all the edges
+// sorted by source vertex in three flat arrays:
+// - Offsets: the edges of vertex v are in the range [offsets[v], offsets[v + 1]).
+// - Neighbors: destination vertex of each edge.
+// - Weights: weight of each edge.
+// 
+// + To get the list of edges of a vertex is O(1) and they are contiguous in memory,
+//   which is very good for cache when traversing the graph.
+// + Only 3 allocations no matter the number of vertices, and each edge only stores
+//   its destination vertex and its weight.
+// + To check if a vertex is connected to another is O(d).
+// - It cannot be modified once built, a new one has to be built instead.
+// - When graph is undirected it stores the edges twice.
+//
+// Saved to a binary file the three arrays are written as they are in memory, so loading
+// the graph is mapping the file (see MemoryMappedFile.h) and pointing the arrays to it,
+// without reading nor parsing it. File layout, all the arrays aligned to 64 bytes:
+// - Header (CSRFileHeader): magic, version, byte order, element sizes, counts, positions.
+// - Offsets: (vertices + 1) x int32.
+// - Neighbors: edges x int32.
+// - Weights: edges x float32.
+// The pages of the file are loaded on demand, and shared by all the processes mapping it.
+// ---------------------------------------------
+
+struct CSRFileHeader
+{
+    static constexpr char Magic[8] = { 'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H' };
+    static constexpr std::uint32_t CurrentVersion = 1;
+    static constexpr std::uint32_t ByteOrderMark = 0x01020304; // Reads differently with another byte order
+    static constexpr std::uint64_t ArrayAlignment = 64;
+
+    char m_magic[8] = {};
+    std::uint32_t m_version = 0;
+    std::uint32_t m_byteOrderMark = 0;
+    std::uint32_t m_indexSize = 0;  // sizeof(int) of offsets and neighbors
+    std::uint32_t m_weightSize = 0; // sizeof(float) of weights
+    std::uint32_t m_isDirected = 0;
+    std::uint32_t m_padding = 0;
+    std::uint64_t m_vertexCount = 0;
+    std::uint64_t m_edgeCount = 0;
+    std::uint64_t m_offsetsPosition = 0; // Bytes from the start of the file
+    std::uint64_t m_neighborsPosition = 0;
+    std::uint64_t m_weightsPosition = 0;
+};
+static_assert(std::is_trivially_copyable_v<CSRFileHeader> && sizeof(CSRFileHeader) == 72);
+
+class GraphCSR : public Graph
+{
+public:
+    // Structure of arrays with the edges of a vertex.
+    // Both spans have the same size and point directly to the graph's arrays.
+    struct Neighbors
+    {
+        std::span<const int> m_vertices;
+        std::span<const float> m_weights;
+
+        std::size_t size() const
+        {
+            return m_vertices.size();
+        }
+    };
+
+    explicit GraphCSR(const GraphEdgeList& graph, std::pmr::memory_resource* arena = nullptr)
+        : GraphCSR(graph.GetVertexCount(), graph.GetEdgeList(), graph.IsDirected(), arena)
+    {
+    }
+
+    // Builds the graph directly from a batch of edges, in O(v + e) with exact allocations.
+    // Edges with weight 0 or vertices out of range are ignored, as in SetEdge of other representations.
+    GraphCSR(int vertexCount, std::span<const Edge> edges, bool isDirected = true, std::pmr::memory_resource* arena = nullptr)
+        : GraphCSR(isDirected, arena)
+    {
+        auto isValid = [vertexCount](const Edge& edge)
+        {
+            return edge.m_weight != 0.0f &&
+                edge.m_vertex1 >= 0 && edge.m_vertex1 < vertexCount &&
+                edge.m_vertex2 >= 0 && edge.m_vertex2 < vertexCount;
+        };
+
+        // Counting sort of the edges by source vertex.
+        // First pass counts the edges of each vertex, storing them shifted by one...
+        m_offsetStorage.resize(vertexCount + 1, 0);
+        for (const auto& edge : edges | std::views::filter(isValid))
+        {
+            ++m_offsetStorage[edge.m_vertex1 + 1];
+            if (!m_isDirected)
+            {
+                ++m_offsetStorage[edge.m_vertex2 + 1];
+            }
+        }
+
+        // ...so an inclusive scan gives where the edges of each vertex start.
+        std::inclusive_scan(m_offsetStorage.begin(), m_offsetStorage.end(), m_offsetStorage.begin());
+
+        m_neighborStorage.resize(m_offsetStorage.back());
+        m_weightStorage.resize(m_offsetStorage.back());
+
+        // Second pass places the edges, keeping the order in which they were added.
+        std::vector<int> insertPositions(m_offsetStorage.begin(), m_offsetStorage.end() - 1);
+        for (const auto& edge : edges | std::views::filter(isValid))
+        {
+            const int e = insertPositions[edge.m_vertex1]++;
+            m_neighborStorage[e] = edge.m_vertex2;
+            m_weightStorage[e] = edge.m_weight;
+
+            if (!m_isDirected)
+            {
+                const int mirrorE = insertPositions[edge.m_vertex2]++;
+                m_neighborStorage[mirrorE] = edge.m_vertex1;
+                m_weightStorage[mirrorE] = edge.m_weight;
+            }
+        }
+
+        UseStorage();
+    }
+
+    template<typename AdjecencyListType>
+    explicit GraphCSR(const BasicGraphAdjecencyList<AdjecencyListType>& graph, std::pmr::memory_resource* arena = nullptr)
+        : GraphCSR(graph.IsDirected(), arena)
+    {
+        const int vertexCount = graph.GetVertexCount();
+
+        // Adjacency list already stores the edges of each vertex together
+        // (twice when undirected), so it's only necessary to flatten them.
+        m_offsetStorage.resize(vertexCount + 1, 0);
+        for (int v = 0; v < vertexCount; ++v)
+        {
+            m_offsetStorage[v + 1] = m_offsetStorage[v] + static_cast<int>(graph.GetAdjecencyList(v).size());
+        }
+
+        m_neighborStorage.reserve(m_offsetStorage.back());
+        m_weightStorage.reserve(m_offsetStorage.back());
+        for (int v = 0; v < vertexCount; ++v)
+        {
+            for (const auto& edge : graph.GetAdjecencyList(v))
+            {
+                m_neighborStorage.push_back(edge.m_vertex2);
+                m_weightStorage.push_back(edge.m_weight);
+            }
+        }
+
+        UseStorage();
+    }
+
+    // Copies of a loaded graph share its mapped file.
+    GraphCSR(const GraphCSR& other)
+        : Graph(other)
+        , m_offsetStorage(other.m_offsetStorage)
+        , m_neighborStorage(other.m_neighborStorage)
+        , m_weightStorage(other.m_weightStorage)
+        , m_file(other.m_file)
+    {
+        UseStorageOrFile(other);
+    }
+
+    GraphCSR(GraphCSR&& other) noexcept
+        : Graph(other)
+        , m_offsetStorage(std::move(other.m_offsetStorage))
+        , m_neighborStorage(std::move(other.m_neighborStorage))
+        , m_weightStorage(std::move(other.m_weightStorage))
+        , m_file(std::move(other.m_file))
+    {
+        UseStorageOrFile(other);
+        other.UseStorage();
+    }
+
+    GraphCSR& operator=(const GraphCSR& other)
+    {
+        if (this != &other)
+        {
+            *this = GraphCSR(other);
+        }
+        return *this;
+    }
+
+    GraphCSR& operator=(GraphCSR&& other) noexcept
+    {
+        if (this != &other)
+        {
+            m_isDirected = other.m_isDirected;
+            m_offsetStorage = std::move(other.m_offsetStorage);
+            m_neighborStorage = std::move(other.m_neighborStorage);
+            m_weightStorage = std::move(other.m_weightStorage);
+            m_file = std::move(other.m_file);
+            UseStorageOrFile(other);
+            other.UseStorage();
+        }
+        return *this;
+    }
+
+    // Writes the header and the arrays in one sequential pass.
+    bool Save(const std::filesystem::path& path) const
+    {
+        INSTRUMENT_ZONE("GraphCSR::Save");
+
+        CSRFileHeader header;
+        std::copy(std::begin(CSRFileHeader::Magic), std::end(CSRFileHeader::Magic), header.m_magic);
+        header.m_version = CSRFileHeader::CurrentVersion;
+        header.m_byteOrderMark = CSRFileHeader::ByteOrderMark;
+        header.m_indexSize = sizeof(int);
+        header.m_weightSize = sizeof(float);
+        header.m_isDirected = m_isDirected ? 1 : 0;
+        header.m_vertexCount = GetVertexCount();
+        header.m_edgeCount = GetEdgeCount();
+        header.m_offsetsPosition = AlignFilePosition(sizeof(CSRFileHeader));
+        header.m_neighborsPosition = AlignFilePosition(header.m_offsetsPosition + m_offsets.size_bytes());
+        header.m_weightsPosition = AlignFilePosition(header.m_neighborsPosition + m_neighbors.size_bytes());
+
+        std::ofstream outFile(path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+        if (!outFile.is_open())
+        {
+            return false;
+        }
+
+        // Padding up to the position of the next array.
+        auto write = [&outFile](std::uint64_t position, const void* data, std::size_t size)
+        {
+            static constexpr char zeros[CSRFileHeader::ArrayAlignment] = {};
+            const std::uint64_t padding = position - static_cast<std::uint64_t>(outFile.tellp());
+            outFile.write(zeros, static_cast<std::streamsize>(padding));
+            outFile.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        };
+
+        write(0, &header, sizeof(header));
+        write(header.m_offsetsPosition, m_offsets.data(), m_offsets.size_bytes());
+        write(header.m_neighborsPosition, m_neighbors.data(), m_neighbors.size_bytes());
+        write(header.m_weightsPosition, m_weights.data(), m_weights.size_bytes());
+
+        outFile.close();
+        return !outFile.fail();
+    }
+
+    // Maps the file and uses its arrays directly. No parsing, it only validates the header,
+    // that the arrays are in the file and the offsets, in O(v). Returns nothing if the file
+    // can't be mapped or it isn't a valid graph file of this version and platform.
+    // The neighbors are not validated (that would be O(e)), so the file must be trusted.
+    static std::optional<GraphCSR> Load(const std::filesystem::path& path)
+    {
+        INSTRUMENT_ZONE("GraphCSR::Load");
+
+        auto file = std::make_shared<MemoryMappedFile>(path, MemoryMappedFile::AccessHint::Random);
+        const std::span<const std::byte> bytes = file->GetBytes();
+        if (!file->IsOpen() || bytes.size() < sizeof(CSRFileHeader))
+        {
+            return std::nullopt;
+        }
+
+        CSRFileHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        auto isArrayInFile = [&bytes](std::uint64_t position, std::uint64_t count, std::uint64_t elementSize)
+        {
+            return position % CSRFileHeader::ArrayAlignment == 0 &&
+                position <= bytes.size() &&
+                count <= (bytes.size() - position) / elementSize;
+        };
+
+        if (!std::equal(std::begin(CSRFileHeader::Magic), std::end(CSRFileHeader::Magic), header.m_magic) ||
+            header.m_version != CSRFileHeader::CurrentVersion ||
+            header.m_byteOrderMark != CSRFileHeader::ByteOrderMark ||
+            header.m_indexSize != sizeof(int) ||
+            header.m_weightSize != sizeof(float) ||
+            header.m_vertexCount >= static_cast<std::uint64_t>(std::numeric_limits<int>::max()) ||
+            header.m_edgeCount > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) ||
+            !isArrayInFile(header.m_offsetsPosition, header.m_vertexCount + 1, sizeof(int)) ||
+            !isArrayInFile(header.m_neighborsPosition, header.m_edgeCount, sizeof(int)) ||
+            !isArrayInFile(header.m_weightsPosition, header.m_edgeCount, sizeof(float)))
+        {
+            return std::nullopt;
+        }
+
+        GraphCSR graph(header.m_isDirected != 0, nullptr);
+        graph.m_offsets = { reinterpret_cast<const int*>(bytes.data() + header.m_offsetsPosition), header.m_vertexCount + 1 };
+        graph.m_neighbors = { reinterpret_cast<const int*>(bytes.data() + header.m_neighborsPosition), header.m_edgeCount };
+        graph.m_weights = { reinterpret_cast<const float*>(bytes.data() + header.m_weightsPosition), header.m_edgeCount };
+        graph.m_file = std::move(file);
+
+        // Offsets starting at 0, never decreasing and ending at the edge count keep
+        // the subspans of GetNeighbors in the arrays. Reads the offsets pages, not the edges.
+        if (graph.m_offsets.front() != 0 || graph.m_offsets.back() != static_cast<int>(header.m_edgeCount) ||
+            !std::ranges::is_sorted(graph.m_offsets))
+        {
+            return std::nullopt;
+        }
+        return graph;
+    }
+
+    // True when the arrays are in a mapped file.
+    bool IsMapped() const
+    {
+        return m_file != nullptr;
+    }
+
+    // View of the edges of the vertex. No allocations. O(1)
+    // Use GetNeighbors instead to access the arrays directly.
+    auto Edges(int v) const
+    {
+        const Neighbors neighbors = GetNeighbors(v);
+
+        return std::views::iota(0, static_cast<int>(neighbors.size()))
+            | std::views::transform([v, neighbors](int i)
+                {
+                    return Edge{ v, neighbors.m_vertices[i], neighbors.m_weights[i] };
+                });
+    }
+
+    std::vector<Edge> GetEdges(int v) const override
+    {
+        const auto vertexEdges = Edges(v);
+        return { vertexEdges.begin(), vertexEdges.end() };
+    }
+
+    float GetEdge(int v1, int v2) const override
+    {
+        const Neighbors neighbors = GetNeighbors(v1);
+
+        auto it = std::ranges::find(neighbors.m_vertices, v2);
+
+        return (it != neighbors.m_vertices.end())
+            ? neighbors.m_weights[it - neighbors.m_vertices.begin()]
+            : 0.0f;
+    }
+
+    void SetEdge([[maybe_unused]] int v1, [[maybe_unused]] int v2, [[maybe_unused]] float weight) override
+    {
+        // Immutable graph, edges are only set when building it.
+    }
+
+    void SetEdges([[maybe_unused]] std::span<const Edge> edges) override
+    {
+        // Immutable graph, use the constructor to build it from a batch of edges.
+    }
+
+    void Print() const override
+    {
+        for (int v = 0; v < GetVertexCount(); ++v)
+        {
+            const Neighbors neighbors = GetNeighbors(v);
+
+            std::printf("%d: ", v);
+            for (std::size_t i = 0; i < neighbors.size(); ++i)
+            {
+                std::printf("(%d, %0.1f) ", neighbors.m_vertices[i], neighbors.m_weights[i]);
+            }
+            std::printf("\n");
+        }
+        std::printf("\n");
+    }
+
+    // Edges of the vertex without copying them. O(1)
+    Neighbors GetNeighbors(int v) const
+    {
+        if (v < 0 || v >= GetVertexCount())
+        {
+            return {};
+        }
+
+        const std::size_t first = m_offsets[v];
+        const std::size_t count = m_offsets[v + 1] - m_offsets[v];
+
+        return {
+            std::span<const int>(m_neighbors).subspan(first, count),
+            std::span<const float>(m_weights).subspan(first, count) };
+    }
+
+    int GetVertexCount() const override
+    {
+        return m_offsets.empty() ? 0 : static_cast<int>(m_offsets.size()) - 1;
+    }
+
+    int GetEdgeCount() const
+    {
+        return static_cast<int>(m_neighbors.size());
+    }
+
+    // Graph with all the edges reversed, so the edges of each vertex are its incoming edges. O(v + e)
+    // Undirected graphs are the same as their transposed graph. It uses the arena of this graph.
+    GraphCSR Transposed() const
+    {
+        GraphCSR transposed(m_isDirected, m_offsetStorage.get_allocator().resource());
+
+        const int vertexCount = GetVertexCount();
+
+        // Same counting sort as when building from an edge list, but by destination vertex.
+        transposed.m_offsetStorage.resize(vertexCount + 1, 0);
+        for (int v2 : m_neighbors)
+        {
+            ++transposed.m_offsetStorage[v2 + 1];
+        }
+
+        std::inclusive_scan(transposed.m_offsetStorage.begin(), transposed.m_offsetStorage.end(), transposed.m_offsetStorage.begin());
+
+        transposed.m_neighborStorage.resize(m_neighbors.size());
+        transposed.m_weightStorage.resize(m_weights.size());
+
+        std::vector<int> insertPositions(transposed.m_offsetStorage.begin(), transposed.m_offsetStorage.end() - 1);
+        for (int v = 0; v < vertexCount; ++v)
+        {
+            for (int e = m_offsets[v]; e < m_offsets[v + 1]; ++e)
+            {
+                const int transposedE = insertPositions[m_neighbors[e]]++;
+                transposed.m_neighborStorage[transposedE] = v;
+                transposed.m_weightStorage[transposedE] = m_weights[e];
+            }
+        }
+
+        transposed.UseStorage();
+        return transposed;
+    }
+
+private:
+    GraphCSR(bool isDirected, std::pmr::memory_resource* arena)
+        : Graph(isDirected)
+        , m_offsetStorage(ArenaOrDefault(arena))
+        , m_neighborStorage(ArenaOrDefault(arena))
+        , m_weightStorage(ArenaOrDefault(arena))
+    {
+    }
+
+    static std::uint64_t AlignFilePosition(std::uint64_t position)
+    {
+        return (position + CSRFileHeader::ArrayAlignment - 1) / CSRFileHeader::ArrayAlignment * CSRFileHeader::ArrayAlignment;
+    }
+
+    // Points the arrays to the storage, after building it.
+    void UseStorage()
+    {
+        m_offsets = m_offsetStorage;
+        m_neighbors = m_neighborStorage;
+        m_weights = m_weightStorage;
+    }
+
+    // After copying or moving the storage or the file of the other graph.
+    void UseStorageOrFile(const GraphCSR& other)
+    {
+        if (m_file)
+        {
+            m_offsets = other.m_offsets;
+            m_neighbors = other.m_neighbors;
+            m_weights = other.m_weights;
+        }
+        else
+        {
+            UseStorage();
+        }
+    }
+
+    // The arrays point to the storage when the graph is built, or to the file when it's loaded.
+    std::span<const int> m_offsets;   // Size: vertices + 1
+    std::span<const int> m_neighbors; // Size: edges
+    std::span<const float> m_weights; // Size: edges
+
+    std::pmr::vector<int> m_offsetStorage;
+    std::pmr::vector<int> m_neighborStorage;
+    std::pmr::vector<float> m_weightStorage;
+    std::shared_ptr<const MemoryMappedFile> m_file; // Shared by the copies of a loaded graph
+};
+
+void GraphsAsCSR()
+{
+    GraphEdgeList graphEdgeList;
+    graphEdgeList.SetEdge(0, 1, 7.0f);
+    graphEdgeList.SetEdge(1, 3, 5.0f);
+    graphEdgeList.SetEdge(2, 0, 2.0f);
+    graphEdgeList.SetEdge(2, 1, 1.0f);
+    graphEdgeList.SetEdge(2, 4, 6.0f);
+    graphEdgeList.SetEdge(3, 5, 7.0f);
+    graphEdgeList.SetEdge(4, 1, 3.0f);
+    graphEdgeList.SetEdge(4, 3, 9.0f);
+    graphEdgeList.SetEdge(4, 5, 4.0f);
+
+    // Built once from another graph representation
+    GraphCSR graph(graphEdgeList);
+
+    graph.Print();
+
+    // Iterating the neighbors of a vertex without allocations
+    const GraphCSR::Neighbors neighbors = graph.GetNeighbors(4);
+    std::printf("Neighbors of vertex 4: ");
+    for (std::size_t i = 0; i < neighbors.size(); ++i)
+    {
+        std::printf("(%d, %0.1f) ", neighbors.m_vertices[i], neighbors.m_weights[i]);
+    }
+    std::printf("\n\n");
+
+    // Built directly from a batch of edges
+    const Edge edges[] = {
+        { 0, 1, 7.0f }, { 1, 3, 5.0f }, { 2, 0, 2.0f },
+        { 2, 1, 1.0f }, { 2, 4, 6.0f }, { 3, 5, 7.0f },
+        { 4, 1, 3.0f }, { 4, 3, 9.0f }, { 4, 5, 4.0f } };
+
+    const GraphCSR undirectedGraph(6, edges, false);
+
+    undirectedGraph.Print();
+
+    // All the memory of the graphs from an arena, freed at once with the arena
+    {
+        BumpResource arena;
+
+        GraphAdjecencyList arenaGraph(6, false, &arena);
+        arenaGraph.SetEdges(edges);
+        const GraphCSR arenaGraphCSR(arenaGraph, &arena);
+
+        const AllocationStats& stats = arena.GetStats();
+        std::printf("Arena graphs: %d edges in CSR, %zu allocations, %zu bytes\n\n",
+            arenaGraphCSR.GetEdgeCount(), stats.m_allocationCount, stats.m_allocatedBytes);
+    }
+
+    // Saved to a binary file and loaded back mapping the file, the arrays are read from it
+    {
+        const std::filesystem::path filePath = std::filesystem::temp_directory_path() / "GraphsAsCSR.csr";
+
+        if (undirectedGraph.Save(filePath))
+        {
+            if (const std::optional<GraphCSR> loadedGraph = GraphCSR::Load(filePath))
+            {
+                std::printf("Loaded graph (mapped %s):\n", loadedGraph->IsMapped() ? "yes" : "no");
+                loadedGraph->Print();
+            }
+        }
+
+        std::filesystem::remove(filePath);
+    }
+}
+
+// --------------------------------------------------------------------------------
+// Traversing a graph: Depth First and Breadth First
+// 
+// The traverse algorithms are the same as in Trees (see Trees.cpp), but it's required
+// to keep a vertex visited list to avoid cycles.
+// 
+// Applications of Depth First Search (DFS):
+// - Detecting cycles in a graph by tracking visited edges.
+// - Path finding from vertex A to B. use a stack to keep track of visited vertices,
+//   once B is found, return the content of the stack.
+// - Solving puzzles with only one solution, such as mazes.
+// 
+// Applications of Breadth First Search (BFS):
+// - Shortest path in unweighted graphs (path with the least number of edges).
+// - Find all neighbors. Peer-to-Peer networks, Social Networks, GPS System.
+// - Detecting cycles in undirected graph.
+// - Path finding, detect if there is a path between A and B.
+// - AI: find best move
+// - Find all connected components in an undirected graph.
+// - Image processing: Flood-fill an image with a particular color.
+// --------------------------------------------------------------------------------
+
+// Graphs able to give the edges of a vertex as a view (see Graph class).
+// The traverse functions use the views, so they don't allocate per visited vertex.
+template<typename GraphType>
+concept EdgesViewable = requires(const GraphType& graph, int v)
+{
+    { graph.Edges(v) } -> std::ranges::bidirectional_range;
+    { graph.GetVertexCount() } -> std::convertible_to<int>;
+};
+
+// Reusable data for the traverse functions, so traversing the same graph several
+// times doesn't allocate memory nor has to reset the visited state of every vertex.
+// 
+// Visited vertices are tracked with an epoch-stamped array: a vertex is visited when
+// its stamp is the current epoch. Starting a new traversal only increments the epoch,
+// which makes all the vertices not visited again in O(1). Checking and marking a vertex
+// as visited is O(1) too, instead of searching a list of visited vertices.
+class TraversalWorkspace
+{
+public:
+    TraversalWorkspace() = default;
+
+    // Prepares the workspace for a new traversal of a graph with this number of vertices.
+    void Begin(int vertexCount)
+    {
+        if (m_visitedEpochs.size() < vertexCount)
+        {
+            m_visitedEpochs.resize(vertexCount, 0);
+        }
+
+        // Stamps are only cleared when the epoch wraps around.
+        if (++m_epoch == 0)
+        {
+            std::ranges::fill(m_visitedEpochs, 0);
+            m_epoch = 1;
+        }
+
+        m_pending.clear(); // Keeps capacity
+    }
+
+    bool IsVisited(int v) const
+    {
+        return m_visitedEpochs[v] == m_epoch;
+    }
+
+    // Marks vertex as visited.
+    // Returns false if the vertex was already visited.
+    bool Visit(int v)
+    {
+        if (IsVisited(v))
+        {
+            return false;
+        }
+        m_visitedEpochs[v] = m_epoch;
+        return true;
+    }
+
+    // Vertices pending to be visited, used as stack or queue by the traverse functions.
+    std::vector<int>& GetPending()
+    {
+        return m_pending;
+    }
+
+private:
+    std::vector<std::uint32_t> m_visitedEpochs;
+    std::uint32_t m_epoch = 0;
+    std::vector<int> m_pending;
+};
+
+namespace
+{
+    template<EdgesViewable GraphType>
+    void VisitDepthFirst_Recursive(const GraphType* graph, int v, TraversalWorkspace& workspace)
+    {
+        std::printf("%d ", v);
+        workspace.Visit(v);
+
+        std::ranges::for_each(graph->Edges(v),
+            [graph, &workspace](const Edge& edge)
+            {
+                if (!workspace.IsVisited(edge.m_vertex2))
+                {
+                    VisitDepthFirst_Recursive(graph, edge.m_vertex2, workspace);
+                }
+            });
+    }
+}
+
+template<EdgesViewable GraphType>
+void TraverseDepthFirst_Recursive(const GraphType* graph, int v, TraversalWorkspace& workspace)
+{
+    INSTRUMENT_ZONE("TraverseDepthFirst_Recursive");
+
+    if (!graph || v < 0 || v >= graph->GetVertexCount())
+    {
+        return;
+    }
+
+    workspace.Begin(graph->GetVertexCount());
+
+    VisitDepthFirst_Recursive(graph, v, workspace);
+}
+
+template<EdgesViewable GraphType>
+void TraverseDepthFirst_NonRecursive(const GraphType* graph, int v, TraversalWorkspace& workspace)
+{
+    INSTRUMENT_ZONE("TraverseDepthFirst_NonRecursive");
+
+    if (!graph || v < 0 || v >= graph->GetVertexCount())
+    {
+        return;
+    }
+
+    workspace.Begin(graph->GetVertexCount());
+
+    std::vector<int>& stack = workspace.GetPending();
+
+    stack.push_back(v);
+    workspace.Visit(v);
+
+    while (!stack.empty())
+    {
+        int vertex = stack.back();
+        stack.pop_back();
+
+        std::printf("%d ", vertex);
+
+        // Notice the reverse order!
+        std::ranges::for_each(graph->Edges(vertex) | std::views::reverse,
+            [&stack, &workspace](const Edge& edge)
+            {
+                if (workspace.Visit(edge.m_vertex2))
+                {
+                    stack.push_back(edge.m_vertex2);
+                }
+            });
+    }
+}
+
+template<EdgesViewable GraphType>
+void TraverseBreathFirst_NonRecursive(const GraphType* graph, int v, TraversalWorkspace& workspace)
+{
+    INSTRUMENT_ZONE("TraverseBreathFirst_NonRecursive");
+
+    if (!graph || v < 0 || v >= graph->GetVertexCount())
+    {
+        return;
+    }
+
+    workspace.Begin(graph->GetVertexCount());
+
+    // Each vertex is only added once, so a vector with a read
+    // position works as a queue without removing elements.
+    std::vector<int>& queue = workspace.GetPending();
+    std::size_t queueFront = 0;
+
+    queue.push_back(v);
+    workspace.Visit(v);
+
+    while (queueFront < queue.size())
+    {
+        int vertex = queue[queueFront++];
+
+        std::printf("%d ", vertex);
+
+        std::ranges::for_each(graph->Edges(vertex),
+            [&queue, &workspace](const Edge& edge)
+            {
+                if (workspace.Visit(edge.m_vertex2))
+                {
+                    queue.push_back(edge.m_vertex2);
+                }
+            });
+    }
+}
+
+void GraphsTraverse()
+{
+    const int graphVertexCount = 6;
+    GraphAdjecencyList graph(graphVertexCount);
+    graph.SetEdge(0, 1, 7.0f);
+    graph.SetEdge(1, 3, 5.0f);
+    graph.SetEdge(2, 0, 2.0f);
+    graph.SetEdge(2, 1, 1.0f);
+    graph.SetEdge(2, 4, 6.0f);
+    graph.SetEdge(3, 5, 7.0f);
+    graph.SetEdge(4, 1, 3.0f);
+    graph.SetEdge(4, 3, 9.0f);
+    graph.SetEdge(4, 5, 4.0f);
+
+    // The same workspace is reused by all the traversals.
+    TraversalWorkspace workspace;
+
+    std::printf("TraverseDepthFirst_Recursive vertex 2: ");
+    TraverseDepthFirst_Recursive(&graph, 2, workspace);
+    std::printf("\n");
+
+    std::printf("TraverseDepthFirst_NonRecursive vertex 2: ");
+    TraverseDepthFirst_NonRecursive(&graph, 2, workspace);
+    std::printf("\n");
+
+    std::printf("TraverseBreathFirst_NonRecursive vertex 2: ");
+    TraverseBreathFirst_NonRecursive(&graph, 2, workspace);
+    std::printf("\n");
+
+    // Same traversals work with any graph representation.
+    const GraphCSR graphCSR(graph);
+
+    std::printf("CSR TraverseDepthFirst_Recursive vertex 2: ");
+    TraverseDepthFirst_Recursive(&graphCSR, 2, workspace);
+    std::printf("\n");
+
+    std::printf("CSR TraverseDepthFirst_NonRecursive vertex 2: ");
+    TraverseDepthFirst_NonRecursive(&graphCSR, 2, workspace);
+    std::printf("\n");
+
+    std::printf("CSR TraverseBreathFirst_NonRecursive vertex 2: ");
+    TraverseBreathFirst_NonRecursive(&graphCSR, 2, workspace);
+    std::printf("\n");
+}
+
+// --------------------------------------------------------------------------------
+// Parallel Breadth First Search
+// 
+// Level-synchronous BFS: all the vertices of the current level (the frontier) are
+// processed in parallel by the threads of a thread pool, finishing the whole level
+// before starting the next one. Visited vertices are tracked with atomic bits, so when
+// several threads find the same vertex only the one that sets its bit adds it to the
+// next frontier.
+// 
+// It's also direction-optimizing, choosing at each level between:
+// - Top-down: vertices in the frontier check their edges looking for unvisited vertices.
+//   Good when the frontier is small.
+// - Bottom-up: unvisited vertices check their incoming edges looking for a parent in the
+//   frontier, stopping as soon as one is found. Good when the frontier is large, which
+//   happens in the middle levels of low-diameter graphs (social networks, web, etc.),
+//   as most of the edges are never checked.
+// 
+// Bottom-up needs the incoming edges of each vertex, so directed graphs also need their
+// transposed graph. Undirected graphs are their own transposed graph.
+// 
+// Depths are always the same, but parents can change between runs when a vertex
+// has several parents in the previous level, as it depends on which thread gets it first.
+// 
+// Beamer, Asanovic, Patterson. Direction-Optimizing Breadth-First Search (2012).
+// --------------------------------------------------------------------------------
+
+struct BreathFirstSearchResult
+{
+    std::vector<int> m_depths;  // Number of edges from source. -1 if not reachable.
+    std::vector<int> m_parents; // Previous vertex in the path from source. -1 if not reachable or source.
+};
+
+namespace
+{
+    // Bitset that can be read and modified by several threads at the same time.
+    // Relaxed ordering is enough, the end of each level synchronizes the threads.
+    class AtomicBitset
+    {
+    public:
+        explicit AtomicBitset(int bitCount)
+            : m_words((bitCount + 63) / 64)
+        {
+        }
+
+        bool Test(int i) const
+        {
+            return m_words[i / 64].load(std::memory_order_relaxed) & Mask(i);
+        }
+
+        void Set(int i)
+        {
+            m_words[i / 64].fetch_or(Mask(i), std::memory_order_relaxed);
+        }
+
+        // Sets the bit and returns true if this call is the one that changed it.
+        bool TestAndSet(int i)
+        {
+            // Cheap check first to avoid the read-modify-write on already set bits.
+            if (Test(i))
+            {
+                return false;
+            }
+            return !(m_words[i / 64].fetch_or(Mask(i), std::memory_order_relaxed) & Mask(i));
+        }
+
+        // Not thread safe
+        void Clear()
+        {
+            for (auto& word : m_words)
+            {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Calls the function with the index of each set bit. Not thread safe.
+        template<typename Function>
+        void ForEachSet(Function function) const
+        {
+            for (std::size_t w = 0; w < m_words.size(); ++w)
+            {
+                for (std::uint64_t word = m_words[w].load(std::memory_order_relaxed); word != 0; word &= word - 1)
+                {
+                    function(static_cast<int>(w * 64 + std::countr_zero(word)));
+                }
+            }
+        }
+
+    private:
+        static std::uint64_t Mask(int i)
+        {
+            return std::uint64_t{ 1 } << (i % 64);
+        }
+
+        std::vector<std::atomic<std::uint64_t>> m_words;
+    };
+
+    // Heuristics to choose the direction of the next level (values from the paper):
+    // - Top-down to bottom-up when the edges of the next frontier are more than the unexplored edges / Alpha.
+    // - Bottom-up to top-down when the next frontier is shrinking and has less vertices than all vertices / Beta.
+    constexpr std::int64_t BottomUpAlpha = 14;
+    constexpr std::int64_t TopDownBeta = 24;
+
+    // Threads take chunks of work from the frontier (top-down) or from all the vertices (bottom-up).
+    // Bottom-up chunks are a multiple of 64 so each thread mostly writes its own words of the next frontier bits.
+    constexpr int TopDownChunkSize = 64;
+    constexpr int BottomUpChunkSize = 1024;
+}
+
+// Levels are processed by the thread pool, with the calling thread helping.
+// The transposed graph must have the same vertices as the graph, with all its edges reversed.
+BreathFirstSearchResult ParallelBreathFirstSearch(const GraphCSR& graph, const GraphCSR& transposedGraph, int source, ThreadPool& threadPool = ThreadPool::GetDefault())
+{
+    INSTRUMENT_ZONE("ParallelBreathFirstSearch");
+
+    const int vertexCount = graph.GetVertexCount();
+
+    BreathFirstSearchResult result{
+        std::vector<int>(vertexCount, -1),
+        std::vector<int>(vertexCount, -1) };
+
+    if (source < 0 || source >= vertexCount || transposedGraph.GetVertexCount() != vertexCount)
+    {
+        return result;
+    }
+
+    auto degree = [&graph](int v)
+    {
+        return static_cast<std::int64_t>(graph.GetNeighbors(v).size());
+    };
+
+    // Results of each thread in a level, merged once all threads finish it.
+    // One per worker plus one for the calling thread, in case it's not a worker.
+    // Aligned to avoid false sharing between threads.
+    struct alignas(64) ThreadLevel
+    {
+        std::vector<int> m_nextFrontier; // Only filled by top-down levels
+        int m_nextFrontierCount = 0;
+        std::int64_t m_nextFrontierEdges = 0;
+    };
+    std::vector<ThreadLevel> threadLevels(threadPool.GetWorkerCount() + 1);
+
+    auto currentThreadLevel = [&threadLevels, &threadPool]() -> ThreadLevel&
+    {
+        return threadLevels[threadPool.GetCurrentWorkerIndex() + 1];
+    };
+
+    AtomicBitset visited(vertexCount);
+    AtomicBitset frontierBits(vertexCount);     // Frontier used by bottom-up levels
+    AtomicBitset nextFrontierBits(vertexCount); // Next frontier filled by bottom-up levels
+    std::vector<int> frontier;                  // Frontier used by top-down levels
+
+    frontier.push_back(source);
+    visited.Set(source);
+    result.m_depths[source] = 0;
+
+    int depth = 0;
+    int frontierCount = 1;
+    bool isBottomUp = false;
+    std::int64_t unexploredEdges = graph.GetEdgeCount() - degree(source);
+
+    auto processTopDown = [&](std::size_t first, std::size_t last)
+    {
+        ThreadLevel& threadLevel = currentThreadLevel();
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const int v = frontier[i];
+            for (int v2 : graph.GetNeighbors(v).m_vertices)
+            {
+                if (visited.TestAndSet(v2))
+                {
+                    result.m_depths[v2] = depth + 1;
+                    result.m_parents[v2] = v;
+                    threadLevel.m_nextFrontier.push_back(v2);
+                    threadLevel.m_nextFrontierEdges += degree(v2);
+                }
+            }
+        }
+
+        threadLevel.m_nextFrontierCount = static_cast<int>(threadLevel.m_nextFrontier.size());
+    };
+
+    auto processBottomUp = [&](std::size_t first, std::size_t last)
+    {
+        ThreadLevel& threadLevel = currentThreadLevel();
+
+        for (int v = static_cast<int>(first); v < static_cast<int>(last); ++v)
+        {
+            if (visited.Test(v))
+            {
+                continue;
+            }
+
+            // Only this thread checks vertex v, so there is no race to visit it.
+            for (int v2 : transposedGraph.GetNeighbors(v).m_vertices)
+            {
+                if (frontierBits.Test(v2))
+                {
+                    result.m_depths[v] = depth + 1;
+                    result.m_parents[v] = v2;
+                    visited.Set(v);
+                    nextFrontierBits.Set(v);
+                    ++threadLevel.m_nextFrontierCount;
+                    threadLevel.m_nextFrontierEdges += degree(v);
+                    break;
+                }
+            }
+        }
+    };
+
+    // Executed by the calling thread once all the chunks of the level are finished.
+    // Returns if there is a next level.
+    auto completeLevel = [&]()
+    {
+        int nextFrontierCount = 0;
+        std::int64_t nextFrontierEdges = 0;
+        for (const ThreadLevel& threadLevel : threadLevels)
+        {
+            nextFrontierCount += threadLevel.m_nextFrontierCount;
+            nextFrontierEdges += threadLevel.m_nextFrontierEdges;
+        }
+        unexploredEdges -= nextFrontierEdges;
+
+        const bool wasBottomUp = isBottomUp;
+        if (wasBottomUp)
+        {
+            isBottomUp = nextFrontierCount >= frontierCount || nextFrontierCount >= vertexCount / TopDownBeta;
+        }
+        else
+        {
+            isBottomUp = nextFrontierEdges > unexploredEdges / BottomUpAlpha;
+        }
+
+        // Next frontier in the form used by the direction of the next level.
+        if (wasBottomUp)
+        {
+            std::swap(frontierBits, nextFrontierBits);
+            nextFrontierBits.Clear();
+
+            if (!isBottomUp)
+            {
+                frontier.clear();
+                frontierBits.ForEachSet([&frontier](int v) { frontier.push_back(v); });
+            }
+        }
+        else
+        {
+            frontier.clear();
+            for (const ThreadLevel& threadLevel : threadLevels)
+            {
+                frontier.insert(frontier.end(), threadLevel.m_nextFrontier.begin(), threadLevel.m_nextFrontier.end());
+            }
+
+            if (isBottomUp)
+            {
+                frontierBits.Clear();
+                std::ranges::for_each(frontier, [&frontierBits](int v) { frontierBits.Set(v); });
+            }
+        }
+
+        for (ThreadLevel& threadLevel : threadLevels)
+        {
+            threadLevel.m_nextFrontier.clear(); // Keeps capacity
+            threadLevel.m_nextFrontierCount = 0;
+            threadLevel.m_nextFrontierEdges = 0;
+        }
+
+        ++depth;
+        frontierCount = nextFrontierCount;
+        return nextFrontierCount > 0;
+    };
+
+    do
+    {
+        if (isBottomUp)
+        {
+            threadPool.ParallelForRange(0, vertexCount, processBottomUp, BottomUpChunkSize);
+        }
+        else
+        {
+            threadPool.ParallelForRange(0, frontier.size(), processTopDown, TopDownChunkSize);
+        }
+    } while (completeLevel());
+
+    return result;
+}
+
+// Directed graphs are transposed in each call, which costs O(V + E) and a copy of the graph.
+// To do several searches on a directed graph, transpose it once and use the other version.
+BreathFirstSearchResult ParallelBreathFirstSearch(const GraphCSR& graph, int source, ThreadPool& threadPool = ThreadPool::GetDefault())
+{
+    if (!graph.IsDirected())
+    {
+        return ParallelBreathFirstSearch(graph, graph, source, threadPool);
+    }
+
+    return ParallelBreathFirstSearch(graph, graph.Transposed(), source, threadPool);
+}
+
+void GraphsParallelBreathFirstSearch()
+{
+    GraphEdgeList graphEdgeList;
+    graphEdgeList.SetEdge(0, 1, 7.0f);
+    graphEdgeList.SetEdge(1, 3, 5.0f);
+    graphEdgeList.SetEdge(2, 0, 2.0f);
+    graphEdgeList.SetEdge(2, 1, 1.0f);
+    graphEdgeList.SetEdge(2, 4, 6.0f);
+    graphEdgeList.SetEdge(3, 5, 7.0f);
+    graphEdgeList.SetEdge(4, 1, 3.0f);
+    graphEdgeList.SetEdge(4, 3, 9.0f);
+    graphEdgeList.SetEdge(4, 5, 4.0f);
+
+    const GraphCSR graph(graphEdgeList);
+
+    const BreathFirstSearchResult result = ParallelBreathFirstSearch(graph, 2);
+
+    std::printf("ParallelBreathFirstSearch vertex 2:\n");
+    for (int v = 0; v < graph.GetVertexCount(); ++v)
+    {
+        std::printf("%d: depth %d parent %d\n", v, result.m_depths[v], result.m_parents[v]);
+    }
+    std::printf("\n");
+
+    // Large random undirected graph. Random graphs have a low diameter,
+    // so the middle levels have large frontiers and are processed bottom-up.
+    const int largeVertexCount = 100000;
+    const int largeEdgeCount = 1000000;
+
+    std::mt19937 randomEngine(42);
+    std::uniform_int_distribution<int> randomVertex(0, largeVertexCount - 1);
+
+    GraphEdgeList largeGraphEdgeList(false);
+    for (int i = 0; i < largeEdgeCount; ++i)
+    {
+        largeGraphEdgeList.SetEdge(randomVertex(randomEngine), randomVertex(randomEngine), 1.0f);
+    }
+
+    const GraphCSR largeGraph(largeGraphEdgeList);
+
+    const BreathFirstSearchResult largeResult = ParallelBreathFirstSearch(largeGraph, 0);
+
+    std::vector<int> verticesPerDepth;
+    for (int depth : largeResult.m_depths)
+    {
+        if (depth >= 0)
+        {
+            verticesPerDepth.resize(std::max<std::size_t>(verticesPerDepth.size(), depth + 1), 0);
+            ++verticesPerDepth[depth];
+        }
+    }
+
+    std::printf("ParallelBreathFirstSearch on %d vertices and %d edges, vertices per depth: ", largeGraph.GetVertexCount(), largeGraph.GetEdgeCount());
+    for (int count : verticesPerDepth)
+    {
+        std::printf("%d ", count);
+    }
+    std::printf("\n\n");
 }
 
 // --------------------------------------------------------------------------------
-// Traversing a graph: Depth First and Breadth First
+// Dijkstra algorithm
 // 
-// The traverse algorithms are the same as in Trees (see Trees.cpp), but it's required
-// to keep a vertex visited list to avoid cycles.
+// Given a weighted graph (only with positive values) and a source vertex, it finds
+// the shortest paths from that source vertex to all the other vertices in the graph.
 // 
-// Applications of Depth First Search (DFS):
-// - Detecting cycles in a graph by tracking visited edges.
-// - Path finding from vertex A to B. use a stack to keep track of visited vertices,
-//   once B is found, return the content of the stack.
-// - Solving puzzles with only one solution, such as mazes.
+// It can also be used to find the shortest path to a specific destination node,
+// by terminating the algorithm once the shortest path to the destination node is known.
 // 
-// Applications of Breadth First Search (BFS):
-// - Shortest path in unweighted graphs (path with the least number of edges).
-// - Find all neighbors. Peer-to-Peer networks, Social Networks, GPS System.
-// - Detecting cycles in undirected graph.
-// - Path finding, detect if there is a path between A and B.
-// - AI: find best move
-// - Find all connected components in an undirected graph.
-// - Image processing: Flood-fill an image with a particular color.
+// https://www.geeksforgeeks.org/dijkstras-shortest-path-algorithm-greedy-algo-7/
+// https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
 // --------------------------------------------------------------------------------
 
-void TraverseDepthFirst_Recursive(const Graph* graph, int v, std::vector<int>& visited)
+// Min heap of vertices by key where each vertex can only be once, with the possibility
+// to decrease the key of a vertex already in the heap.
+// 
+// It's 4-ary instead of binary: the tree has half the levels, so pushing and decreasing
+// keys move less elements, and the 4 children of a node are next to each other in memory,
+// which makes finding the minimum child cache friendly when popping.
+// 
+// Keys are stored next to the vertices and a position per vertex keeps where each vertex
+// is in the heap. No memory is allocated after the first use with the same number of vertices.
+class IndexedHeap
 {
-    if (!graph)
+public:
+    static constexpr std::size_t Arity = 4;
+
+    IndexedHeap() = default;
+
+    // Empties the heap and prepares it for a graph with this number of vertices.
+    void Reset(int vertexCount)
     {
-        return;
+        // Vertices not in the heap always have position -1,
+        // so only the vertices still in the heap need resetting.
+        for (const Entry& entry : m_entries)
+        {
+            m_positions[entry.m_vertex] = -1;
+        }
+        m_entries.clear(); // Keeps capacity
+
+        if (m_positions.size() < vertexCount)
+        {
+            m_positions.resize(vertexCount, -1);
+            m_entries.reserve(vertexCount);
+        }
+    }
+
+    bool IsEmpty() const
+    {
+        return m_entries.empty();
     }
 
-    std::printf("%d ", v);
-    visited.push_back(v);
+    bool Contains(int v) const
+    {
+        return m_positions[v] >= 0;
+    }
 
-    std::ranges::for_each(graph->GetEdges(v), 
-        [graph, &visited](const Edge& edge)
+    // Adds the vertex to the heap, or decreases its key if it's already in the heap. O(log n)
+    void PushOrDecrease(int v, float key)
+    {
+        if (Contains(v))
         {
-            if (std::ranges::find(visited, edge.m_vertex2) == visited.end())
-            {
-                TraverseDepthFirst_Recursive(graph, edge.m_vertex2, visited);
-            }
-        });
-}
+            m_entries[m_positions[v]].m_key = key;
+            SiftUp(m_positions[v]);
+        }
+        else
+        {
+            m_entries.push_back({ key, v });
+            m_positions[v] = static_cast<int>(m_entries.size()) - 1;
+            SiftUp(m_entries.size() - 1);
+        }
+    }
 
-void TraverseDepthFirst_NonRecursive(const Graph* graph, int v)
-{
-    std::stack<int> stack;
-    std::vector<int> visited;
+    // Removes and returns the vertex with the minimum key. O(log n)
+    int Pop()
+    {
+        const int v = m_entries.front().m_vertex;
+        m_positions[v] = -1;
+
+        if (m_entries.size() > 1)
+        {
+            m_entries.front() = m_entries.back();
+            m_positions[m_entries.front().m_vertex] = 0;
+            m_entries.pop_back();
+            SiftDown(0);
+        }
+        else
+        {
+            m_entries.pop_back();
+        }
+        return v;
+    }
 
-    stack.push(v);
-    visited.push_back(v);
+private:
+    struct Entry
+    {
+        float m_key;
+        int m_vertex;
+    };
 
-    while (!stack.empty())
+    // Moves the entry to its parent position while its key is lower.
+    // Entries are moved down instead of swapped, placing the entry once at the end.
+    void SiftUp(std::size_t i)
     {
-        int vertex = stack.top();
-        stack.pop();
+        const Entry entry = m_entries[i];
+        while (i > 0)
+        {
+            const std::size_t parent = (i - 1) / Arity;
+            if (m_entries[parent].m_key <= entry.m_key)
+            {
+                break;
+            }
+            Place(i, m_entries[parent]);
+            i = parent;
+        }
+        Place(i, entry);
+    }
 
-        std::printf("%d ", vertex);
+    // Moves the entry to the position of its minimum child while it's greater.
+    void SiftDown(std::size_t i)
+    {
+        const Entry entry = m_entries[i];
+        const std::size_t size = m_entries.size();
+        while (true)
+        {
+            const std::size_t firstChild = i * Arity + 1;
+            if (firstChild >= size)
+            {
+                break;
+            }
 
-        // Notice the reverse order!
-        std::ranges::for_each(graph->GetEdges(vertex) | std::views::reverse,
-            [&stack, &visited](const Edge& edge)
+            const std::size_t lastChild = std::min(firstChild + Arity, size);
+            std::size_t minChild = firstChild;
+            for (std::size_t child = firstChild + 1; child < lastChild; ++child)
             {
-                if (std::ranges::find(visited, edge.m_vertex2) == visited.end())
+                if (m_entries[child].m_key < m_entries[minChild].m_key)
                 {
-                    stack.push(edge.m_vertex2);
-                    visited.push_back(edge.m_vertex2);
+                    minChild = child;
                 }
-            });
+            }
+
+            if (entry.m_key <= m_entries[minChild].m_key)
+            {
+                break;
+            }
+            Place(i, m_entries[minChild]);
+            i = minChild;
+        }
+        Place(i, entry);
     }
-}
 
-void TraverseBreathFirst_NonRecursive(const Graph* graph, int v)
+    void Place(std::size_t i, const Entry& entry)
+    {
+        m_entries[i] = entry;
+        m_positions[entry.m_vertex] = static_cast<int>(i);
+    }
+
+    std::vector<Entry> m_entries;
+    std::vector<int> m_positions; // Position of each vertex in the heap, -1 if not in it.
+};
+
+// Reusable data for the shortest path functions, so doing many queries on the same
+// graph doesn't allocate memory nor has to reset the distances of every vertex.
+// 
+// As in TraversalWorkspace, distances and parents are epoch-stamped: they are only
+// valid when the vertex stamp is the current epoch, otherwise the vertex hasn't been
+// reached by the current query. The results of a query are kept until the next one.
+class ShortestPathWorkspace
 {
-    std::queue<int> queue;
-    std::vector<int> visited;
+public:
+    static constexpr float Infinity = std::numeric_limits<float>::infinity();
 
-    queue.push(v);
-    visited.push_back(v);
+    ShortestPathWorkspace() = default;
 
-    while (!queue.empty())
+    // Prepares the workspace for a new query on a graph with this number of vertices.
+    void Begin(int vertexCount)
     {
-        int vertex = queue.front();
-        queue.pop();
+        if (m_epochs.size() < vertexCount)
+        {
+            m_epochs.resize(vertexCount, 0);
+            m_distances.resize(vertexCount);
+            m_parents.resize(vertexCount);
+        }
 
-        std::printf("%d ", vertex);
+        // Stamps are only cleared when the epoch wraps around.
+        if (++m_epoch == 0)
+        {
+            std::ranges::fill(m_epochs, 0);
+            m_epoch = 1;
+        }
+
+        m_heap.Reset(vertexCount);
+        m_settledCount = 0;
+    }
+
+    bool IsReached(int v) const
+    {
+        return m_epochs[v] == m_epoch;
+    }
+
+    // Distance from source of the last query. Infinity if not reached.
+    // When the query stopped early, only the distances of settled vertices are final.
+    float GetDistance(int v) const
+    {
+        return IsReached(v) ? m_distances[v] : Infinity;
+    }
+
+    // Previous vertex in the shortest path from source. -1 if not reached or source.
+    int GetParent(int v) const
+    {
+        return IsReached(v) ? m_parents[v] : -1;
+    }
+
+    // Fills the path with the vertices from source to target, empty if target wasn't reached.
+    void GetPath(int target, std::vector<int>& path) const
+    {
+        path.clear();
+        if (!IsReached(target))
+        {
+            return;
+        }
+
+        for (int v = target; v != -1; v = m_parents[v])
+        {
+            path.push_back(v);
+        }
+        std::ranges::reverse(path);
+    }
+
+    // Number of vertices whose shortest path was found by the last query.
+    int GetSettledCount() const
+    {
+        return m_settledCount;
+    }
+
+    // Used by the shortest path functions
+
+    void SetDistance(int v, float distance, int parent)
+    {
+        m_epochs[v] = m_epoch;
+        m_distances[v] = distance;
+        m_parents[v] = parent;
+    }
+
+    void Settle()
+    {
+        ++m_settledCount;
+    }
+
+    IndexedHeap& GetHeap()
+    {
+        return m_heap;
+    }
+
+private:
+    std::vector<std::uint32_t> m_epochs;
+    std::uint32_t m_epoch = 0;
+    std::vector<float> m_distances;
+    std::vector<int> m_parents;
+    IndexedHeap m_heap;
+    int m_settledCount = 0;
+};
+
+namespace
+{
+    // Used as A* heuristic to get Dijkstra.
+    struct ZeroHeuristic
+    {
+        float operator()([[maybe_unused]] int v) const
+        {
+            return 0.0f;
+        }
+    };
+
+    // Dijkstra when heuristic is ZeroHeuristic, A* otherwise.
+    // Stops when target is settled, or explores all the graph when target is -1.
+    template<EdgesViewable GraphType, typename Heuristic>
+    void SearchShortestPaths(const GraphType* graph, int source, int target, Heuristic& heuristic, ShortestPathWorkspace& workspace)
+    {
+        workspace.Begin(graph->GetVertexCount());
+
+        IndexedHeap& heap = workspace.GetHeap();
 
-        std::ranges::for_each(graph->GetEdges(vertex),
-            [&queue, &visited](const Edge& edge)
+        workspace.SetDistance(source, 0.0f, -1);
+        heap.PushOrDecrease(source, heuristic(source));
+
+        while (!heap.IsEmpty())
+        {
+            const int vertex = heap.Pop();
+            workspace.Settle();
+
+            if (vertex == target)
             {
-                if (std::ranges::find(visited, edge.m_vertex2) == visited.end())
+                return;
+            }
+
+            const float distance = workspace.GetDistance(vertex);
+
+            std::ranges::for_each(graph->Edges(vertex),
+                [&heap, &workspace, &heuristic, distance](const Edge& edge)
                 {
-                    queue.push(edge.m_vertex2);
-                    visited.push_back(edge.m_vertex2);
-                }
-            });
+                    const float newDistance = distance + edge.m_weight;
+                    if (newDistance < workspace.GetDistance(edge.m_vertex2))
+                    {
+                        workspace.SetDistance(edge.m_vertex2, newDistance, edge.m_vertex1);
+                        heap.PushOrDecrease(edge.m_vertex2, newDistance + heuristic(edge.m_vertex2));
+                    }
+                });
+        }
     }
 }
 
-void GraphsTraverse()
+// Shortest paths from source to all the vertices, results are in the workspace.
+// Edge weights must be positive. O((v + e) log v)
+template<EdgesViewable GraphType>
+void Dijkstra(const GraphType* graph, int source, ShortestPathWorkspace& workspace)
+{
+    INSTRUMENT_ZONE("Dijkstra");
+
+    if (!graph || source < 0 || source >= graph->GetVertexCount())
+    {
+        return;
+    }
+
+    ZeroHeuristic heuristic;
+    SearchShortestPaths(graph, source, -1, heuristic, workspace);
+}
+
+// Shortest path from source to target, stopping as soon as it's found.
+// Returns the distance, Infinity if target is not reachable. The path is in the workspace.
+template<EdgesViewable GraphType>
+float Dijkstra(const GraphType* graph, int source, int target, ShortestPathWorkspace& workspace)
+{
+    INSTRUMENT_ZONE("Dijkstra (target)");
+
+    if (!graph || source < 0 || source >= graph->GetVertexCount() || target < 0 || target >= graph->GetVertexCount())
+    {
+        return ShortestPathWorkspace::Infinity;
+    }
+
+    ZeroHeuristic heuristic;
+    SearchShortestPaths(graph, source, target, heuristic, workspace);
+
+    return workspace.GetDistance(target);
+}
+
+void GraphsDijkstra()
 {
     const int graphVertexCount = 6;
     GraphAdjecencyList graph(graphVertexCount);
@@ -517,37 +2448,30 @@ void GraphsTraverse()
     graph.SetEdge(4, 3, 9.0f);
     graph.SetEdge(4, 5, 4.0f);
 
-    std::printf("TraverseDepthFirst_Recursive vertex 2: ");
-    std::vector<int> visited;
-    TraverseDepthFirst_Recursive(&graph, 2, visited);
-    std::printf("\n");
+    // The same workspace is reused by all the queries.
+    ShortestPathWorkspace workspace;
+    std::vector<int> path;
 
-    std::printf("TraverseDepthFirst_NonRecursive vertex 2: ");
-    TraverseDepthFirst_NonRecursive(&graph, 2);
-    std::printf("\n");
+    std::printf("Dijkstra vertex 2:\n");
+    Dijkstra(&graph, 2, workspace);
+    for (int v = 0; v < graphVertexCount; ++v)
+    {
+        workspace.GetPath(v, path);
 
-    std::printf("TraverseBreathFirst_NonRecursive vertex 2: ");
-    TraverseBreathFirst_NonRecursive(&graph, 2);
+        std::printf("%d: distance %0.1f path ", v, workspace.GetDistance(v));
+        std::ranges::for_each(path, [](int vertex) { std::printf("%d ", vertex); });
+        std::printf("\n");
+    }
+
+    const float distance = Dijkstra(&graph, 2, 3, workspace);
+    std::printf("Dijkstra vertex 2 to 3: distance %0.1f settling %d vertices\n", distance, workspace.GetSettledCount());
     std::printf("\n");
 }
 
-// --------------------------------------------------------------------------------
-// Dijkstra algorithm
-// 
-// Given a weighted graph (only with positive values) and a source vertex, it finds
-// the shortest paths from that source vertex to all the other vertices in the graph.
-// 
-// It can also be used to find the shortest path to a specific destination node,
-// by terminating the algorithm once the shortest path to the destination node is known.
-// 
-// https://www.geeksforgeeks.org/dijkstras-shortest-path-algorithm-greedy-algo-7/
-// https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
-// --------------------------------------------------------------------------------
-
 // --------------------------------------------------------------------------------
 // A*
 // 
-// A* is a modification of Dijkstras Algorithm that is optimized for a single goal.
+// A* is a modification of Dijkstras Algorithm that is optimized for a single goal.
 // A* achieves better performance by using heuristics to guide its search.
 // A* cost function that tries to minimize is f(n) = g(n) + h(n), where g(n) is the cost from
 // origin to the next node in the path (as in Dijkstra) and h(n) is a heuristic value
@@ -559,6 +2483,80 @@ void GraphsTraverse()
 // https://en.wikipedia.org/wiki/A*_search_algorithm
 // --------------------------------------------------------------------------------
 
+// Shortest path from source to target guided by the heuristic, stopping as soon as it's found.
+// Heuristic is called with a vertex and returns the estimated distance from it to target.
+// To find the shortest path the heuristic must never overestimate the distance.
+// Returns the distance, Infinity if target is not reachable. The path is in the workspace.
+template<EdgesViewable GraphType, typename Heuristic>
+    requires std::is_invocable_r_v<float, Heuristic&, int>
+float AStar(const GraphType* graph, int source, int target, Heuristic heuristic, ShortestPathWorkspace& workspace)
+{
+    INSTRUMENT_ZONE("AStar");
+
+    if (!graph || source < 0 || source >= graph->GetVertexCount() || target < 0 || target >= graph->GetVertexCount())
+    {
+        return ShortestPathWorkspace::Infinity;
+    }
+
+    SearchShortestPaths(graph, source, target, heuristic, workspace);
+
+    return workspace.GetDistance(target);
+}
+
+void GraphsAStar()
+{
+    // Grid of cells connected to their 4 neighbors, with a wall in the middle.
+    const int gridWidth = 20;
+    const int gridHeight = 20;
+    auto cell = [gridWidth](int x, int y) { return y * gridWidth + x; };
+    auto isWall = [](int x, int y) { return x == 10 && y > 2; };
+
+    GraphAdjecencyList graph(gridWidth * gridHeight, false);
+    for (int y = 0; y < gridHeight; ++y)
+    {
+        for (int x = 0; x < gridWidth; ++x)
+        {
+            if (isWall(x, y))
+            {
+                continue;
+            }
+            if (x + 1 < gridWidth && !isWall(x + 1, y))
+            {
+                graph.SetEdge(cell(x, y), cell(x + 1, y), 1.0f);
+            }
+            if (y + 1 < gridHeight && !isWall(x, y + 1))
+            {
+                graph.SetEdge(cell(x, y), cell(x, y + 1), 1.0f);
+            }
+        }
+    }
+
+    const int source = cell(2, 15);
+    const int target = cell(17, 15);
+
+    // Manhattan distance never overestimates in a 4-connected grid with weights 1.
+    auto manhattanDistance = [gridWidth, target](int v)
+    {
+        return static_cast<float>(
+            std::abs(v % gridWidth - target % gridWidth) +
+            std::abs(v / gridWidth - target / gridWidth));
+    };
+
+    ShortestPathWorkspace workspace;
+
+    const float dijkstraDistance = Dijkstra(&graph, source, target, workspace);
+    std::printf("Dijkstra (2,15) to (17,15): distance %0.1f settling %d vertices\n", dijkstraDistance, workspace.GetSettledCount());
+
+    const float aStarDistance = AStar(&graph, source, target, manhattanDistance, workspace);
+    std::printf("AStar (2,15) to (17,15): distance %0.1f settling %d vertices\n", aStarDistance, workspace.GetSettledCount());
+
+    std::vector<int> path;
+    workspace.GetPath(target, path);
+    std::printf("AStar path: ");
+    std::ranges::for_each(path, [gridWidth](int v) { std::printf("(%d,%d) ", v % gridWidth, v / gridWidth); });
+    std::printf("\n\n");
+}
+
 // --------------------------------------------------------------------------------
 // Bellman-Ford algorithm
 // 
@@ -577,3 +2575,87 @@ void GraphsTraverse()
 // 
 // https://www.geeksforgeeks.org/floyd-warshall-algorithm-dp-16/
 // --------------------------------------------------------------------------------
+
+// --------------------------------------------------------------------------------
+// Benchmarks (run by bench executable)
+// --------------------------------------------------------------------------------
+
+// Builds, saves, loads and scans CSR graphs with 16 random edges per vertex.
+// Sizes are the number of vertices.
+void BenchmarkGraphs(const BenchmarkOptions& options)
+{
+    const std::vector<std::size_t> sizes = options.m_sizes.empty() ? std::vector<std::size_t>{ std::size_t(1) << 20 } : options.m_sizes;
+    const std::filesystem::path filePath = std::filesystem::temp_directory_path() / "BenchmarkGraphs.csr";
+
+    for (std::size_t size : sizes)
+    {
+        const int vertexCount = static_cast<int>(std::min<std::size_t>(size, std::numeric_limits<int>::max() / 16));
+        const int edgeCount = vertexCount * 16;
+
+        std::printf("Graphs CSR file (%d vertices, %d edges)\n", vertexCount, edgeCount);
+
+        std::vector<Edge> edges(edgeCount);
+        std::mt19937 randomEngine(42);
+        std::uniform_int_distribution<int> randomVertex(0, vertexCount - 1);
+        std::uniform_real_distribution<float> randomWeight(1.0f, 10.0f);
+        std::ranges::generate(edges, [&]() { return Edge{ randomVertex(randomEngine), randomVertex(randomEngine), randomWeight(randomEngine) }; });
+
+        std::optional<GraphCSR> graph;
+        const double buildTime = MeasureMilliseconds([&]() { graph.emplace(vertexCount, edges, true); });
+        PrintBenchmark("Build CSR from edges", buildTime, edgeCount);
+
+        bool saved = false;
+        const double saveTime = MeasureMilliseconds([&]() { saved = graph->Save(filePath); });
+        if (!saved)
+        {
+            std::printf("Couldn't save %s\n\n", filePath.string().c_str());
+            return;
+        }
+        const std::size_t fileSize = std::filesystem::file_size(filePath);
+        PrintThroughput("Save CSR file", saveTime, edgeCount, fileSize);
+
+        // Maps the file and validates the offsets, the time depends on the vertices, not the edges.
+        std::optional<GraphCSR> loadedGraph;
+        const double loadTime = MeasureBestMilliseconds(3, [&]() { loadedGraph = GraphCSR::Load(filePath); });
+        if (!loadedGraph)
+        {
+            std::printf("Couldn't load %s\n\n", filePath.string().c_str());
+            std::filesystem::remove(filePath);
+            return;
+        }
+        PrintBenchmark("Load CSR file (mmap)", loadTime, 1);
+
+        // Reading all the edges, the first time loads the pages of the file.
+        auto sumWeights = [](const GraphCSR& graph)
+        {
+            double weightSum = 0.0;
+            for (int v = 0; v < graph.GetVertexCount(); ++v)
+            {
+                const GraphCSR::Neighbors neighbors = graph.GetNeighbors(v);
+                for (std::size_t i = 0; i < neighbors.size(); ++i)
+                {
+                    weightSum += neighbors.m_weights[i];
+                }
+            }
+            return weightSum;
+        };
+
+        double weightSum = 0.0;
+        const double firstScanTime = MeasureMilliseconds([&]() { weightSum = sumWeights(*loadedGraph); });
+        DoNotOptimize(weightSum);
+        PrintThroughput("Scan loaded CSR (first time)", firstScanTime, edgeCount, fileSize);
+
+        const double mappedScanTime = MeasureBestMilliseconds(3, [&]() { weightSum = sumWeights(*loadedGraph); });
+        DoNotOptimize(weightSum);
+        PrintThroughput("Scan loaded CSR", mappedScanTime, edgeCount, fileSize);
+
+        const double builtScanTime = MeasureBestMilliseconds(3, [&]() { weightSum = sumWeights(*graph); });
+        DoNotOptimize(weightSum);
+        PrintThroughput("Scan built CSR", builtScanTime, edgeCount, fileSize);
+
+        loadedGraph.reset(); // Unmapped before removing the file
+        std::filesystem::remove(filePath);
+
+        std::printf("\n");
+    }
+}
@@ -0,0 +1,271 @@
+#include "Instrumentation.h"
+
+#include <cstdlib>
+#include <new>
+#include <mutex>
+#include <thread>
+
+namespace Instrumentation
+{
+    namespace
+    {
+        std::mutex& GetZonesMutex()
+        {
+            static std::mutex zonesMutex;
+            return zonesMutex;
+        }
+
+        // Zones are constructed the first time their scope is reached, from any thread.
+        std::vector<const Zone*>& GetZoneList()
+        {
+            static std::vector<const Zone*> zones;
+            return zones;
+        }
+
+        // Trivial types, so they don't need to be constructed nor destroyed with the thread.
+        // Operator new can be called before main and after the thread variables are destroyed.
+        thread_local std::uint64_t ThreadAllocationCount = 0;
+        thread_local std::uint64_t ThreadAllocatedBytes = 0;
+    }
+
+    double GetTimestampFrequency()
+    {
+        static const double frequency = []()
+        {
+#if INSTRUMENTATION_RDTSC
+            const auto startTime = std::chrono::steady_clock::now();
+            const std::uint64_t startTicks = ReadTimestamp();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            const std::uint64_t ticks = ReadTimestamp() - startTicks;
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            return static_cast<double>(ticks) / seconds;
+#else
+            return 1e9; // Nanoseconds
+#endif
+        }();
+        return frequency;
+    }
+
+    AllocationCounts GetThreadAllocationCounts()
+    {
+        return { ThreadAllocationCount, ThreadAllocatedBytes };
+    }
+
+    Zone::Zone(const char* name, const char* file, int line)
+        : m_name(name)
+        , m_file(file)
+        , m_line(line)
+    {
+        std::lock_guard lock(GetZonesMutex());
+        GetZoneList().push_back(this);
+    }
+
+    std::vector<const Zone*> GetZones()
+    {
+        std::lock_guard lock(GetZonesMutex());
+        return GetZoneList();
+    }
+
+    void ResetZones()
+    {
+        std::lock_guard lock(GetZonesMutex());
+        for (const Zone* zone : GetZoneList())
+        {
+            Zone* mutableZone = const_cast<Zone*>(zone);
+            mutableZone->m_callCount = 0;
+            mutableZone->m_ticks = 0;
+            mutableZone->m_allocationCount = 0;
+            mutableZone->m_allocatedBytes = 0;
+        }
+    }
+
+    void PrintZones()
+    {
+        const std::vector<const Zone*> zones = GetZones();
+        if (zones.empty())
+        {
+            return;
+        }
+
+        std::printf("%-40s %10s %12s %12s %12s %14s\n", "Zone", "Calls", "Total ms", "Mean us", "Allocations", "Bytes");
+        for (const Zone* zone : zones)
+        {
+            const std::uint64_t callCount = zone->m_callCount.load(std::memory_order_relaxed);
+            if (callCount == 0)
+            {
+                continue;
+            }
+
+            const double milliseconds = TicksToMilliseconds(zone->m_ticks.load(std::memory_order_relaxed));
+            std::printf("%-40s %10llu %12.3f %12.3f %12llu %14llu\n",
+                zone->m_name,
+                static_cast<unsigned long long>(callCount),
+                milliseconds,
+                milliseconds * 1000.0 / static_cast<double>(callCount),
+                static_cast<unsigned long long>(zone->m_allocationCount.load(std::memory_order_relaxed)),
+                static_cast<unsigned long long>(zone->m_allocatedBytes.load(std::memory_order_relaxed)));
+        }
+        std::printf("\n");
+    }
+}
+
+#if INSTRUMENTATION_ENABLED
+
+// --------------------------------------------------------------------------------
+// Replacement of the global operator new and delete to count the allocations.
+// Only the allocations are counted, all of them go to malloc (or the aligned version).
+// --------------------------------------------------------------------------------
+
+namespace
+{
+    void* Allocate(std::size_t size)
+    {
+        ++Instrumentation::ThreadAllocationCount;
+        Instrumentation::ThreadAllocatedBytes += size;
+        return std::malloc(size != 0 ? size : 1);
+    }
+
+    void* AllocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        ++Instrumentation::ThreadAllocationCount;
+        Instrumentation::ThreadAllocatedBytes += size;
+
+        const std::size_t alignmentSize = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+        return _aligned_malloc(size != 0 ? size : 1, alignmentSize);
+#else
+        // aligned_alloc requires the size to be a multiple of the alignment.
+        const std::size_t alignedSize = (size + alignmentSize - 1) / alignmentSize * alignmentSize;
+        return std::aligned_alloc(alignmentSize, alignedSize != 0 ? alignedSize : alignmentSize);
+#endif
+    }
+
+    void FreeAligned(void* pointer)
+    {
+#if defined(_MSC_VER)
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+
+    void* AllocateOrThrow(std::size_t size)
+    {
+        if (void* pointer = Allocate(size))
+        {
+            return pointer;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* AllocateAlignedOrThrow(std::size_t size, std::align_val_t alignment)
+    {
+        if (void* pointer = AllocateAligned(size, alignment))
+        {
+            return pointer;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return AllocateOrThrow(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return AllocateOrThrow(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return Allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return AllocateAlignedOrThrow(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return AllocateAlignedOrThrow(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    FreeAligned(pointer);
+}
+
+#endif
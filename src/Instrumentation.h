@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+// Define INSTRUMENTATION_ENABLED as 1 to measure the zones and count the allocations
+// (CMake option CXX_REMINDER_INSTRUMENTATION). When it's 0, INSTRUMENT_ZONE is removed
+// at compile time and operator new isn't replaced, so the instrumented code costs nothing.
+#ifndef INSTRUMENTATION_ENABLED
+#define INSTRUMENTATION_ENABLED 0
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define INSTRUMENTATION_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define INSTRUMENTATION_RDTSC 1
+#else
+#define INSTRUMENTATION_RDTSC 0
+#endif
+
+// --------------------------------------------------------------------------------
+// Instrumentation
+//
+// Measures the hot paths of the demos and benchmarks from the inside:
+// - ScopedTimer: milliseconds of a scope with std::chrono::steady_clock, always available.
+// - ReadTimestamp: CPU timestamp counter (RDTSC on x86), much cheaper to read than a clock
+//   (around 20 cycles). It counts at a constant rate on modern CPUs, not at the current
+//   frequency, GetTimestampFrequency converts it to seconds.
+// - Allocation counting: number of calls to operator new and bytes, per thread.
+// - Zones: INSTRUMENT_ZONE("Name") at the start of a scope accumulates the calls, timestamp
+//   ticks and allocations of the scope into a zone, like a profiler zone (Tracy style).
+//   PrintZones shows all of them, the bench executable adds them to its JSON (see bench/main.cpp).
+//
+// Zones are static variables, so each instantiation of a template function has its own zone
+// with the same name. Recursive scopes count their time once per level, so zones are placed
+// in the functions that start the recursion. Each zone adds two timestamp reads and a few
+// atomic additions, too much for functions of a few nanoseconds.
+// --------------------------------------------------------------------------------
+
+namespace Instrumentation
+{
+    // Ticks of the CPU timestamp counter, or nanoseconds of steady_clock without it.
+    inline std::uint64_t ReadTimestamp()
+    {
+#if INSTRUMENTATION_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Timestamp ticks per second, measured against steady_clock the first time (takes 10 ms).
+    double GetTimestampFrequency();
+
+    inline double TicksToMilliseconds(std::uint64_t ticks)
+    {
+        return static_cast<double>(ticks) * 1000.0 / GetTimestampFrequency();
+    }
+
+    struct AllocationCounts
+    {
+        std::uint64_t m_allocationCount = 0;
+        std::uint64_t m_allocatedBytes = 0;
+    };
+
+    // Allocations made with operator new by the calling thread since it started.
+    // Always zero when INSTRUMENTATION_ENABLED is 0.
+    AllocationCounts GetThreadAllocationCounts();
+
+    // Accumulated measurements of a scope. Zones register themselves when constructed
+    // and must live until the end of the program (they are static variables).
+    struct Zone
+    {
+        Zone(const char* name, const char* file, int line);
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+        const char* m_name;
+        const char* m_file;
+        int m_line;
+
+        std::atomic<std::uint64_t> m_callCount = 0;
+        std::atomic<std::uint64_t> m_ticks = 0;
+        std::atomic<std::uint64_t> m_allocationCount = 0;
+        std::atomic<std::uint64_t> m_allocatedBytes = 0;
+    };
+
+    // All the zones reached so far, in the order they were first reached.
+    std::vector<const Zone*> GetZones();
+
+    // Sets the measurements of all the zones to zero.
+    void ResetZones();
+
+    // Prints a table with the zones that have been called.
+    void PrintZones();
+
+    // Adds the measurements of the scope to the zone when destroyed.
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(Zone& zone)
+            : m_zone(zone)
+            , m_startAllocations(GetThreadAllocationCounts())
+            , m_startTicks(ReadTimestamp())
+        {
+        }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+
+        ~ScopedZone()
+        {
+            const std::uint64_t ticks = ReadTimestamp() - m_startTicks;
+            const AllocationCounts allocations = GetThreadAllocationCounts();
+
+            m_zone.m_callCount.fetch_add(1, std::memory_order_relaxed);
+            m_zone.m_ticks.fetch_add(ticks, std::memory_order_relaxed);
+            m_zone.m_allocationCount.fetch_add(allocations.m_allocationCount - m_startAllocations.m_allocationCount, std::memory_order_relaxed);
+            m_zone.m_allocatedBytes.fetch_add(allocations.m_allocatedBytes - m_startAllocations.m_allocatedBytes, std::memory_order_relaxed);
+        }
+
+    private:
+        Zone& m_zone;
+        AllocationCounts m_startAllocations;
+        std::uint64_t m_startTicks;
+    };
+
+    // Prints the milliseconds of the scope when destroyed, or adds them to a variable.
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(const char* name)
+            : m_name(name)
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        explicit ScopedTimer(double& milliseconds)
+            : m_milliseconds(&milliseconds)
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer()
+        {
+            const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+            if (m_milliseconds)
+            {
+                *m_milliseconds += milliseconds;
+            }
+            else
+            {
+                std::printf("%s: %0.3f ms\n", m_name, milliseconds);
+            }
+        }
+
+    private:
+        const char* m_name = nullptr;
+        double* m_milliseconds = nullptr;
+        std::chrono::steady_clock::time_point m_start;
+    };
+}
+
+#if INSTRUMENTATION_ENABLED
+#define INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_IMPL(a, b)
+#define INSTRUMENT_ZONE(name) \
+    static Instrumentation::Zone INSTRUMENT_CONCAT(instrumentationZone, __LINE__)(name, __FILE__, __LINE__); \
+    const Instrumentation::ScopedZone INSTRUMENT_CONCAT(instrumentationScopedZone, __LINE__)(INSTRUMENT_CONCAT(instrumentationZone, __LINE__))
+#else
+#define INSTRUMENT_ZONE(name) static_cast<void>(0)
+#endif
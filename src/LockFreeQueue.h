@@ -0,0 +1,402 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <bit>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+
+// --------------------------------------------------------------------------------
+// Lock-free bounded queues
+//
+// Queues for producer/consumer hand-offs between threads without a mutex. All threads
+// only contend on the atomic indices and on the slots they use, instead of on one mutex.
+//
+// They have a fixed capacity (rounded up to a power of 2), so pushing into a full
+// queue fails (TryPush) or waits until there is space (Push).
+//
+// Blocking operations spin for a while and then sleep with std::atomic::wait, being woken
+// up with std::atomic::notify by the thread that makes the slot available, so they don't
+// need a std::mutex and std::condition_variable. Notifying is a system call, so it's only
+// done when a thread is sleeping, and only once until that thread sleeps again.
+// --------------------------------------------------------------------------------
+
+namespace LockFreeQueueDetail
+{
+    // Cache line size, used to keep data written by different threads in different cache lines.
+    constexpr std::size_t CacheLineSize = 64;
+
+    // Times an atomic is checked before going to sleep waiting for it to change.
+    constexpr int SpinCount = 64;
+
+    // Waits until the value of the atomic makes the predicate true.
+    // Before sleeping it sets the waiting flag, so StoreAndNotify knows it has to notify.
+    // The seq_cst operations make sure that either this sees the new value or StoreAndNotify
+    // sees the flag.
+    template<typename T, typename Predicate>
+    void WaitUntil(const std::atomic<T>& atomic, std::atomic<bool>& isWaiting, Predicate isReady)
+    {
+        for (int i = 0; i < SpinCount; ++i)
+        {
+            if (isReady(atomic.load(std::memory_order_acquire)))
+            {
+                return;
+            }
+        }
+
+        while (true)
+        {
+            isWaiting.store(true, std::memory_order_seq_cst);
+            const T value = atomic.load(std::memory_order_seq_cst);
+            if (isReady(value))
+            {
+                return;
+            }
+            atomic.wait(value, std::memory_order_acquire);
+        }
+    }
+
+    // Stores the value and wakes up the threads sleeping in WaitUntil.
+    // Clearing the flag avoids notifying again until they go back to sleep.
+    template<typename T>
+    void StoreAndNotify(std::atomic<T>& atomic, T value, std::atomic<bool>& isWaiting)
+    {
+        atomic.store(value, std::memory_order_seq_cst);
+        if (isWaiting.load(std::memory_order_seq_cst) && isWaiting.exchange(false, std::memory_order_seq_cst))
+        {
+            atomic.notify_all();
+        }
+    }
+
+    // Element storage that is constructed and destroyed explicitly,
+    // so T doesn't need to be default constructible.
+    template<typename T>
+    class Storage
+    {
+    public:
+        template<typename... Args>
+        void Construct(Args&&... args)
+        {
+            new (m_bytes) T(std::forward<Args>(args)...);
+        }
+
+        T& Get()
+        {
+            return *std::launder(reinterpret_cast<T*>(m_bytes));
+        }
+
+        void Destroy()
+        {
+            Get().~T();
+        }
+
+    private:
+        alignas(T) unsigned char m_bytes[sizeof(T)];
+    };
+}
+
+// Multiple producers and multiple consumers queue.
+//
+// Each slot has a sequence number that tells its turn:
+// - sequence == position: the slot is empty, the producer that gets this position can write it.
+// - sequence == position + 1: the slot is full, the consumer that gets this position can read it.
+// After reading it the sequence becomes position + capacity, the position of the next lap.
+//
+// Producers and consumers claim positions incrementing the push and pop indices, and
+// then each one only touches its own slot, so the indices are the only shared data.
+//
+// Vyukov. Bounded MPMC queue (2010).
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+template<typename T>
+class BoundedMPMCQueue
+{
+public:
+    explicit BoundedMPMCQueue(std::size_t capacity)
+        : m_capacity(std::bit_ceil(std::max<std::size_t>(capacity, 2)))
+        , m_mask(m_capacity - 1)
+        , m_slots(std::make_unique<Slot[]>(m_capacity))
+    {
+        for (std::size_t i = 0; i < m_capacity; ++i)
+        {
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // No threads can be using the queue.
+    ~BoundedMPMCQueue()
+    {
+        // Destroy the elements not popped.
+        for (std::size_t position = m_popIndex.load(std::memory_order_relaxed);
+            position != m_pushIndex.load(std::memory_order_relaxed);
+            ++position)
+        {
+            m_slots[position & m_mask].m_storage.Destroy();
+        }
+    }
+
+    BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+    BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+    std::size_t GetCapacity() const
+    {
+        return m_capacity;
+    }
+
+    // Returns false if the queue is full.
+    template<typename U>
+    bool TryPush(U&& value)
+    {
+        std::size_t position = m_pushIndex.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = m_slots[position & m_mask];
+            const std::size_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (difference == 0)
+            {
+                // Slot is empty, try to claim the position.
+                if (m_pushIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    Write(slot, position, std::forward<U>(value));
+                    return true;
+                }
+                // Failed exchange loaded the new position.
+            }
+            else if (difference < 0)
+            {
+                // Slot still has the element of the previous lap.
+                return false;
+            }
+            else
+            {
+                // Another producer claimed the position.
+                position = m_pushIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty.
+    bool TryPop(T& value)
+    {
+        std::size_t position = m_popIndex.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Slot& slot = m_slots[position & m_mask];
+            const std::size_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+            if (difference == 0)
+            {
+                // Slot is full, try to claim the position.
+                if (m_popIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    Read(slot, position, value);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                // Slot not written yet.
+                return false;
+            }
+            else
+            {
+                // Another consumer claimed the position.
+                position = m_popIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Waits while the queue is full.
+    // The position is claimed first, so producers push in the order they call Push.
+    template<typename U>
+    void Push(U&& value)
+    {
+        const std::size_t position = m_pushIndex.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = m_slots[position & m_mask];
+
+        LockFreeQueueDetail::WaitUntil(slot.m_sequence, slot.m_isWaiting,
+            [position](std::size_t sequence) { return sequence == position; });
+        Write(slot, position, std::forward<U>(value));
+    }
+
+    // Waits while the queue is empty.
+    T Pop()
+    {
+        const std::size_t position = m_popIndex.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = m_slots[position & m_mask];
+
+        LockFreeQueueDetail::WaitUntil(slot.m_sequence, slot.m_isWaiting,
+            [position](std::size_t sequence) { return sequence == position + 1; });
+
+        T value = std::move(slot.m_storage.Get());
+        slot.m_storage.Destroy();
+        Release(slot, position + m_capacity);
+        return value;
+    }
+
+private:
+    // Each slot in its own cache line, so producers and consumers
+    // using contiguous slots don't invalidate each other's cache lines.
+    struct alignas(LockFreeQueueDetail::CacheLineSize) Slot
+    {
+        std::atomic<std::size_t> m_sequence;
+        std::atomic<bool> m_isWaiting = false;
+        LockFreeQueueDetail::Storage<T> m_storage;
+    };
+
+    template<typename U>
+    void Write(Slot& slot, std::size_t position, U&& value)
+    {
+        slot.m_storage.Construct(std::forward<U>(value));
+        Release(slot, position + 1);
+    }
+
+    void Read(Slot& slot, std::size_t position, T& value)
+    {
+        value = std::move(slot.m_storage.Get());
+        slot.m_storage.Destroy();
+        Release(slot, position + m_capacity);
+    }
+
+    // Several threads can wait for the same slot (in different laps), so all are notified.
+    void Release(Slot& slot, std::size_t sequence)
+    {
+        LockFreeQueueDetail::StoreAndNotify(slot.m_sequence, sequence, slot.m_isWaiting);
+    }
+
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(LockFreeQueueDetail::CacheLineSize) std::atomic<std::size_t> m_pushIndex = 0;
+    alignas(LockFreeQueueDetail::CacheLineSize) std::atomic<std::size_t> m_popIndex = 0;
+};
+
+// Single producer and single consumer queue.
+//
+// With only one producer and one consumer, there is no need to claim positions nor
+// sequence numbers: the producer is the only one writing the push index and the consumer
+// the only one writing the pop index, so loads and stores are enough.
+//
+// Each side also keeps a cached copy of the other side's index, and only reads
+// the real one when the cached copy says the queue is full (or empty). So most of the
+// operations don't touch the cache line written by the other thread.
+//
+// Must be used by only one producer and one consumer thread at a time.
+template<typename T>
+class BoundedSPSCQueue
+{
+public:
+    explicit BoundedSPSCQueue(std::size_t capacity)
+        : m_capacity(std::bit_ceil(std::max<std::size_t>(capacity, 2)))
+        , m_mask(m_capacity - 1)
+        , m_slots(std::make_unique<LockFreeQueueDetail::Storage<T>[]>(m_capacity))
+    {
+    }
+
+    ~BoundedSPSCQueue()
+    {
+        for (std::size_t position = m_popIndex.load(std::memory_order_relaxed);
+            position != m_pushIndex.load(std::memory_order_relaxed);
+            ++position)
+        {
+            m_slots[position & m_mask].Destroy();
+        }
+    }
+
+    BoundedSPSCQueue(const BoundedSPSCQueue&) = delete;
+    BoundedSPSCQueue& operator=(const BoundedSPSCQueue&) = delete;
+
+    std::size_t GetCapacity() const
+    {
+        return m_capacity;
+    }
+
+    // Only called by the producer. Returns false if the queue is full.
+    template<typename U>
+    bool TryPush(U&& value)
+    {
+        const std::size_t pushIndex = m_pushIndex.load(std::memory_order_relaxed);
+        if (pushIndex - m_cachedPopIndex == m_capacity)
+        {
+            m_cachedPopIndex = m_popIndex.load(std::memory_order_acquire);
+            if (pushIndex - m_cachedPopIndex == m_capacity)
+            {
+                return false;
+            }
+        }
+
+        m_slots[pushIndex & m_mask].Construct(std::forward<U>(value));
+        LockFreeQueueDetail::StoreAndNotify(m_pushIndex, pushIndex + 1, m_isConsumerWaiting);
+        return true;
+    }
+
+    // Only called by the consumer. Returns false if the queue is empty.
+    bool TryPop(T& value)
+    {
+        const std::size_t popIndex = m_popIndex.load(std::memory_order_relaxed);
+        if (popIndex == m_cachedPushIndex)
+        {
+            m_cachedPushIndex = m_pushIndex.load(std::memory_order_acquire);
+            if (popIndex == m_cachedPushIndex)
+            {
+                return false;
+            }
+        }
+
+        value = std::move(m_slots[popIndex & m_mask].Get());
+        m_slots[popIndex & m_mask].Destroy();
+        LockFreeQueueDetail::StoreAndNotify(m_popIndex, popIndex + 1, m_isProducerWaiting);
+        return true;
+    }
+
+    // Only called by the producer. Waits while the queue is full.
+    template<typename U>
+    void Push(U&& value)
+    {
+        while (!TryPush(std::forward<U>(value)))
+        {
+            // Full, wait until the consumer pops something.
+            LockFreeQueueDetail::WaitUntil(m_popIndex, m_isProducerWaiting,
+                [this](std::size_t popIndex) { return popIndex != m_cachedPopIndex; });
+        }
+    }
+
+    // Only called by the consumer. Waits while the queue is empty.
+    T Pop()
+    {
+        const std::size_t popIndex = m_popIndex.load(std::memory_order_relaxed);
+        if (popIndex == m_cachedPushIndex)
+        {
+            // Empty, wait until the producer pushes the next element.
+            LockFreeQueueDetail::WaitUntil(m_pushIndex, m_isConsumerWaiting,
+                [popIndex](std::size_t pushIndex) { return pushIndex != popIndex; });
+            m_cachedPushIndex = m_pushIndex.load(std::memory_order_acquire);
+        }
+
+        T value = std::move(m_slots[popIndex & m_mask].Get());
+        m_slots[popIndex & m_mask].Destroy();
+        LockFreeQueueDetail::StoreAndNotify(m_popIndex, popIndex + 1, m_isProducerWaiting);
+        return value;
+    }
+
+private:
+    const std::size_t m_capacity;
+    const std::size_t m_mask;
+    std::unique_ptr<LockFreeQueueDetail::Storage<T>[]> m_slots;
+
+    // Producer's cache line. The consumer sets its waiting flag before sleeping.
+    alignas(LockFreeQueueDetail::CacheLineSize) std::atomic<std::size_t> m_pushIndex = 0;
+    std::size_t m_cachedPopIndex = 0;
+    std::atomic<bool> m_isConsumerWaiting = false;
+
+    // Consumer's cache line. The producer sets its waiting flag before sleeping.
+    alignas(LockFreeQueueDetail::CacheLineSize) std::atomic<std::size_t> m_popIndex = 0;
+    std::size_t m_cachedPushIndex = 0;
+    std::atomic<bool> m_isProducerWaiting = false;
+};
@@ -0,0 +1,155 @@
+#include "MemoryMappedFile.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_isOpen(std::exchange(other.m_isOpen, false))
+{
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_isOpen = std::exchange(other.m_isOpen, false);
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+// The view keeps the file mapping alive, so the handles are closed once the view is mapped.
+bool MemoryMappedFile::Open(const std::filesystem::path& path, AccessHint accessHint)
+{
+    Close();
+
+    const DWORD flags = (accessHint == AccessHint::Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN
+        : (accessHint == AccessHint::Random) ? FILE_FLAG_RANDOM_ACCESS
+        : FILE_ATTRIBUTE_NORMAL;
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    if (fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        m_isOpen = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+    {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+    {
+        return false;
+    }
+
+    m_data = static_cast<const std::byte*>(view);
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+    m_isOpen = true;
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (m_data)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+#else
+
+// The mapping keeps the file alive, so the file descriptor is closed once it's mapped.
+bool MemoryMappedFile::Open(const std::filesystem::path& path, AccessHint accessHint)
+{
+    Close();
+
+    const int fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStatus = {};
+    if (fstat(fileDescriptor, &fileStatus) != 0)
+    {
+        close(fileDescriptor);
+        return false;
+    }
+
+    if (fileStatus.st_size == 0)
+    {
+        close(fileDescriptor);
+        m_isOpen = true;
+        return true;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(fileStatus.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // Only a hint, the mapping works the same if it fails.
+    const int advice = (accessHint == AccessHint::Sequential) ? MADV_SEQUENTIAL
+        : (accessHint == AccessHint::Random) ? MADV_RANDOM
+        : MADV_NORMAL;
+    madvise(view, size, advice);
+
+    m_data = static_cast<const std::byte*>(view);
+    m_size = size;
+    m_isOpen = true;
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (m_data)
+    {
+        munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+#endif
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <iterator>
+#include <ranges>
+#include <filesystem>
+
+// --------------------------------------------------------------------------------
+// Memory Mapped File
+//
+// Read-only view of the contents of a file, mapped into the address space of the process
+// (mmap on POSIX, MapViewOfFile on Windows). Reading the contents reads directly the pages
+// of the operating system's file cache: no copies into buffers and no allocations, unlike
+// fread or std::ifstream with std::ostringstream (file cache -> stream buffer -> string).
+//
+// Pages are loaded on demand when they are first read, so mapping a multi-GB file is fast
+// and only the parts that are read take memory. The access hint tells the operating system
+// how the file will be read, so it can read ahead the next pages while scanning it.
+//
+// The contents are valid until the file is closed. The file must not be modified
+// while mapped (by this or another process), or the contents will change under the view.
+//
+// LinesView: lines of a text as std::string_view, without the '\n' (nor the '\r' of "\r\n").
+// It finds each end of line with memchr, which is vectorized in the standard libraries.
+// --------------------------------------------------------------------------------
+
+class MemoryMappedFile
+{
+public:
+    enum class AccessHint
+    {
+        Normal,
+        Sequential, // Reads ahead more pages, and frees the pages already read sooner.
+        Random,     // Doesn't read ahead.
+    };
+
+    MemoryMappedFile() = default;
+
+    // Check IsOpen to know if it succeeded.
+    explicit MemoryMappedFile(const std::filesystem::path& path, AccessHint accessHint = AccessHint::Normal)
+    {
+        Open(path, accessHint);
+    }
+
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    ~MemoryMappedFile()
+    {
+        Close();
+    }
+
+    // Closes the previous file, if any. Returns false if the file couldn't be opened or mapped.
+    // Empty files are open with empty contents (they can't be mapped).
+    bool Open(const std::filesystem::path& path, AccessHint accessHint = AccessHint::Normal);
+
+    // The contents are not valid anymore after closing.
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_isOpen;
+    }
+
+    std::size_t GetSize() const
+    {
+        return m_size;
+    }
+
+    std::span<const std::byte> GetBytes() const
+    {
+        return { m_data, m_size };
+    }
+
+    // Contents as text. It isn't null terminated.
+    std::string_view GetText() const
+    {
+        return { reinterpret_cast<const char*>(m_data), m_size };
+    }
+
+private:
+    const std::byte* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_isOpen = false;
+};
+
+class LinesView : public std::ranges::view_interface<LinesView>
+{
+public:
+    // Forward iterator, the lines are views of the text, so they are valid as long as the text.
+    class Iterator
+    {
+    public:
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag; // Dereferencing doesn't return a reference
+
+        Iterator() = default;
+
+        std::string_view operator*() const
+        {
+            return m_line;
+        }
+
+        Iterator& operator++()
+        {
+            m_position = m_next;
+            FindLine();
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return m_position == other.m_position;
+        }
+
+    private:
+        friend class LinesView;
+
+        Iterator(const char* position, const char* end)
+            : m_position(position)
+            , m_end(end)
+        {
+            FindLine();
+        }
+
+        // The last line doesn't need a '\n' at the end, and a '\n' at the end doesn't add an empty line.
+        void FindLine()
+        {
+            if (m_position == m_end)
+            {
+                m_line = {};
+                m_next = m_end;
+                return;
+            }
+
+            const char* newLine = static_cast<const char*>(std::memchr(m_position, '\n', m_end - m_position));
+            const char* lineEnd = newLine ? newLine : m_end;
+            m_next = newLine ? newLine + 1 : m_end;
+
+            if (lineEnd != m_position && lineEnd[-1] == '\r')
+            {
+                --lineEnd;
+            }
+            m_line = std::string_view(m_position, lineEnd - m_position);
+        }
+
+        const char* m_position = nullptr; // Start of the current line
+        const char* m_next = nullptr;     // Start of the next line
+        const char* m_end = nullptr;
+        std::string_view m_line;
+    };
+
+    LinesView() = default;
+
+    explicit LinesView(std::string_view text)
+        : m_text(text)
+    {
+    }
+
+    Iterator begin() const
+    {
+        return Iterator(m_text.data(), m_text.data() + m_text.size());
+    }
+
+    Iterator end() const
+    {
+        return Iterator(m_text.data() + m_text.size(), m_text.data() + m_text.size());
+    }
+
+private:
+    std::string_view m_text;
+};
+
+// Lines only refer to the text, not to the view, so they can outlive it.
+template<>
+inline constexpr bool std::ranges::enable_borrowed_range<LinesView> = true;
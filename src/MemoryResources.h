@@ -0,0 +1,425 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <new>
+
+// --------------------------------------------------------------------------------
+// Memory Resources
+//
+// std::pmr::memory_resource implementations with allocation counters, to build the whole
+// working set of a request (containers, trees, graphs) from one arena and free it at once.
+//
+// BumpResource: allocates by moving a pointer forward in big blocks taken from the upstream
+// resource, and deallocate does nothing. Release frees everything at once, O(blocks), and
+// blocks double their size, so there are only a few. Reset is the same, but it keeps the
+// biggest block for the next request, which then doesn't allocate from the upstream resource.
+// Similar to std::pmr::monotonic_buffer_resource, plus the counters and Reset.
+//
+// PoolResource: free lists by size class (powers of 2 from 8 to 1024 bytes) with the blocks
+// taken from a BumpResource, so deallocated blocks are reused by the next allocations of their
+// size class. Bigger or over-aligned allocations go directly to the upstream resource.
+// Good when the working set also frees memory while it's used (nodes that are deleted,
+// vectors that grow). Release frees everything at once too.
+//
+// CountingResource: only counts, it forwards everything to the upstream resource. To measure
+// what some code allocates, for example wrapping std::pmr::new_delete_resource().
+//
+// They aren't thread safe, same as std::pmr::unsynchronized_pool_resource, so use one per
+// request or per thread. Containers using them must be destroyed (or not used anymore)
+// before calling Release.
+// --------------------------------------------------------------------------------
+
+struct AllocationStats
+{
+    std::size_t m_allocationCount = 0;
+    std::size_t m_deallocationCount = 0;
+    std::size_t m_allocatedBytes = 0; // All the bytes ever allocated
+    std::size_t m_currentBytes = 0;   // Allocated and not deallocated yet
+    std::size_t m_peakBytes = 0;      // Maximum of current bytes
+    std::size_t m_upstreamBytes = 0;  // Currently taken from the upstream resource
+
+    void AddAllocation(std::size_t bytes)
+    {
+        ++m_allocationCount;
+        m_allocatedBytes += bytes;
+        m_currentBytes += bytes;
+        m_peakBytes = std::max(m_peakBytes, m_currentBytes);
+    }
+
+    void AddDeallocation(std::size_t bytes)
+    {
+        ++m_deallocationCount;
+        m_currentBytes -= bytes;
+    }
+};
+
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_upstream(upstream)
+    {
+    }
+
+    const AllocationStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+    // Counters restart from zero. Current bytes are kept, they are still allocated.
+    void ResetStats()
+    {
+        const std::size_t currentBytes = m_stats.m_currentBytes;
+        m_stats = {};
+        m_stats.m_currentBytes = currentBytes;
+        m_stats.m_peakBytes = currentBytes;
+        m_stats.m_upstreamBytes = currentBytes;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        void* memory = m_upstream->allocate(bytes, alignment);
+        m_stats.AddAllocation(bytes);
+        m_stats.m_upstreamBytes += bytes;
+        return memory;
+    }
+
+    void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override
+    {
+        m_upstream->deallocate(memory, bytes, alignment);
+        m_stats.AddDeallocation(bytes);
+        m_stats.m_upstreamBytes -= bytes;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* m_upstream = nullptr;
+    AllocationStats m_stats;
+};
+
+class BumpResource : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t DefaultFirstBlockSize = 4096;
+
+    explicit BumpResource(std::size_t firstBlockSize = DefaultFirstBlockSize,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_upstream(upstream)
+        , m_firstBlockSize(std::max(firstBlockSize, 2 * sizeof(BlockHeader)))
+        , m_nextBlockSize(m_firstBlockSize)
+    {
+    }
+
+    // The buffer is used before taking blocks from the upstream resource, and it's never freed,
+    // so it can be memory on the stack. Small requests might not allocate at all.
+    BumpResource(void* buffer, std::size_t bufferSize,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : BumpResource(std::max(DefaultFirstBlockSize, 2 * bufferSize), upstream)
+    {
+        m_buffer = static_cast<std::byte*>(buffer);
+        m_bufferSize = bufferSize;
+        m_current = m_buffer;
+        m_end = m_buffer + m_bufferSize;
+    }
+
+    BumpResource(const BumpResource&) = delete;
+    BumpResource& operator=(const BumpResource&) = delete;
+
+    ~BumpResource() override
+    {
+        FreeBlocks(m_blocks);
+    }
+
+    // Frees all the blocks, invalidating all the allocations.
+    void Release()
+    {
+        FreeBlocks(m_blocks);
+        m_blocks = nullptr;
+        m_current = m_buffer;
+        m_end = m_buffer + m_bufferSize;
+        m_nextBlockSize = m_firstBlockSize;
+        m_stats.m_currentBytes = 0;
+        m_stats.m_upstreamBytes = 0;
+    }
+
+    // Same as Release, but it keeps the last block (the biggest one) to reuse it.
+    // A request that needs the same memory as the previous one won't allocate from upstream.
+    void Reset()
+    {
+        if (!m_blocks)
+        {
+            Release();
+            return;
+        }
+
+        FreeBlocks(m_blocks->m_next);
+        m_blocks->m_next = nullptr;
+        m_current = reinterpret_cast<std::byte*>(m_blocks + 1);
+        m_end = reinterpret_cast<std::byte*>(m_blocks) + m_blocks->m_size;
+        m_stats.m_currentBytes = 0;
+        m_stats.m_upstreamBytes = m_blocks->m_size;
+    }
+
+    const AllocationStats& GetStats() const
+    {
+        return m_stats;
+    }
+
+private:
+    // At the start of each block taken from upstream.
+    struct BlockHeader
+    {
+        BlockHeader* m_next = nullptr;
+        std::size_t m_size = 0;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (!m_current || GetPadding(m_current, alignment) + bytes > static_cast<std::size_t>(m_end - m_current))
+        {
+            AllocateBlock(bytes, alignment);
+        }
+
+        std::byte* memory = m_current + GetPadding(m_current, alignment);
+        m_current = memory + bytes;
+        m_stats.AddAllocation(bytes);
+        return memory;
+    }
+
+    // Memory is only freed by Release or Reset.
+    void do_deallocate(void*, std::size_t bytes, std::size_t) override
+    {
+        m_stats.AddDeallocation(bytes);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    // Bytes to skip so the pointer has the alignment (a power of 2).
+    static std::size_t GetPadding(const std::byte* pointer, std::size_t alignment)
+    {
+        return static_cast<std::size_t>(-reinterpret_cast<std::uintptr_t>(pointer)) & (alignment - 1);
+    }
+
+    // The block is big enough for the allocation with any padding needed by its alignment.
+    void AllocateBlock(std::size_t bytes, std::size_t alignment)
+    {
+        const std::size_t blockSize = std::max(m_nextBlockSize, std::bit_ceil(sizeof(BlockHeader) + bytes + alignment));
+        void* memory = m_upstream->allocate(blockSize, alignof(std::max_align_t));
+
+        m_blocks = new (memory) BlockHeader{ m_blocks, blockSize };
+        m_current = reinterpret_cast<std::byte*>(m_blocks + 1);
+        m_end = static_cast<std::byte*>(memory) + blockSize;
+        m_nextBlockSize = 2 * blockSize;
+        m_stats.m_upstreamBytes += blockSize;
+    }
+
+    void FreeBlocks(BlockHeader* block)
+    {
+        while (block)
+        {
+            BlockHeader* next = block->m_next;
+            m_upstream->deallocate(block, block->m_size, alignof(std::max_align_t));
+            block = next;
+        }
+    }
+
+    std::pmr::memory_resource* m_upstream = nullptr;
+    std::size_t m_firstBlockSize = 0;
+    std::size_t m_nextBlockSize = 0;
+
+    std::byte* m_buffer = nullptr;
+    std::size_t m_bufferSize = 0;
+
+    BlockHeader* m_blocks = nullptr; // Last block first
+    std::byte* m_current = nullptr;
+    std::byte* m_end = nullptr;
+
+    AllocationStats m_stats;
+};
+
+class PoolResource : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t MinBlockSize = 8;
+    static constexpr std::size_t MaxBlockSize = 1024;
+
+    explicit PoolResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : m_blocks(16 * MaxBlockSize, upstream)
+        , m_upstream(upstream)
+    {
+    }
+
+    PoolResource(const PoolResource&) = delete;
+    PoolResource& operator=(const PoolResource&) = delete;
+
+    ~PoolResource() override
+    {
+        FreeLargeBlocks();
+    }
+
+    // Frees everything, invalidating all the allocations.
+    void Release()
+    {
+        FreeLargeBlocks();
+        m_blocks.Release();
+        m_freeLists.fill(nullptr);
+        m_stats.m_currentBytes = 0;
+    }
+
+    AllocationStats GetStats() const
+    {
+        AllocationStats stats = m_stats;
+        stats.m_upstreamBytes = m_blocks.GetStats().m_upstreamBytes + m_largeBytes;
+        return stats;
+    }
+
+private:
+    static constexpr std::size_t SizeClassCount = std::bit_width(MaxBlockSize / MinBlockSize);
+
+    // Deallocated blocks keep the next free block of their size class.
+    struct FreeBlock
+    {
+        FreeBlock* m_next = nullptr;
+    };
+
+    // Just before the memory of large allocations, to free them all with Release.
+    struct LargeBlock
+    {
+        LargeBlock* m_next = nullptr;
+        LargeBlock* m_previous = nullptr;
+        std::size_t m_bytes = 0;
+        std::size_t m_alignment = 0;
+    };
+
+    static bool IsLarge(std::size_t bytes, std::size_t alignment)
+    {
+        return bytes > MaxBlockSize || alignment > alignof(std::max_align_t);
+    }
+
+    // 0 for 8 bytes, 1 for 16 bytes... up to 7 for 1024 bytes.
+    static std::size_t GetSizeClass(std::size_t bytes)
+    {
+        return std::bit_width((std::max(bytes, MinBlockSize) - 1) / MinBlockSize);
+    }
+
+    // Space before the memory of large allocations, enough for the header and keeping the alignment.
+    // Both are powers of 2, so the biggest one is a multiple of the other.
+    static std::size_t GetLargeHeaderSize(std::size_t alignment)
+    {
+        return std::max(sizeof(LargeBlock), alignment);
+    }
+
+    static LargeBlock* GetLargeBlock(void* memory)
+    {
+        return reinterpret_cast<LargeBlock*>(static_cast<std::byte*>(memory) - sizeof(LargeBlock));
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        m_stats.AddAllocation(bytes);
+
+        if (IsLarge(bytes, alignment))
+        {
+            return AllocateLarge(bytes, alignment);
+        }
+
+        const std::size_t sizeClass = GetSizeClass(bytes);
+        if (FreeBlock* block = m_freeLists[sizeClass])
+        {
+            m_freeLists[sizeClass] = block->m_next;
+            return block;
+        }
+        return m_blocks.allocate(MinBlockSize << sizeClass, alignof(std::max_align_t));
+    }
+
+    void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override
+    {
+        m_stats.AddDeallocation(bytes);
+
+        if (IsLarge(bytes, alignment))
+        {
+            DeallocateLarge(memory);
+            return;
+        }
+
+        const std::size_t sizeClass = GetSizeClass(bytes);
+        m_freeLists[sizeClass] = new (memory) FreeBlock{ m_freeLists[sizeClass] };
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    void* AllocateLarge(std::size_t bytes, std::size_t alignment)
+    {
+        const std::size_t headerSize = GetLargeHeaderSize(alignment);
+        std::byte* memory = static_cast<std::byte*>(m_upstream->allocate(headerSize + bytes, std::max(alignment, alignof(LargeBlock))));
+        m_largeBytes += headerSize + bytes;
+
+        LargeBlock* block = new (memory + headerSize - sizeof(LargeBlock)) LargeBlock{ m_largeBlocks, nullptr, bytes, alignment };
+        if (m_largeBlocks)
+        {
+            m_largeBlocks->m_previous = block;
+        }
+        m_largeBlocks = block;
+
+        return memory + headerSize;
+    }
+
+    void DeallocateLarge(void* memory)
+    {
+        LargeBlock* block = GetLargeBlock(memory);
+        if (block->m_previous)
+        {
+            block->m_previous->m_next = block->m_next;
+        }
+        else
+        {
+            m_largeBlocks = block->m_next;
+        }
+        if (block->m_next)
+        {
+            block->m_next->m_previous = block->m_previous;
+        }
+
+        FreeLarge(memory, block->m_bytes, block->m_alignment);
+    }
+
+    void FreeLarge(void* memory, std::size_t bytes, std::size_t alignment)
+    {
+        const std::size_t headerSize = GetLargeHeaderSize(alignment);
+        m_upstream->deallocate(static_cast<std::byte*>(memory) - headerSize, headerSize + bytes, std::max(alignment, alignof(LargeBlock)));
+        m_largeBytes -= headerSize + bytes;
+    }
+
+    void FreeLargeBlocks()
+    {
+        while (LargeBlock* block = m_largeBlocks)
+        {
+            m_largeBlocks = block->m_next;
+            FreeLarge(reinterpret_cast<std::byte*>(block + 1), block->m_bytes, block->m_alignment);
+        }
+    }
+
+    BumpResource m_blocks;
+    std::array<FreeBlock*, SizeClassCount> m_freeLists = {};
+
+    std::pmr::memory_resource* m_upstream = nullptr;
+    LargeBlock* m_largeBlocks = nullptr;
+    std::size_t m_largeBytes = 0;
+
+    AllocationStats m_stats;
+};
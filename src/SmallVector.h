@@ -0,0 +1,662 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+// --------------------------------------------------------------------------------
+// Small Vector and Static Vector
+//
+// Vectors with storage for N elements inside the object itself (inline storage).
+//
+// SmallVector<T, N>: until it has more than N elements, the elements are in the inline
+// storage and it makes no allocations. With more elements it moves them to memory
+// allocated with the allocator, like std::vector. Good for the many small lists that
+// are usually short (children of a node, edges of a vertex), where std::vector would
+// allocate for each list, and reading the elements would follow a pointer to another
+// place in memory.
+//
+// StaticVector<T, N>: never allocates, it can't have more than N elements (it throws
+// std::length_error). Good when there is a known maximum of elements.
+//
+// Both are contiguous (iterators are pointers, they convert to std::span), and unlike
+// std::vector, moving them moves the inline elements one by one, so moving is O(n)
+// when they are inline. The size of the object grows with N, so N should be small.
+//
+// pmr::SmallVector uses std::pmr::polymorphic_allocator, so the memory of the vectors
+// that don't fit inline comes from a std::pmr::memory_resource.
+// --------------------------------------------------------------------------------
+
+template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class SmallVector
+{
+    static_assert(N > 0, "SmallVector needs inline capacity, use std::vector instead");
+
+    using AllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator& allocator)
+        : m_allocator(allocator)
+    {
+    }
+
+    SmallVector(size_type count, const T& value, const Allocator& allocator = Allocator())
+        : m_allocator(allocator)
+    {
+        assign(count, value);
+    }
+
+    SmallVector(std::initializer_list<T> values, const Allocator& allocator = Allocator())
+        : m_allocator(allocator)
+    {
+        assign(values.begin(), values.end());
+    }
+
+    SmallVector(const SmallVector& other)
+        : SmallVector(other, AllocatorTraits::select_on_container_copy_construction(other.m_allocator))
+    {
+    }
+
+    SmallVector(const SmallVector& other, const Allocator& allocator)
+        : m_allocator(allocator)
+    {
+        assign(other.begin(), other.end());
+    }
+
+    // Takes the allocated memory of the other vector, or moves its inline elements.
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : m_allocator(std::move(other.m_allocator))
+    {
+        MoveFrom(other);
+    }
+
+    // Used by the containers that pass their allocator to the elements (std::pmr::vector of pmr::SmallVector).
+    SmallVector(SmallVector&& other, const Allocator& allocator)
+        : m_allocator(allocator)
+    {
+        if (m_allocator == other.m_allocator)
+        {
+            MoveFrom(other);
+        }
+        else
+        {
+            MoveElementsFrom(other);
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            clear();
+            if constexpr (AllocatorTraits::propagate_on_container_move_assignment::value)
+            {
+                Deallocate();
+                m_allocator = std::move(other.m_allocator);
+                MoveFrom(other);
+            }
+            else if (m_allocator == other.m_allocator)
+            {
+                Deallocate();
+                MoveFrom(other);
+            }
+            else
+            {
+                MoveElementsFrom(other);
+            }
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        Deallocate();
+    }
+
+    template<typename InputIt>
+    void assign(InputIt first, InputIt last)
+    {
+        clear();
+        if constexpr (std::forward_iterator<InputIt>)
+        {
+            reserve(static_cast<size_type>(std::distance(first, last)));
+        }
+        for (; first != last; ++first)
+        {
+            emplace_back(*first);
+        }
+    }
+
+    void assign(size_type count, const T& value)
+    {
+        clear();
+        reserve(count);
+        std::uninitialized_fill_n(m_data, count, value);
+        m_size = count;
+    }
+
+    iterator begin()
+    {
+        return m_data;
+    }
+
+    const_iterator begin() const
+    {
+        return m_data;
+    }
+
+    iterator end()
+    {
+        return m_data + m_size;
+    }
+
+    const_iterator end() const
+    {
+        return m_data + m_size;
+    }
+
+    T* data()
+    {
+        return m_data;
+    }
+
+    const T* data() const
+    {
+        return m_data;
+    }
+
+    T& operator[](size_type i)
+    {
+        return m_data[i];
+    }
+
+    const T& operator[](size_type i) const
+    {
+        return m_data[i];
+    }
+
+    T& front()
+    {
+        return m_data[0];
+    }
+
+    const T& front() const
+    {
+        return m_data[0];
+    }
+
+    T& back()
+    {
+        return m_data[m_size - 1];
+    }
+
+    const T& back() const
+    {
+        return m_data[m_size - 1];
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    size_type capacity() const
+    {
+        return m_capacity;
+    }
+
+    // True while the elements are in the inline storage.
+    bool IsInline() const
+    {
+        return m_data == GetInlineData();
+    }
+
+    allocator_type get_allocator() const
+    {
+        return m_allocator;
+    }
+
+    void reserve(size_type capacity)
+    {
+        if (capacity > m_capacity)
+        {
+            Reallocate(capacity);
+        }
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (m_size == m_capacity)
+        {
+            // The new element is constructed before moving the elements,
+            // as the arguments could be references to elements of this vector.
+            const size_type newCapacity = 2 * m_capacity;
+            T* newData = AllocatorTraits::allocate(m_allocator, newCapacity);
+            try
+            {
+                std::construct_at(newData + m_size, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                AllocatorTraits::deallocate(m_allocator, newData, newCapacity);
+                throw;
+            }
+
+            try
+            {
+                MoveElementsTo(newData, newCapacity);
+            }
+            catch (...)
+            {
+                std::destroy_at(newData + m_size);
+                AllocatorTraits::deallocate(m_allocator, newData, newCapacity);
+                throw;
+            }
+        }
+        else
+        {
+            std::construct_at(m_data + m_size, std::forward<Args>(args)...);
+        }
+        return m_data[m_size++];
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back()
+    {
+        std::destroy_at(m_data + --m_size);
+    }
+
+    // Moves the elements after the erased one back.
+    iterator erase(const_iterator position)
+    {
+        T* erased = m_data + (position - m_data);
+        std::move(erased + 1, end(), erased);
+        pop_back();
+        return erased;
+    }
+
+    void resize(size_type count)
+    {
+        ResizeWith(count, [](T* element) { std::construct_at(element); });
+    }
+
+    void resize(size_type count, const T& value)
+    {
+        ResizeWith(count, [&value](T* element) { std::construct_at(element, value); });
+    }
+
+    // Destroys the elements, it keeps the capacity.
+    void clear()
+    {
+        std::destroy(begin(), end());
+        m_size = 0;
+    }
+
+private:
+    T* GetInlineData()
+    {
+        return reinterpret_cast<T*>(m_inlineStorage);
+    }
+
+    const T* GetInlineData() const
+    {
+        return reinterpret_cast<const T*>(m_inlineStorage);
+    }
+
+    template<typename Construct>
+    void ResizeWith(size_type count, Construct construct)
+    {
+        if (count < m_size)
+        {
+            std::destroy(begin() + count, end());
+            m_size = count;
+            return;
+        }
+
+        reserve(count);
+        for (; m_size < count; ++m_size)
+        {
+            construct(m_data + m_size);
+        }
+    }
+
+    void Reallocate(size_type newCapacity)
+    {
+        T* newData = AllocatorTraits::allocate(m_allocator, newCapacity);
+        try
+        {
+            MoveElementsTo(newData, newCapacity);
+        }
+        catch (...)
+        {
+            AllocatorTraits::deallocate(m_allocator, newData, newCapacity);
+            throw;
+        }
+    }
+
+    // Moves the elements to the new memory and frees the previous memory (if not inline).
+    // Elements are copied if moving could throw, so the vector is unchanged when it throws.
+    void MoveElementsTo(T* newData, size_type newCapacity)
+    {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            std::uninitialized_move(begin(), end(), newData);
+        }
+        else
+        {
+            std::uninitialized_copy(begin(), end(), newData);
+        }
+        std::destroy(begin(), end());
+        Deallocate();
+
+        m_data = newData;
+        m_capacity = newCapacity;
+    }
+
+    // Leaves the other vector empty and inline.
+    void MoveFrom(SmallVector& other)
+    {
+        if (other.IsInline())
+        {
+            m_data = GetInlineData();
+            m_capacity = N;
+            std::uninitialized_move(other.begin(), other.end(), m_data);
+            m_size = other.m_size;
+            other.clear();
+        }
+        else
+        {
+            m_data = std::exchange(other.m_data, other.GetInlineData());
+            m_size = std::exchange(other.m_size, 0);
+            m_capacity = std::exchange(other.m_capacity, N);
+        }
+    }
+
+    // Memory of the other vector can't be freed with this allocator, so the elements are moved.
+    // This vector must be empty.
+    void MoveElementsFrom(SmallVector& other)
+    {
+        reserve(other.size());
+        std::uninitialized_move(other.begin(), other.end(), m_data);
+        m_size = other.m_size;
+        other.clear();
+    }
+
+    void Deallocate()
+    {
+        if (!IsInline())
+        {
+            AllocatorTraits::deallocate(m_allocator, m_data, m_capacity);
+            m_data = GetInlineData();
+            m_capacity = N;
+        }
+    }
+
+    T* m_data = GetInlineData();
+    size_type m_size = 0;
+    size_type m_capacity = N;
+    [[no_unique_address]] Allocator m_allocator;
+    alignas(T) std::byte m_inlineStorage[N * sizeof(T)];
+};
+
+template<typename T, std::size_t N>
+class StaticVector
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVector() = default;
+
+    StaticVector(std::initializer_list<T> values)
+    {
+        CheckCapacity(values.size());
+        for (const T& value : values)
+        {
+            emplace_back(value);
+        }
+    }
+
+    StaticVector(const StaticVector& other)
+    {
+        std::uninitialized_copy(other.begin(), other.end(), data());
+        m_size = other.m_size;
+    }
+
+    StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        std::uninitialized_move(other.begin(), other.end(), data());
+        m_size = other.m_size;
+        other.clear();
+    }
+
+    StaticVector& operator=(const StaticVector& other)
+    {
+        if (this != &other)
+        {
+            clear();
+            std::uninitialized_copy(other.begin(), other.end(), data());
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+
+    StaticVector& operator=(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this != &other)
+        {
+            clear();
+            std::uninitialized_move(other.begin(), other.end(), data());
+            m_size = other.m_size;
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~StaticVector()
+    {
+        clear();
+    }
+
+    iterator begin()
+    {
+        return data();
+    }
+
+    const_iterator begin() const
+    {
+        return data();
+    }
+
+    iterator end()
+    {
+        return data() + m_size;
+    }
+
+    const_iterator end() const
+    {
+        return data() + m_size;
+    }
+
+    T* data()
+    {
+        return reinterpret_cast<T*>(m_storage);
+    }
+
+    const T* data() const
+    {
+        return reinterpret_cast<const T*>(m_storage);
+    }
+
+    T& operator[](size_type i)
+    {
+        return data()[i];
+    }
+
+    const T& operator[](size_type i) const
+    {
+        return data()[i];
+    }
+
+    T& front()
+    {
+        return data()[0];
+    }
+
+    const T& front() const
+    {
+        return data()[0];
+    }
+
+    T& back()
+    {
+        return data()[m_size - 1];
+    }
+
+    const T& back() const
+    {
+        return data()[m_size - 1];
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    bool full() const
+    {
+        return m_size == N;
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+
+    static constexpr size_type capacity()
+    {
+        return N;
+    }
+
+    // Throws std::length_error if it's full.
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        CheckCapacity(m_size + 1);
+        std::construct_at(data() + m_size, std::forward<Args>(args)...);
+        return data()[m_size++];
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back()
+    {
+        std::destroy_at(data() + --m_size);
+    }
+
+    // Moves the elements after the erased one back.
+    iterator erase(const_iterator position)
+    {
+        T* erased = data() + (position - data());
+        std::move(erased + 1, end(), erased);
+        pop_back();
+        return erased;
+    }
+
+    void resize(size_type count)
+    {
+        CheckCapacity(count);
+        if (count < m_size)
+        {
+            std::destroy(begin() + count, end());
+            m_size = count;
+        }
+        for (; m_size < count; ++m_size)
+        {
+            std::construct_at(data() + m_size);
+        }
+    }
+
+    void clear()
+    {
+        std::destroy(begin(), end());
+        m_size = 0;
+    }
+
+private:
+    static void CheckCapacity(size_type count)
+    {
+        if (count > N)
+        {
+            throw std::length_error("StaticVector: capacity exceeded");
+        }
+    }
+
+    size_type m_size = 0;
+    alignas(T) std::byte m_storage[N * sizeof(T)];
+};
+
+namespace pmr
+{
+    template<typename T, std::size_t N>
+    using SmallVector = ::SmallVector<T, N, std::pmr::polymorphic_allocator<T>>;
+}
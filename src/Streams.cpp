@@ -98,6 +98,68 @@ void StringStreams()
     printf("\n");
 }
 
+// ------------------------------------
+// Char Conversions (<charconv>)
+// 
+// std::from_chars and std::to_chars convert numbers from and to text, without streams.
+// They are locale-free, don't allocate nor throw, and are much faster than streams
+// (operator>> and operator<<), which go through the locale and virtual calls for each number.
+// 
+// See CharConv.h for parsing a whole buffer of numbers and for writing them buffered.
+// ------------------------------------
+
+#include <charconv>
+#include <vector>
+#include "CharConv.h"
+
+void CharConversions()
+{
+    // Single numbers
+    const char text[] = "123 456.5";
+    int a = 0;
+    const auto [aEnd, aError] = std::from_chars(text, text + 3, a);
+    double b = 0.0;
+    const auto [bEnd, bError] = std::from_chars(text + 4, text + sizeof(text) - 1, b);
+    printf("a: %d b: %0.1f (errors %d %d)\n", a, b, static_cast<int>(aError), static_cast<int>(bError));
+
+    char outString[32];
+    const auto [outEnd, outError] = std::to_chars(outString, outString + sizeof(outString), 0.1f); // Shortest text that reads back the same float
+    printf("0.1f: %.*s\n", static_cast<int>(outEnd - outString), outString);
+
+    // All the numbers of a buffer in one call
+    std::vector<int> numbers;
+    const bool parsed = ParseNumbers("1 22 333\n4444 123456789 -42\n", numbers);
+    printf("Parsed %zu numbers (%s):", numbers.size(), parsed ? "OK" : "Invalid");
+    for (int number : numbers)
+    {
+        printf(" %d", number);
+    }
+    printf("\n");
+
+    // Stops at the invalid token
+    NumberTokenizer tokenizer("1.5 2.5 abc 3.5");
+    float value;
+    while (tokenizer.Next(value))
+    {
+        printf("%0.1f ", value);
+    }
+    printf("stopped at \"%s\"\n", tokenizer.GetPosition());
+
+    // Writing numbers buffered, the stream is written once
+    {
+        std::ostringstream outStream;
+        {
+            BufferedWriter writer(outStream);
+            writer.Write(std::string_view("Numbers: "));
+            writer.WriteNumbers(numbers, ' ');
+            writer.Write(0.1);
+        } // Flushed when destroyed
+        std::cout << outStream.str() << std::endl;
+    }
+
+    printf("\n");
+}
+
 // ------------------------------------
 // File Stream Classes (<fstream>)
 // 
@@ -113,3 +175,145 @@ void StringStreams()
 // 
 // See Files.cpp
 // ------------------------------------
+
+// ------------------------------------
+// Benchmarks (run by bench executable)
+// ------------------------------------
+
+#include <random>
+#include <string>
+#include <algorithm>
+#include "Benchmark.h"
+
+// Parses and writes 4M ints and 4M floats with streams and with charconv.
+// Streams write floats with 6 digits by default, charconv writes the shortest
+// text that reads back the same float, which is longer for most floats.
+void BenchmarkStreams()
+{
+    std::printf("Streams numbers (4M ints, 4M floats)\n");
+
+    const std::size_t count = std::size_t(4) << 20;
+
+    std::mt19937 randomEngine(42);
+    std::uniform_int_distribution<int> randomInt(-1000000000, 1000000000);
+    std::uniform_real_distribution<float> randomFloat(-1000.0f, 1000.0f);
+
+    std::vector<int> ints(count);
+    std::vector<float> floats(count);
+    std::ranges::generate(ints, [&]() { return randomInt(randomEngine); });
+    std::ranges::generate(floats, [&]() { return randomFloat(randomEngine); });
+
+    std::string intsText;
+    std::string floatsText;
+    {
+        std::ostringstream outStream;
+        BufferedWriter(outStream).WriteNumbers(ints, ' ');
+        intsText = outStream.str();
+    }
+    {
+        std::ostringstream outStream;
+        BufferedWriter(outStream).WriteNumbers(floats, ' ');
+        floatsText = outStream.str();
+    }
+
+    auto benchmark = [](const char* name, std::size_t byteCount, auto function)
+    {
+        std::size_t result = 0;
+        const double time = MeasureBestMilliseconds(3, [&]() { result = function(); });
+        DoNotOptimize(result);
+        PrintThroughput(name, time, count, byteCount);
+    };
+
+    benchmark("Parse ints (std::istringstream)", intsText.size(), [&]()
+        {
+            std::istringstream inStream(intsText);
+            std::vector<int> numbers;
+            int number;
+            while (inStream >> number)
+            {
+                numbers.push_back(number);
+            }
+            return numbers.size();
+        });
+
+    benchmark("Parse ints (std::from_chars)", intsText.size(), [&]()
+        {
+            std::vector<int> numbers;
+            const char* position = intsText.data();
+            const char* end = intsText.data() + intsText.size();
+            while (position != end)
+            {
+                int number;
+                const auto [ptr, error] = std::from_chars(position, end, number);
+                if (error != std::errc())
+                {
+                    break;
+                }
+                numbers.push_back(number);
+                position = (ptr != end) ? ptr + 1 : ptr;
+            }
+            return numbers.size();
+        });
+
+    benchmark("Parse ints (ParseNumbers, SWAR)", intsText.size(), [&]()
+        {
+            std::vector<int> numbers;
+            ParseNumbers(intsText, numbers);
+            return numbers.size();
+        });
+
+    benchmark("Parse floats (std::istringstream)", floatsText.size(), [&]()
+        {
+            std::istringstream inStream(floatsText);
+            std::vector<float> numbers;
+            float number;
+            while (inStream >> number)
+            {
+                numbers.push_back(number);
+            }
+            return numbers.size();
+        });
+
+    benchmark("Parse floats (ParseNumbers)", floatsText.size(), [&]()
+        {
+            std::vector<float> numbers;
+            ParseNumbers(floatsText, numbers);
+            return numbers.size();
+        });
+
+    benchmark("Write ints (std::ostringstream)", intsText.size(), [&]()
+        {
+            std::ostringstream outStream;
+            for (int number : ints)
+            {
+                outStream << number << ' ';
+            }
+            return outStream.str().size();
+        });
+
+    benchmark("Write ints (BufferedWriter)", intsText.size(), [&]()
+        {
+            std::ostringstream outStream;
+            BufferedWriter(outStream).WriteNumbers(ints, ' ');
+            return outStream.str().size();
+        });
+
+    benchmark("Write floats (std::ostringstream)", floatsText.size(), [&]()
+        {
+            std::ostringstream outStream;
+            for (float number : floats)
+            {
+                outStream << number << ' ';
+            }
+            return outStream.str().size();
+        });
+
+    benchmark("Write floats (BufferedWriter)", floatsText.size(), [&]()
+        {
+            std::ostringstream outStream;
+            BufferedWriter(outStream).WriteNumbers(floats, ' ');
+            return outStream.str().size();
+        });
+
+    std::printf("\n");
+}
@@ -0,0 +1,546 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <optional>
+#include <mutex>
+#include <condition_variable>
+#include <iterator>
+#include <ranges>
+#include <memory>
+#include <type_traits>
+#include <concepts>
+#include <cstddef>
+
+#include "ThreadPool.h"
+
+// --------------------------------------------------------------------------------
+// Coroutine types
+//
+// Task<T>: coroutine that computes a value of type T asynchronously. It's lazy, it starts
+// when it's awaited with co_await, and the awaiting coroutine is resumed when it finishes
+// (its continuation). Exceptions are rethrown in the awaiting coroutine.
+//
+// Generator<T>: coroutine that produces a sequence of values with co_yield, used as a range.
+//
+// ScheduleOn(threadPool): co_await it to continue the coroutine in a worker of the pool.
+//
+// SyncWait(task): starts the task and blocks the calling thread until it finishes,
+// to get the result of tasks from code that is not a coroutine (main, for example).
+//
+// Tasks use symmetric transfer: await_suspend returns the handle of the next coroutine to
+// resume, and the compiler resumes it as a tail call. Without it, each coroutine would resume
+// the next one with a normal call, and long chains of tasks could overflow the stack.
+//
+// https://lewissbaker.github.io/2020/05/11/understanding_symmetric_transfer
+// --------------------------------------------------------------------------------
+
+template<typename T = void>
+class Task;
+
+namespace TaskDetail
+{
+    // When the task finishes, it resumes the coroutine that awaited it.
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            if (std::coroutine_handle<> continuation = handle.promise().m_continuation)
+            {
+                return continuation;
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    struct PromiseBase
+    {
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        FinalAwaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        // Stored to be rethrown in the awaiting coroutine.
+        void unhandled_exception() noexcept
+        {
+            m_exception = std::current_exception();
+        }
+
+        void RethrowIfException()
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+        }
+
+        std::coroutine_handle<> m_continuation;
+        std::exception_ptr m_exception;
+    };
+
+    template<typename T>
+    struct Promise : PromiseBase
+    {
+        Task<T> get_return_object() noexcept;
+
+        template<typename U>
+            requires std::convertible_to<U&&, T>
+        void return_value(U&& value)
+        {
+            m_value.emplace(std::forward<U>(value));
+        }
+
+        T GetResult()
+        {
+            RethrowIfException();
+            return std::move(*m_value);
+        }
+
+        std::optional<T> m_value;
+    };
+
+    template<>
+    struct Promise<void> : PromiseBase
+    {
+        Task<void> get_return_object() noexcept;
+
+        void return_void() noexcept
+        {
+        }
+
+        void GetResult()
+        {
+            RethrowIfException();
+        }
+    };
+}
+
+template<typename T>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = TaskDetail::Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+
+    explicit Task(Handle handle)
+        : m_handle(handle)
+    {
+    }
+
+    // Only one object owns the coroutine, so it's destroyed once.
+    Task(Task&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, {}))
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        Destroy();
+    }
+
+    bool IsValid() const
+    {
+        return static_cast<bool>(m_handle);
+    }
+
+    bool IsDone() const
+    {
+        return m_handle && m_handle.done();
+    }
+
+    // Starts the task and suspends the awaiting coroutine until it finishes.
+    // The result is the value given by co_return in the task.
+    auto operator co_await() const noexcept
+    {
+        struct Awaiter
+        {
+            bool await_ready() const noexcept
+            {
+                return m_handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaitingHandle) noexcept
+            {
+                m_handle.promise().m_continuation = awaitingHandle;
+                return m_handle; // Symmetric transfer to start the task
+            }
+
+            T await_resume()
+            {
+                return m_handle.promise().GetResult();
+            }
+
+            Handle m_handle;
+        };
+        return Awaiter{ m_handle };
+    }
+
+private:
+    void Destroy()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+            m_handle = {};
+        }
+    }
+
+    Handle m_handle;
+};
+
+template<typename T>
+Task<T> TaskDetail::Promise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskDetail::Promise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+// Suspends the coroutine and resumes it in a worker of the thread pool.
+// Code after 'co_await ScheduleOn(threadPool);' runs in the worker.
+inline auto ScheduleOn(ThreadPool& threadPool)
+{
+    struct Awaiter
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_threadPool.Execute([handle]() { handle.resume(); });
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+
+        ThreadPool& m_threadPool;
+    };
+    return Awaiter{ threadPool };
+}
+
+namespace TaskDetail
+{
+    // Signal from the coroutine that SyncWait waits for.
+    // Notifying while holding the lock makes sure the waiting thread doesn't
+    // return (destroying the event) while the notify is still in progress.
+    class SyncWaitEvent
+    {
+    public:
+        void Set()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isSet = true;
+            m_conditionVariable.notify_one();
+        }
+
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_conditionVariable.wait(lock, [this]() { return m_isSet; });
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_conditionVariable;
+        bool m_isSet = false;
+    };
+
+    // Coroutine used by SyncWait to await the task, it sets the event when it finishes.
+    class SyncWaitCoroutine
+    {
+    public:
+        struct promise_type
+        {
+            SyncWaitCoroutine get_return_object() noexcept
+            {
+                return SyncWaitCoroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            auto final_suspend() const noexcept
+            {
+                struct SetEventAwaiter
+                {
+                    bool await_ready() const noexcept
+                    {
+                        return false;
+                    }
+
+                    void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+                    {
+                        handle.promise().m_event->Set();
+                    }
+
+                    void await_resume() const noexcept
+                    {
+                    }
+                };
+                return SetEventAwaiter{};
+            }
+
+            void return_void() noexcept
+            {
+            }
+
+            // Task exceptions are caught in the coroutine body.
+            void unhandled_exception() noexcept
+            {
+                std::terminate();
+            }
+
+            SyncWaitEvent* m_event = nullptr;
+        };
+
+        explicit SyncWaitCoroutine(std::coroutine_handle<promise_type> handle)
+            : m_handle(handle)
+        {
+        }
+
+        SyncWaitCoroutine(const SyncWaitCoroutine&) = delete;
+        SyncWaitCoroutine& operator=(const SyncWaitCoroutine&) = delete;
+
+        ~SyncWaitCoroutine()
+        {
+            m_handle.destroy();
+        }
+
+        void StartAndWait()
+        {
+            SyncWaitEvent event;
+            m_handle.promise().m_event = &event;
+            m_handle.resume();
+            event.Wait();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+    };
+}
+
+// Starts the task and waits until it finishes, returning its result.
+// The task might finish in another thread if it's scheduled in a thread pool.
+template<typename T>
+T SyncWait(Task<T> task)
+{
+    std::optional<std::conditional_t<std::is_void_v<T>, int, T>> result;
+    std::exception_ptr exception;
+
+    auto awaitTask = [](Task<T>& task, auto& result, std::exception_ptr& exception) -> TaskDetail::SyncWaitCoroutine
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await task;
+                    result.emplace(0);
+                }
+                else
+                {
+                    result.emplace(co_await task);
+                }
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+        };
+
+    awaitTask(task, result, exception).StartAndWait();
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+
+    if constexpr (!std::is_void_v<T>)
+    {
+        return std::move(*result);
+    }
+}
+
+template<typename T>
+class [[nodiscard]] Generator : public std::ranges::view_interface<Generator<T>>
+{
+public:
+    struct promise_type
+    {
+        Generator get_return_object() noexcept
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_always final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        // The yielded value lives until the coroutine is resumed, so a pointer is enough.
+        std::suspend_always yield_value(const T& value) noexcept
+        {
+            m_value = std::addressof(value);
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        // Rethrown when the iterator resumes the generator.
+        void unhandled_exception() noexcept
+        {
+            m_exception = std::current_exception();
+        }
+
+        // Generators can't use co_await.
+        template<typename U>
+        std::suspend_never await_transform(U&&) = delete;
+
+        const T* m_value = nullptr;
+        std::exception_ptr m_exception;
+    };
+
+    // Input iterator, it can only go through the values once.
+    class Iterator
+    {
+    public:
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(std::coroutine_handle<promise_type> handle)
+            : m_handle(handle)
+        {
+        }
+
+        const T& operator*() const
+        {
+            return *m_handle.promise().m_value;
+        }
+
+        Iterator& operator++()
+        {
+            Resume(m_handle);
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return !m_handle || m_handle.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    Generator() = default;
+
+    explicit Generator(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    Generator(Generator&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, {}))
+    {
+    }
+
+    Generator& operator=(Generator&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+
+    ~Generator()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    // Runs the generator until its first value.
+    Iterator begin()
+    {
+        if (m_handle)
+        {
+            Resume(m_handle);
+        }
+        return Iterator(m_handle);
+    }
+
+    std::default_sentinel_t end() const noexcept
+    {
+        return std::default_sentinel;
+    }
+
+private:
+    static void Resume(std::coroutine_handle<promise_type> handle)
+    {
+        handle.resume();
+        if (handle.done() && handle.promise().m_exception)
+        {
+            std::rethrow_exception(handle.promise().m_exception);
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
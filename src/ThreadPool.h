@@ -0,0 +1,514 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "Instrumentation.h"
+
+// --------------------------------------------------------------------------------
+// Thread Pool
+//
+// Creating a thread is expensive (system call, stack allocation), so instead of creating
+// threads for each piece of work, a thread pool creates its worker threads once and
+// reuses them to execute tasks.
+//
+// This pool is work-stealing: each worker has its own deque of tasks. Tasks created
+// from a worker go to its own deque, where the worker takes them from the back (LIFO,
+// the most recent tasks have their data still in cache). Workers without tasks steal
+// from the front of the other workers' deques (FIFO, the oldest tasks, which tend to be
+// the biggest). Tasks submitted from threads outside the pool go to a shared injector queue.
+//
+// Workers without tasks sleep using std::atomic::wait, and they are woken up with
+// std::atomic::notify_one when new tasks are added.
+// --------------------------------------------------------------------------------
+
+// Chase-Lev deque: lock-free deque where only the owner thread pushes and pops
+// from the back, while any other thread can steal from the front.
+//
+// Owner operations are almost always a plain load and store. Only when there is one
+// element left the owner and the thieves race with a compare and exchange on the front.
+//
+// The array grows when full. Old arrays are kept until the deque is destroyed, since
+// thieves might still be reading from them.
+//
+// Chase, Lev. Dynamic Circular Work-Stealing Deque (2005).
+// Le, Pop, Cohen, Zappa Nardelli. Correct and Efficient Work-Stealing for Weak Memory Models (2013).
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+class WorkStealingDeque
+{
+public:
+    // Capacity must be a power of 2.
+    explicit WorkStealingDeque(std::int64_t capacity = 256)
+    {
+        m_arrays.push_back(std::make_unique<Array>(capacity));
+        m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Only called by the owner thread.
+    void Push(T item)
+    {
+        const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t top = m_top.load(std::memory_order_acquire);
+        Array* array = m_array.load(std::memory_order_relaxed);
+
+        if (bottom - top >= array->m_capacity)
+        {
+            array = Grow(array, top, bottom);
+        }
+
+        // Release so thieves that see the new bottom also see the item (and what it points to).
+        array->Put(bottom, item);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Only called by the owner thread.
+    std::optional<T> Pop()
+    {
+        const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array* array = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // Empty
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        T item = array->Get(bottom);
+        if (top == bottom)
+        {
+            // Last element, thieves might be trying to steal it too.
+            const bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            if (!won)
+            {
+                return std::nullopt;
+            }
+        }
+        return item;
+    }
+
+    // Called by any thread.
+    std::optional<T> Steal()
+    {
+        std::int64_t top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return std::nullopt;
+        }
+
+        Array* array = m_array.load(std::memory_order_acquire);
+        T item = array->Get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            // Another thief or the owner took it first.
+            return std::nullopt;
+        }
+        return item;
+    }
+
+    bool IsEmpty() const
+    {
+        return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Circular array, indices grow forever and they are wrapped with the mask.
+    struct Array
+    {
+        explicit Array(std::int64_t capacity)
+            : m_capacity(capacity)
+            , m_mask(capacity - 1)
+            , m_items(std::make_unique<std::atomic<T>[]>(capacity))
+        {
+        }
+
+        T Get(std::int64_t i) const
+        {
+            return m_items[i & m_mask].load(std::memory_order_relaxed);
+        }
+
+        void Put(std::int64_t i, T item)
+        {
+            m_items[i & m_mask].store(item, std::memory_order_relaxed);
+        }
+
+        std::int64_t m_capacity;
+        std::int64_t m_mask;
+        std::unique_ptr<std::atomic<T>[]> m_items;
+    };
+
+    Array* Grow(Array* array, std::int64_t top, std::int64_t bottom)
+    {
+        m_arrays.push_back(std::make_unique<Array>(2 * array->m_capacity));
+        Array* newArray = m_arrays.back().get();
+
+        for (std::int64_t i = top; i < bottom; ++i)
+        {
+            newArray->Put(i, array->Get(i));
+        }
+
+        m_array.store(newArray, std::memory_order_release);
+        return newArray;
+    }
+
+    // Front and back in different cache lines, as they are written by different threads.
+    alignas(64) std::atomic<std::int64_t> m_top = 0;
+    alignas(64) std::atomic<std::int64_t> m_bottom = 0;
+    std::atomic<Array*> m_array = nullptr;
+    std::vector<std::unique_ptr<Array>> m_arrays; // Only accessed by the owner
+};
+
+class ThreadPool
+{
+public:
+    // Number of workers, 0 to create one per hardware thread.
+    explicit ThreadPool(int workerCount = 0)
+    {
+        if (workerCount <= 0)
+        {
+            workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+
+        m_workers.reserve(workerCount);
+        for (int i = 0; i < workerCount; ++i)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+
+        // Threads are started once all the workers exist, as they steal from each other.
+        for (int i = 0; i < workerCount; ++i)
+        {
+            m_workers[i]->m_thread = std::thread(&ThreadPool::WorkerMain, this, i);
+        }
+    }
+
+    // Waits for all the tasks to finish before destroying the workers.
+    ~ThreadPool()
+    {
+        m_isStopping.store(true, std::memory_order_seq_cst);
+        m_wakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+        m_wakeEpoch.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker->m_thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Pool shared by the whole program, created the first time it's used.
+    static ThreadPool& GetDefault()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    int GetWorkerCount() const
+    {
+        return static_cast<int>(m_workers.size());
+    }
+
+    // Index of this pool's worker running the calling thread, -1 if it's not one of its workers.
+    int GetCurrentWorkerIndex() const
+    {
+        return (t_workerPool == this) ? t_workerIndex : -1;
+    }
+
+    // Executes the function in the pool, returning a future with its result.
+    // Exceptions thrown by the function are given by the future.
+    template<typename Function>
+    std::future<std::invoke_result_t<std::decay_t<Function>>> Submit(Function&& function)
+    {
+        using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+        std::packaged_task<Result()> packagedTask(std::forward<Function>(function));
+        std::future<Result> future = packagedTask.get_future();
+
+        Schedule(new Task<std::packaged_task<Result()>>(std::move(packagedTask)));
+        WakeWorker();
+        return future;
+    }
+
+    // Executes the function in the pool without a way to know when it finishes.
+    // Cheaper than Submit as it doesn't need the shared state of a future.
+    // The function must not throw.
+    template<typename Function>
+    void Execute(Function&& function)
+    {
+        Schedule(new Task<std::decay_t<Function>>(std::forward<Function>(function)));
+        WakeWorker();
+    }
+
+    // Calls function(first, last) for consecutive chunks of the range [begin, end),
+    // in parallel and returning once all chunks are done. The calling thread also
+    // executes chunks while waiting, so it can be called from inside a task.
+    // Chunks are taken one at a time, so it balances chunks with different costs.
+    // Grain size is the number of indices per chunk, 0 to choose one that creates
+    // several chunks per worker. The function must not throw.
+    template<typename Function>
+    void ParallelForRange(std::size_t begin, std::size_t end, Function&& function, std::size_t grainSize = 0)
+    {
+        INSTRUMENT_ZONE("ThreadPool::ParallelForRange");
+
+        if (begin >= end)
+        {
+            return;
+        }
+
+        const std::size_t count = end - begin;
+        if (grainSize == 0)
+        {
+            grainSize = std::max<std::size_t>(1, count / (4 * m_workers.size()));
+        }
+
+        const std::size_t chunkCount = (count + grainSize - 1) / grainSize;
+        if (chunkCount == 1)
+        {
+            function(begin, end);
+            return;
+        }
+
+        // Shared with the helper tasks, which might start after all the chunks are done.
+        // Those only check that there are no chunks left, without calling the function.
+        struct ParallelForState
+        {
+            std::atomic<std::size_t> m_nextChunk = 0;
+            std::atomic<std::size_t> m_finishedChunks = 0;
+        };
+        auto state = std::make_shared<ParallelForState>();
+
+        auto runChunks = [state, begin, end, grainSize, chunkCount, &function]()
+        {
+            for (std::size_t chunk = state->m_nextChunk.fetch_add(1, std::memory_order_relaxed);
+                chunk < chunkCount;
+                chunk = state->m_nextChunk.fetch_add(1, std::memory_order_relaxed))
+            {
+                const std::size_t first = begin + chunk * grainSize;
+                function(first, std::min(first + grainSize, end));
+
+                if (state->m_finishedChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == chunkCount)
+                {
+                    state->m_finishedChunks.notify_all();
+                }
+            }
+        };
+
+        const std::size_t helperCount = std::min(m_workers.size(), chunkCount - 1);
+        for (std::size_t i = 0; i < helperCount; ++i)
+        {
+            Schedule(new Task<decltype(runChunks)>(runChunks));
+        }
+        WakeAllWorkers();
+
+        runChunks();
+
+        // Chunks still running are being executed by other threads, just wait for them.
+        for (std::size_t finishedChunks = state->m_finishedChunks.load(std::memory_order_acquire);
+            finishedChunks != chunkCount;
+            finishedChunks = state->m_finishedChunks.load(std::memory_order_acquire))
+        {
+            state->m_finishedChunks.wait(finishedChunks, std::memory_order_acquire);
+        }
+    }
+
+    // Calls function(i) for each index of the range [begin, end) in parallel.
+    // See ParallelForRange.
+    template<typename Function>
+    void ParallelFor(std::size_t begin, std::size_t end, Function&& function, std::size_t grainSize = 0)
+    {
+        ParallelForRange(begin, end,
+            [&function](std::size_t first, std::size_t last)
+            {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    function(i);
+                }
+            },
+            grainSize);
+    }
+
+private:
+    struct TaskBase
+    {
+        virtual ~TaskBase() = default;
+        virtual void Run() = 0;
+    };
+
+    // Unlike std::function, it supports move-only functions like std::packaged_task.
+    template<typename Function>
+    struct Task : TaskBase
+    {
+        explicit Task(Function function)
+            : m_function(std::move(function))
+        {
+        }
+
+        void Run() override
+        {
+            m_function();
+        }
+
+        Function m_function;
+    };
+
+    struct Worker
+    {
+        WorkStealingDeque<TaskBase*> m_deque;
+        std::thread m_thread;
+    };
+
+    void Schedule(TaskBase* task)
+    {
+        if (const int workerIndex = GetCurrentWorkerIndex();
+            workerIndex >= 0)
+        {
+            m_workers[workerIndex]->m_deque.Push(task);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_injectorMutex);
+            m_injector.push_back(task);
+            m_injectorSize.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Sleeping workers increment the sleeping count before checking for tasks a last time,
+    // and the seq_cst fence makes sure that either they see the new task or this sees them.
+    void WakeWorker()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepingCount.load(std::memory_order_seq_cst) > 0)
+        {
+            m_wakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+            m_wakeEpoch.notify_one();
+        }
+    }
+
+    void WakeAllWorkers()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepingCount.load(std::memory_order_seq_cst) > 0)
+        {
+            m_wakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+            m_wakeEpoch.notify_all();
+        }
+    }
+
+    // Own deque first, then tasks from outside the pool, then stealing from other workers.
+    TaskBase* FindTask(int workerIndex)
+    {
+        if (std::optional<TaskBase*> task = m_workers[workerIndex]->m_deque.Pop())
+        {
+            return *task;
+        }
+
+        if (m_injectorSize.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_injectorMutex);
+            if (!m_injector.empty())
+            {
+                TaskBase* task = m_injector.front();
+                m_injector.pop_front();
+                m_injectorSize.fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+
+        const int workerCount = GetWorkerCount();
+        for (int i = 1; i < workerCount; ++i)
+        {
+            const int victimIndex = (workerIndex + i) % workerCount;
+            if (std::optional<TaskBase*> task = m_workers[victimIndex]->m_deque.Steal())
+            {
+                return *task;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void RunTask(TaskBase* task)
+    {
+        INSTRUMENT_ZONE("ThreadPool task");
+
+        task->Run();
+        delete task;
+    }
+
+    void WorkerMain(int workerIndex)
+    {
+        t_workerPool = this;
+        t_workerIndex = workerIndex;
+
+        while (true)
+        {
+            if (TaskBase* task = FindTask(workerIndex))
+            {
+                RunTask(task);
+                continue;
+            }
+
+            // Announce going to sleep and check for tasks a last time.
+            // A new task after reading the epoch changes it, so the wait won't block.
+            m_sleepingCount.fetch_add(1, std::memory_order_seq_cst);
+            const std::uint32_t wakeEpoch = m_wakeEpoch.load(std::memory_order_seq_cst);
+
+            if (TaskBase* task = FindTask(workerIndex))
+            {
+                m_sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+                RunTask(task);
+                continue;
+            }
+
+            // Only stops when there are no tasks left.
+            if (m_isStopping.load(std::memory_order_seq_cst))
+            {
+                m_sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+                break;
+            }
+
+            m_wakeEpoch.wait(wakeEpoch, std::memory_order_seq_cst);
+            m_sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        t_workerPool = nullptr;
+        t_workerIndex = -1;
+    }
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_injectorMutex;
+    std::deque<TaskBase*> m_injector;
+    std::atomic<std::size_t> m_injectorSize = 0; // To check if it's empty without locking
+
+    alignas(64) std::atomic<std::uint32_t> m_wakeEpoch = 0;
+    std::atomic<int> m_sleepingCount = 0;
+    std::atomic<bool> m_isStopping = false;
+
+    inline static thread_local const ThreadPool* t_workerPool = nullptr;
+    inline static thread_local int t_workerIndex = -1;
+};
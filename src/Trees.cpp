@@ -1,7 +1,23 @@
 #include <vector>
-#include <stack>
-#include <queue>
 #include <ranges>
+#include <algorithm>
+#include <numeric>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <span>
+#include <set>
+#include <bit>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#include "SmallVector.h"
+#include "MemoryResources.h"
+#include "Benchmark.h"
+#include "Instrumentation.h"
 
 // --------------------------------------------------------------------------------
 // Tree
@@ -12,24 +28,55 @@
 // - Depth: steps from node to root node. Depth of root node is 0.
 // - Height: steps from node to its further leaf node. Height of a leaf node is 0.
 // - Height of Tree: height of its root node.
+// 
+// Nodes can be allocated from a memory resource (arena) instead of with new/delete.
+// Nodes of an arena are never deleted one by one, the whole tree is freed at once
+// when the arena is released or destroyed, which is O(1) instead of visiting every node.
+// With std::pmr::monotonic_buffer_resource the nodes are carved from big contiguous blocks,
+// which avoids heap fragmentation and keeps them close in memory when traversing.
 // --------------------------------------------------------------------------------
 
-struct Node
+// The list of children can be any vector-like container of node pointers that is constructed
+// with a std::pmr::memory_resource. BasicNode<std::pmr::vector> (Node) allocates the list of
+// children of each node, while BasicNode<SmallChildList> (SmallNode) keeps up to 4 children
+// inside the node, so nodes with few children never allocate their list.
+template<template<typename> typename ChildList>
+struct BasicNode
 {
-    Node() = default;
-    Node(int data, Node* parent = nullptr)
+    BasicNode() = default;
+    BasicNode(int data, BasicNode* parent = nullptr, std::pmr::memory_resource* arena = nullptr)
         : m_nodeData(data)
         , m_parent(parent)
+        , m_arena(arena)
+        , m_children(arena ? arena : std::pmr::get_default_resource())
+    {
+    }
+    ~BasicNode()
     {
+        // Nodes of an arena are freed with the arena
+        if (!m_arena)
+        {
+            std::ranges::for_each(m_children, [](BasicNode* child) { delete child; });
+        }
     }
-    ~Node()
+
+    // Creates a node with new, or from the arena if not null.
+    // Nodes from an arena must not be deleted.
+    static BasicNode* Create(int data, BasicNode* parent = nullptr, std::pmr::memory_resource* arena = nullptr)
     {
-        std::ranges::for_each(m_children, [](Node* child) { delete child; });
+        if (!arena)
+        {
+            return new BasicNode(data, parent);
+        }
+
+        void* memory = arena->allocate(sizeof(BasicNode), alignof(BasicNode));
+        return new (memory) BasicNode(data, parent, arena);
     }
 
-    Node* AddChild(int childData)
+    // Child is allocated the same way as this node.
+    BasicNode* AddChild(int childData)
     {
-        m_children.push_back(new Node(childData, this));
+        m_children.push_back(Create(childData, this, m_arena));
         return m_children.back();
     }
 
@@ -45,83 +92,417 @@ struct Node
 
     int m_nodeData = 0;
 
-    Node* m_parent = nullptr;
-    std::vector<Node*> m_children;
+    BasicNode* m_parent = nullptr;
+    std::pmr::memory_resource* m_arena = nullptr; // Null when allocated with new
+    ChildList<BasicNode*> m_children; // Also allocated from the arena
 };
 
-void TraversePreOrder(const Node* node)
+template<typename T>
+using SmallChildList = pmr::SmallVector<T, 4>;
+
+using Node = BasicNode<std::pmr::vector>;
+using SmallNode = BasicNode<SmallChildList>;
+
+// --------------------------------------------------------------------------------
+// Tree Traversal Views
+// 
+// Lazy ranges over the data of the nodes in the traversal order. Nothing is visited
+// until iterating, so the traversal can stop at any moment (break or std::views::take)
+// and it can be composed with other views (see Cxx20Ranges.cpp).
+// 
+// Pre order, in order and post order views use the parent pointers of the nodes to go
+// back up, so they don't need recursion nor a stack, and iterating allocates no memory.
+// Breadth first view needs a queue, which is given by the caller to reuse its memory.
+// 
+// Views work with any node type that has TreeTraits, which tell how to access the children
+// of a node and which children are visited before the node in an in order traversal.
+// --------------------------------------------------------------------------------
+
+template<typename NodeType>
+struct TreeTraits;
+
+// Nodes with a list of children.
+// In order traversal visits the first half of the children before the node.
+template<template<typename> typename ChildList>
+struct TreeTraits<BasicNode<ChildList>>
 {
-    if (!node)
+    using Node = BasicNode<ChildList>;
+
+    static const Node* GetParent(const Node* node)
     {
-        return;
+        return node->m_parent;
     }
 
-    std::printf("%d ", node->m_nodeData);
+    static int GetChildCount(const Node* node)
+    {
+        return static_cast<int>(node->m_children.size());
+    }
 
-    std::ranges::for_each(node->m_children, [](const Node* child) { TraversePreOrder(child); });
-}
+    static const Node* GetChild(const Node* node, int i)
+    {
+        return node->m_children[i];
+    }
 
-void TraverseInOrder(const Node* node)
+    // O(d), where d is the number of children of the parent.
+    static int GetChildIndex(const Node* parent, const Node* child)
+    {
+        return static_cast<int>(std::ranges::find(parent->m_children, child) - parent->m_children.begin());
+    }
+
+    static int GetChildCountBeforeNode(const Node* node)
+    {
+        return GetChildCount(node) / 2;
+    }
+};
+
+// Binary nodes: left child (if any) is child 0, followed by right child (if any).
+// In order traversal visits the left child before the node.
+template<typename NodeType>
+    requires requires(const NodeType* node) { node->m_left; node->m_right; node->m_parent; }
+struct TreeTraits<NodeType>
 {
-    if (!node)
+    static const NodeType* GetParent(const NodeType* node)
     {
-        return;
+        return node->m_parent;
     }
 
-    int half = node->m_children.size() / 2;
+    static int GetChildCount(const NodeType* node)
+    {
+        return (node->m_left != nullptr) + (node->m_right != nullptr);
+    }
 
-    std::ranges::for_each(node->m_children | std::views::take(half), [](const Node* child) { TraverseInOrder(child); });
+    static const NodeType* GetChild(const NodeType* node, int i)
+    {
+        return (i == 0 && node->m_left) ? node->m_left : node->m_right;
+    }
 
-    std::printf("%d ", node->m_nodeData);
+    static int GetChildIndex(const NodeType* parent, const NodeType* child)
+    {
+        return (child == parent->m_left) ? 0 : GetChildCountBeforeNode(parent);
+    }
 
-    std::ranges::for_each(node->m_children | std::views::drop(half), [](const Node* child) { TraverseInOrder(child); });
-}
+    static int GetChildCountBeforeNode(const NodeType* node)
+    {
+        return (node->m_left != nullptr);
+    }
+};
 
-void TraversePostOrder(const Node* node)
+enum class TraversalOrder
 {
-    if (!node)
+    PreOrder,
+    InOrder,
+    PostOrder
+};
+
+template<typename NodeType, TraversalOrder Order>
+class TreeTraversalView : public std::ranges::view_interface<TreeTraversalView<NodeType, Order>>
+{
+    using Traits = TreeTraits<NodeType>;
+
+public:
+    class Iterator
+    {
+    public:
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        Iterator(const NodeType* root)
+            : m_root(root)
+            , m_node(root ? First(root) : nullptr)
+        {
+        }
+
+        int operator*() const
+        {
+            return m_node->m_nodeData;
+        }
+
+        // Node of the current data.
+        const NodeType* GetNode() const
+        {
+            return m_node;
+        }
+
+        Iterator& operator++()
+        {
+            m_node = Next(m_node);
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator it = *this;
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const Iterator& other) const
+        {
+            return m_node == other.m_node;
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return m_node == nullptr;
+        }
+
+    private:
+        // First node to visit in the subtree.
+        static const NodeType* First(const NodeType* node)
+        {
+            if constexpr (Order == TraversalOrder::InOrder)
+            {
+                while (Traits::GetChildCountBeforeNode(node) > 0)
+                {
+                    node = Traits::GetChild(node, 0);
+                }
+            }
+            else if constexpr (Order == TraversalOrder::PostOrder)
+            {
+                while (Traits::GetChildCount(node) > 0)
+                {
+                    node = Traits::GetChild(node, 0);
+                }
+            }
+            return node;
+        }
+
+        // Node to visit after the node, null when the traversal has finished.
+        const NodeType* Next(const NodeType* node) const
+        {
+            if constexpr (Order == TraversalOrder::PreOrder)
+            {
+                if (Traits::GetChildCount(node) > 0)
+                {
+                    return Traits::GetChild(node, 0);
+                }
+
+                // Going up until a parent has a next child.
+                for (; node != m_root; node = Traits::GetParent(node))
+                {
+                    const NodeType* parent = Traits::GetParent(node);
+                    const int nextChildIndex = Traits::GetChildIndex(parent, node) + 1;
+                    if (nextChildIndex < Traits::GetChildCount(parent))
+                    {
+                        return Traits::GetChild(parent, nextChildIndex);
+                    }
+                }
+                return nullptr;
+            }
+            else if constexpr (Order == TraversalOrder::InOrder)
+            {
+                // Children after the node are visited next.
+                if (const int childCountBeforeNode = Traits::GetChildCountBeforeNode(node);
+                    childCountBeforeNode < Traits::GetChildCount(node))
+                {
+                    return First(Traits::GetChild(node, childCountBeforeNode));
+                }
+
+                // Subtree finished, going up until a parent has something else to visit.
+                for (; node != m_root; node = Traits::GetParent(node))
+                {
+                    const NodeType* parent = Traits::GetParent(node);
+                    const int nextChildIndex = Traits::GetChildIndex(parent, node) + 1;
+                    if (nextChildIndex == Traits::GetChildCountBeforeNode(parent))
+                    {
+                        return parent;
+                    }
+                    else if (nextChildIndex < Traits::GetChildCount(parent))
+                    {
+                        return First(Traits::GetChild(parent, nextChildIndex));
+                    }
+                }
+                return nullptr;
+            }
+            else
+            {
+                if (node == m_root)
+                {
+                    return nullptr;
+                }
+
+                // Parent is visited after its last child.
+                const NodeType* parent = Traits::GetParent(node);
+                const int nextChildIndex = Traits::GetChildIndex(parent, node) + 1;
+                return (nextChildIndex < Traits::GetChildCount(parent))
+                    ? First(Traits::GetChild(parent, nextChildIndex))
+                    : parent;
+            }
+        }
+
+        const NodeType* m_root = nullptr; // Traversal doesn't go above the root
+        const NodeType* m_node = nullptr;
+    };
+
+    TreeTraversalView() = default;
+    explicit TreeTraversalView(const NodeType* root)
+        : m_root(root)
     {
-        return;
     }
 
-    std::ranges::for_each(node->m_children, [](const Node* child) { TraversePostOrder(child); });
+    Iterator begin() const
+    {
+        return Iterator(m_root);
+    }
+
+    std::default_sentinel_t end() const
+    {
+        return std::default_sentinel;
+    }
+
+private:
+    const NodeType* m_root = nullptr;
+};
+
+template<typename NodeType>
+TreeTraversalView<NodeType, TraversalOrder::PreOrder> PreOrder(const NodeType* root)
+{
+    return TreeTraversalView<NodeType, TraversalOrder::PreOrder>(root);
+}
 
-    std::printf("%d ", node->m_nodeData);
+template<typename NodeType>
+TreeTraversalView<NodeType, TraversalOrder::InOrder> InOrder(const NodeType* root)
+{
+    return TreeTraversalView<NodeType, TraversalOrder::InOrder>(root);
 }
 
-void TraverseDepthFirst_NonRecursive(const Node* node)
+template<typename NodeType>
+TreeTraversalView<NodeType, TraversalOrder::PostOrder> PostOrder(const NodeType* root)
 {
-    std::stack<const Node*> stack;
-    stack.push(node);
+    return TreeTraversalView<NodeType, TraversalOrder::PostOrder>(root);
+}
+
+// Each node is added once to the queue, so the queue is a vector with a read position
+// that never removes elements. Its memory is reused when traversing again with the same queue.
+// Starting to iterate clears the queue, so it can only be iterated once at a time.
+template<typename NodeType>
+class BreathFirstView : public std::ranges::view_interface<BreathFirstView<NodeType>>
+{
+    using Traits = TreeTraits<NodeType>;
 
-    while (!stack.empty())
+public:
+    class Iterator
     {
-        const Node* visit = stack.top();
-        stack.pop();
+    public:
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        explicit Iterator(std::vector<const NodeType*>* queue)
+            : m_queue(queue)
+        {
+        }
+
+        int operator*() const
+        {
+            return GetNode()->m_nodeData;
+        }
+
+        const NodeType* GetNode() const
+        {
+            return (*m_queue)[m_queueFront];
+        }
 
-        std::printf("%d ", visit->m_nodeData);
+        // Adds the children of the current node to the queue before moving to the next one.
+        Iterator& operator++()
+        {
+            const NodeType* node = GetNode();
+            for (int i = 0; i < Traits::GetChildCount(node); ++i)
+            {
+                m_queue->push_back(Traits::GetChild(node, i));
+            }
+            ++m_queueFront;
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++(*this);
+        }
+
+        bool operator==(std::default_sentinel_t) const
+        {
+            return !m_queue || m_queueFront >= m_queue->size();
+        }
 
-        // Notice the reverse order!
-        std::ranges::for_each(visit->m_children | std::views::reverse, [&stack](const Node* child) { stack.push(child); });
+    private:
+        std::vector<const NodeType*>* m_queue = nullptr;
+        std::size_t m_queueFront = 0;
+    };
+
+    BreathFirstView() = default;
+    BreathFirstView(const NodeType* root, std::vector<const NodeType*>& queue)
+        : m_root(root)
+        , m_queue(&queue)
+    {
     }
-}
 
-void TraverseBreathFirst_NonRecursive(const Node* node)
-{
-    std::queue<const Node*> queue;
-    queue.push(node);
+    Iterator begin() const
+    {
+        m_queue->clear(); // Keeps capacity
+        if (m_root)
+        {
+            m_queue->push_back(m_root);
+        }
+        return Iterator(m_queue);
+    }
 
-    while (!queue.empty())
+    std::default_sentinel_t end() const
     {
-        const Node* visit = queue.front();
-        queue.pop();
+        return std::default_sentinel;
+    }
+
+private:
+    const NodeType* m_root = nullptr;
+    std::vector<const NodeType*>* m_queue = nullptr;
+};
+
+template<typename NodeType>
+BreathFirstView<NodeType> BreathFirst(const NodeType* root, std::vector<const NodeType*>& queue)
+{
+    return BreathFirstView<NodeType>(root, queue);
+}
 
-        std::printf("%d ", visit->m_nodeData);
+// Traversals printing the data of the nodes, using the views.
 
-        std::ranges::for_each(visit->m_children, [&queue](const Node* child) { queue.push(child); });
+template<std::ranges::input_range Range>
+void PrintTraversal(Range&& traversal)
+{
+    for (int data : traversal)
+    {
+        std::printf("%d ", data);
     }
 }
 
+void TraversePreOrder(const Node* node)
+{
+    PrintTraversal(PreOrder(node));
+}
+
+void TraverseInOrder(const Node* node)
+{
+    PrintTraversal(InOrder(node));
+}
+
+void TraversePostOrder(const Node* node)
+{
+    PrintTraversal(PostOrder(node));
+}
+
+void TraverseDepthFirst_NonRecursive(const Node* node)
+{
+    // Depth first is the pre order traversal.
+    PrintTraversal(PreOrder(node));
+}
+
+void TraverseBreathFirst_NonRecursive(const Node* node)
+{
+    // Use BreathFirst with a queue that outlives the call to reuse its memory.
+    std::vector<const Node*> queue;
+    PrintTraversal(BreathFirst(node, queue));
+}
+
 void Trees()
 {
     Node* treeRoot = new Node(1);
@@ -138,7 +519,7 @@ void Trees()
     child3->AddChild(9);
 
     std::printf("TraversePreOrder: ");
-    TraversePreOrder(treeRoot); // This is a recursive TraverseDepthFirst
+    TraversePreOrder(treeRoot); // Same as TraverseDepthFirst
     std::printf("\n");
 
     std::printf("TraverseInOrder: ");
@@ -157,7 +538,48 @@ void Trees()
     TraverseBreathFirst_NonRecursive(treeRoot);
     std::printf("\n");
 
+    // Views compose with other views and stop as soon as they are not needed.
+    std::printf("PreOrder first 3 odd nodes: ");
+    PrintTraversal(PreOrder(treeRoot)
+        | std::views::filter([](int data) { return data % 2 != 0; })
+        | std::views::take(3));
+    std::printf("\n");
+
+    std::printf("PostOrder 10x: ");
+    PrintTraversal(PostOrder(treeRoot) | std::views::transform([](int data) { return data * 10; }));
+    std::printf("\n");
+
     delete treeRoot;
+
+    // Same tree allocated from an arena
+    {
+        std::pmr::monotonic_buffer_resource arena;
+
+        Node* arenaTreeRoot = Node::Create(1, nullptr, &arena);
+        arenaTreeRoot->AddChild(2);
+        arenaTreeRoot->AddChild(3)->AddChild(5);
+        arenaTreeRoot->AddChild(4)->AddChild(8);
+
+        std::printf("Arena TraversePreOrder: ");
+        TraversePreOrder(arenaTreeRoot);
+        std::printf("\n");
+    } // All the nodes are freed at once with the arena
+
+    // Same tree with SmallNode, none of the nodes has more than 4 children,
+    // so the lists of children are inside the nodes and never allocate.
+    {
+        SmallNode* smallTreeRoot = SmallNode::Create(1);
+        smallTreeRoot->AddChild(2);
+        smallTreeRoot->AddChild(3)->AddChild(5);
+        smallTreeRoot->AddChild(4)->AddChild(8);
+
+        std::printf("SmallNode TraversePreOrder: ");
+        PrintTraversal(PreOrder(smallTreeRoot));
+        std::printf(" (children inline: %s)\n", smallTreeRoot->m_children.IsInline() ? "yes" : "no");
+
+        delete smallTreeRoot;
+    }
+
     std::printf("\n");
 }
 
@@ -172,20 +594,40 @@ void Trees()
 // 
 // For fast node insertion, removal and search: 
 // O(log n) best case, O(n) worst case if very unbalanced.
+// 
+// As Node, it can allocate its nodes from an arena.
 // --------------------------------------------------------------------------------
 
 struct NodeBST
 {
     NodeBST() = default;
-    NodeBST(int data, NodeBST* parent = nullptr)
+    NodeBST(int data, NodeBST* parent = nullptr, std::pmr::memory_resource* arena = nullptr)
         : m_nodeData(data)
         , m_parent(parent)
+        , m_arena(arena)
     {
     }
     ~NodeBST()
     {
-        delete m_left;
-        delete m_right;
+        // Nodes of an arena are freed with the arena
+        if (!m_arena)
+        {
+            delete m_left;
+            delete m_right;
+        }
+    }
+
+    // Creates a node with new, or from the arena if not null.
+    // Nodes from an arena must not be deleted.
+    static NodeBST* Create(int data, NodeBST* parent = nullptr, std::pmr::memory_resource* arena = nullptr)
+    {
+        if (!arena)
+        {
+            return new NodeBST(data, parent);
+        }
+
+        void* memory = arena->allocate(sizeof(NodeBST), alignof(NodeBST));
+        return new (memory) NodeBST(data, parent, arena);
     }
 
     // Insert node into tree, it will keep it sorted. O(log n)
@@ -216,8 +658,30 @@ struct NodeBST
     NodeBST* m_parent = nullptr;
     NodeBST* m_left = nullptr;
     NodeBST* m_right = nullptr;
+    std::pmr::memory_resource* m_arena = nullptr; // Null when allocated with new
+
+private:
+    // Destroys this node only, its children must have been moved elsewhere.
+    // Nodes of an arena are given back to it, so pool resources can reuse them.
+    void DestroyDetached();
 };
 
+void NodeBST::DestroyDetached()
+{
+    m_left = nullptr;
+    m_right = nullptr;
+
+    if (std::pmr::memory_resource* arena = m_arena)
+    {
+        this->~NodeBST();
+        arena->deallocate(this, sizeof(NodeBST), alignof(NodeBST));
+    }
+    else
+    {
+        delete this;
+    }
+}
+
 
 NodeBST* NodeBST::Insert(int data)
 {
@@ -229,7 +693,7 @@ NodeBST* NodeBST::Insert(int data)
         }
         else
         {
-            m_right = new NodeBST(data, this);
+            m_right = Create(data, this, m_arena);
             return m_right;
         }
     }
@@ -241,7 +705,7 @@ NodeBST* NodeBST::Insert(int data)
         }
         else
         {
-            m_left = new NodeBST(data, this);
+            m_left = Create(data, this, m_arena);
             return m_left;
         }
     }
@@ -289,64 +753,44 @@ NodeBST* NodeBST::Delete(int data)
             NodeBST* parent = m_parent;
             if (IsRoot())
             {
-                delete this;
+                DestroyDetached();
                 return nullptr; // No more nodes in the tree
             }
             else if (this == parent->m_left)
             {
                 parent->m_left = nullptr;
-                delete this;
+                DestroyDetached();
                 return parent;
             }
             else
             {
                 parent->m_right = nullptr;
-                delete this;
+                DestroyDetached();
                 return parent;
             }
         }
         // Case 2: One child. Simple case, delete node and connect child to parent.
-        else if (m_right == nullptr)
+        // Node is detached from the child first, otherwise deleting it would delete the child too.
+        else if (m_right == nullptr || m_left == nullptr)
         {
             NodeBST* parent = m_parent;
-            NodeBST* child = m_left;
+            NodeBST* child = (m_left) ? m_left : m_right;
+            child->m_parent = parent;
             if (IsRoot())
             {
-                delete this;
+                DestroyDetached();
                 return child; // Child is new root
             }
             else if (this == parent->m_left)
             {
                 parent->m_left = child;
-                delete this;
+                DestroyDetached();
                 return parent;
             }
             else
             {
                 parent->m_right = child;
-                delete this;
-                return parent;
-            }
-        }
-        else if (m_left == nullptr)
-        {
-            NodeBST* parent = m_parent;
-            NodeBST* child = m_right;
-            if (IsRoot())
-            {
-                delete this;
-                return child; // Child is new root
-            }
-            else if (this == parent->m_left)
-            {
-                parent->m_left = child;
-                delete this;
-                return parent;
-            }
-            else
-            {
-                parent->m_right = child;
-                delete this;
+                DestroyDetached();
                 return parent;
             }
         }
@@ -376,63 +820,18 @@ NodeBST* NodeBST::Delete(int data)
 
 void TraverseInOrder(const NodeBST* node)
 {
-    if (!node)
-    {
-        return;
-    }
-
-    TraverseInOrder(node->m_left);
-
-    std::printf("%d ", node->m_nodeData);
-
-    TraverseInOrder(node->m_right);
+    PrintTraversal(InOrder(node));
 }
 
 void TraverseDepthFirst_NonRecursive(const NodeBST* node)
 {
-    std::stack<const NodeBST*> stack;
-    stack.push(node);
-
-    while (!stack.empty())
-    {
-        const NodeBST* visit = stack.top();
-        stack.pop();
-
-        std::printf("%d ", visit->m_nodeData);
-
-        // Notice the reverse order!
-        if (visit->m_right)
-        {
-            stack.push(visit->m_right);
-        }
-        if (visit->m_left)
-        {
-            stack.push(visit->m_left);
-        }
-    }
+    PrintTraversal(PreOrder(node));
 }
 
 void TraverseBreathFirst_NonRecursive(const NodeBST* node)
 {
-    std::queue<const NodeBST*> queue;
-    queue.push(node);
-
-    while (!queue.empty())
-    {
-        const NodeBST* visit = queue.front();
-        queue.pop();
-
-        std::printf("%d ", visit->m_nodeData);
-
-        if (visit->m_left)
-        {
-            queue.push(visit->m_left);
-        }
-        if (visit->m_right)
-        {
-            queue.push(visit->m_right);
-        }
-    }
+    std::vector<const NodeBST*> queue;
+    PrintTraversal(BreathFirst(node, queue));
 }
 
 void BinarySearchTree()
@@ -473,6 +872,24 @@ void BinarySearchTree()
     std::printf("\n");
 
     delete treeRoot;
+
+    // Same tree allocated from a pool, which reuses the memory of deleted nodes
+    {
+        std::pmr::unsynchronized_pool_resource arena;
+
+        NodeBST* arenaTreeRoot = NodeBST::Create(30, nullptr, &arena);
+        for (int data : { 23, 35, 11, 25, 31, 42 })
+        {
+            arenaTreeRoot->Insert(data);
+        }
+
+        arenaTreeRoot->Delete(23);
+
+        std::printf("Arena BST Deleted 23: ");
+        TraverseDepthFirst_NonRecursive(arenaTreeRoot);
+        std::printf("\n");
+    } // All the nodes are freed at once with the arena
+
     std::printf("\n");
 }
 
@@ -488,25 +905,630 @@ void BinarySearchTree()
 // - AA Tree (https://en.wikipedia.org/wiki/AA_tree)
 // --------------------------------------------------------------------------------
 
-// --------------------------------------------------------------------------------
-// B-Tree
-// 
-// Generalization of BST where each node can hold more than 1 keys (data). In B-Trees,
-// a node with n keys have n+1 children nodes. The benefit of B-Trees is that each node
-// holds more information, this reduces the height of the tree, and in case memory
-// is an issue and cannot fit the entire tree in memory, it might be able to keep one node
-// in memory and do operations with it.
+// AVL Tree: for every node the heights of its left and right subtrees differ at most by 1.
+// After inserting or deleting a node, the nodes on the way up to the root are rebalanced
+// with rotations, which keeps the height of the tree under 1.44 log n.
 // 
-// For more details on B-Tress see https://algorithmtutor.com/Data-Structures/Tree/B-Trees/
+// Unlike NodeBST, the functions are iterative instead of recursive, using the parent
+// pointers to go up, so they never overflow the stack regardless of the input order.
 // 
-// B-Tree implementations:
-// - 2-3 Tree (https://algorithmtutor.com/Data-Structures/Tree/2-3-Trees/)
-// - 2-3-4 Tree (https://algorithmtutor.com/Data-Structures/Tree/2-3-4-Trees/)
-// --------------------------------------------------------------------------------
+// Like Node and NodeBST, the nodes can be allocated from an arena.
 
-// --------------------------------------------------------------------------------
-// Trie. Aka digital tree, radix tree or prefix tree.
-// 
+struct NodeAVL
+{
+    int m_nodeData = 0;
+    int m_height = 0; // Height of the subtree, 0 for leaves.
+
+    NodeAVL* m_parent = nullptr;
+    NodeAVL* m_left = nullptr;
+    NodeAVL* m_right = nullptr;
+};
+
+class AVLTree
+{
+public:
+    AVLTree(std::pmr::memory_resource* arena = nullptr)
+        : m_arena(arena)
+    {
+    }
+
+    // Builds a perfectly balanced tree from sorted data. O(n)
+    // Much faster than inserting the nodes one by one, which is O(n log n) and does rotations.
+    AVLTree(std::span<const int> sortedData, std::pmr::memory_resource* arena = nullptr)
+        : m_arena(arena)
+        , m_size(sortedData.size())
+    {
+        m_root = BuildSorted(sortedData, nullptr);
+    }
+
+    ~AVLTree()
+    {
+        // Nodes of an arena are freed with the arena
+        if (m_arena)
+        {
+            return;
+        }
+
+        // Deletes all the nodes without recursion nor a stack, rotating
+        // the left children up until the node to delete has no left child.
+        NodeAVL* node = m_root;
+        while (node)
+        {
+            if (NodeAVL* left = node->m_left)
+            {
+                node->m_left = left->m_right;
+                left->m_right = node;
+                node = left;
+            }
+            else
+            {
+                NodeAVL* right = node->m_right;
+                delete node;
+                node = right;
+            }
+        }
+    }
+
+    AVLTree(const AVLTree&) = delete;
+    AVLTree& operator=(const AVLTree&) = delete;
+
+    // Insert node into tree, it will keep it sorted and balanced. O(log n)
+    // Returns the new node.
+    const NodeAVL* Insert(int data)
+    {
+        NodeAVL* parent = nullptr;
+        NodeAVL** link = &m_root;
+        while (*link)
+        {
+            parent = *link;
+            link = (data > parent->m_nodeData) ? &parent->m_right : &parent->m_left;
+        }
+
+        NodeAVL* node = CreateNode(data, parent);
+        *link = node;
+        ++m_size;
+
+        Rebalance(parent);
+        return node;
+    }
+
+    // Find node into tree. O(log n)
+    // Returns null if the node doesn't exist.
+    const NodeAVL* Find(int data) const
+    {
+        NodeAVL* node = m_root;
+        while (node && node->m_nodeData != data)
+        {
+            node = (data > node->m_nodeData) ? node->m_right : node->m_left;
+        }
+        return node;
+    }
+
+    // Delete node from tree, it will keep it sorted and balanced. O(log n)
+    // Returns false if the node doesn't exist.
+    bool Delete(int data)
+    {
+        NodeAVL* node = const_cast<NodeAVL*>(Find(data));
+        if (!node)
+        {
+            return false;
+        }
+
+        // With two children, replace with max value node under left child,
+        // then delete that node instead, which has one child at most.
+        if (node->m_left && node->m_right)
+        {
+            NodeAVL* maxInLeftChild = node->m_left;
+            while (maxInLeftChild->m_right)
+            {
+                maxInLeftChild = maxInLeftChild->m_right;
+            }
+            node->m_nodeData = maxInLeftChild->m_nodeData;
+            node = maxInLeftChild;
+        }
+
+        // Connect the only child (if any) to the parent.
+        NodeAVL* parent = node->m_parent;
+        NodeAVL* child = (node->m_left) ? node->m_left : node->m_right;
+        if (child)
+        {
+            child->m_parent = parent;
+        }
+        ReplaceChild(parent, node, child);
+
+        DestroyNode(node);
+        --m_size;
+
+        Rebalance(parent);
+        return true;
+    }
+
+    const NodeAVL* GetRoot() const
+    {
+        return m_root;
+    }
+
+    std::size_t GetSize() const
+    {
+        return m_size;
+    }
+
+    // Height of the tree, -1 when empty.
+    int GetHeight() const
+    {
+        return Height(m_root);
+    }
+
+private:
+    static int Height(const NodeAVL* node)
+    {
+        return (node) ? node->m_height : -1;
+    }
+
+    static int BalanceFactor(const NodeAVL* node)
+    {
+        return Height(node->m_left) - Height(node->m_right);
+    }
+
+    static void UpdateHeight(NodeAVL* node)
+    {
+        node->m_height = 1 + std::max(Height(node->m_left), Height(node->m_right));
+    }
+
+    NodeAVL* CreateNode(int data, NodeAVL* parent)
+    {
+        NodeAVL* node = (m_arena)
+            ? new (m_arena->allocate(sizeof(NodeAVL), alignof(NodeAVL))) NodeAVL()
+            : new NodeAVL();
+        node->m_nodeData = data;
+        node->m_parent = parent;
+        return node;
+    }
+
+    void DestroyNode(NodeAVL* node)
+    {
+        if (m_arena)
+        {
+            node->~NodeAVL();
+            m_arena->deallocate(node, sizeof(NodeAVL), alignof(NodeAVL));
+        }
+        else
+        {
+            delete node;
+        }
+    }
+
+    // Recursion depth is only log n, as each call halves the data.
+    NodeAVL* BuildSorted(std::span<const int> sortedData, NodeAVL* parent)
+    {
+        if (sortedData.empty())
+        {
+            return nullptr;
+        }
+
+        const std::size_t middle = sortedData.size() / 2;
+
+        NodeAVL* node = CreateNode(sortedData[middle], parent);
+        node->m_left = BuildSorted(sortedData.first(middle), node);
+        node->m_right = BuildSorted(sortedData.subspan(middle + 1), node);
+        UpdateHeight(node);
+        return node;
+    }
+
+    // Makes parent point to the new child instead of the old one.
+    // Without parent the old child was the root.
+    void ReplaceChild(NodeAVL* parent, NodeAVL* oldChild, NodeAVL* newChild)
+    {
+        if (!parent)
+        {
+            m_root = newChild;
+        }
+        else if (parent->m_left == oldChild)
+        {
+            parent->m_left = newChild;
+        }
+        else
+        {
+            parent->m_right = newChild;
+        }
+    }
+
+    // Right child takes the place of the node, which becomes its left child.
+    // The left subtree of the right child becomes the right subtree of the node.
+    // Returns the node that took its place.
+    NodeAVL* RotateLeft(NodeAVL* node)
+    {
+        NodeAVL* right = node->m_right;
+
+        node->m_right = right->m_left;
+        if (right->m_left)
+        {
+            right->m_left->m_parent = node;
+        }
+
+        right->m_parent = node->m_parent;
+        ReplaceChild(node->m_parent, node, right);
+
+        right->m_left = node;
+        node->m_parent = right;
+
+        UpdateHeight(node);
+        UpdateHeight(right);
+        return right;
+    }
+
+    // Mirror of RotateLeft.
+    NodeAVL* RotateRight(NodeAVL* node)
+    {
+        NodeAVL* left = node->m_left;
+
+        node->m_left = left->m_right;
+        if (left->m_right)
+        {
+            left->m_right->m_parent = node;
+        }
+
+        left->m_parent = node->m_parent;
+        ReplaceChild(node->m_parent, node, left);
+
+        left->m_right = node;
+        node->m_parent = left;
+
+        UpdateHeight(node);
+        UpdateHeight(left);
+        return left;
+    }
+
+    // Goes up from the node to the root updating the heights and rotating the unbalanced nodes.
+    // Stops early when a node keeps its height, as the nodes above are not affected then.
+    void Rebalance(NodeAVL* node)
+    {
+        while (node)
+        {
+            const int previousHeight = node->m_height;
+            UpdateHeight(node);
+
+            const int balanceFactor = BalanceFactor(node);
+            if (balanceFactor > 1)
+            {
+                // Left-Right case is converted to Left-Left case first.
+                if (BalanceFactor(node->m_left) < 0)
+                {
+                    RotateLeft(node->m_left);
+                }
+                node = RotateRight(node);
+            }
+            else if (balanceFactor < -1)
+            {
+                // Right-Left case is converted to Right-Right case first.
+                if (BalanceFactor(node->m_right) > 0)
+                {
+                    RotateRight(node->m_right);
+                }
+                node = RotateLeft(node);
+            }
+            else if (node->m_height == previousHeight)
+            {
+                break;
+            }
+
+            node = node->m_parent;
+        }
+    }
+
+    std::pmr::memory_resource* m_arena = nullptr; // Null when allocated with new
+    NodeAVL* m_root = nullptr;
+    std::size_t m_size = 0;
+};
+
+void TraverseInOrder(const NodeAVL* node)
+{
+    PrintTraversal(InOrder(node));
+}
+
+void SelfBalancingBinarySearchTree()
+{
+    // Sorted input, NodeBST would become a linked list.
+    AVLTree tree;
+    for (int data = 1; data <= 15; ++data)
+    {
+        tree.Insert(data);
+    }
+
+    std::printf("AVL Inserted 1 to 15: ");
+    TraverseInOrder(tree.GetRoot());
+    std::printf("(root %d height %d)\n", tree.GetRoot()->m_nodeData, tree.GetHeight());
+
+    tree.Delete(8);
+    tree.Delete(1);
+    tree.Delete(2);
+
+    std::printf("AVL Deleted 8, 1 and 2: ");
+    TraverseInOrder(tree.GetRoot());
+    std::printf("(root %d height %d)\n", tree.GetRoot()->m_nodeData, tree.GetHeight());
+
+    std::printf("AVL Find 5: %s, Find 8: %s\n",
+        tree.Find(5) ? "found" : "not found",
+        tree.Find(8) ? "found" : "not found");
+
+    // Building from sorted data
+    std::vector<int> sortedData(1000000);
+    std::iota(sortedData.begin(), sortedData.end(), 0);
+
+    const AVLTree sortedTree(sortedData);
+    std::printf("AVL built from %zu sorted elements: height %d\n", sortedTree.GetSize(), sortedTree.GetHeight());
+
+    std::printf("\n");
+}
+
+// --------------------------------------------------------------------------------
+// Eytzinger Layout
+// 
+// Immutable sorted data stored as an implicit binary search tree in an array, in the
+// same order as a breadth first traversal: root at index 1 and the children of node k
+// at indices 2k and 2k+1. No pointers are needed, so each node is just the key.
+// 
+// Binary search on a sorted array jumps around the whole array, and a BST has each
+// node somewhere in memory. With this layout the first levels of the tree are together
+// at the beginning of the array, and the 16 descendants 4 levels below a node are
+// contiguous in one cache line, so they can be prefetched while the 4 levels are searched.
+// 
+// https://algorithmica.org/en/eytzinger
+// --------------------------------------------------------------------------------
+
+namespace
+{
+    constexpr std::size_t CacheLineSize = 64;
+
+    // Allocates the elements aligned to the start of a cache line.
+    template<typename T>
+    struct CacheLineAllocator
+    {
+        using value_type = T;
+
+        CacheLineAllocator() = default;
+
+        template<typename U>
+        CacheLineAllocator(const CacheLineAllocator<U>&)
+        {
+        }
+
+        T* allocate(std::size_t count)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ CacheLineSize }));
+        }
+
+        void deallocate(T* pointer, [[maybe_unused]] std::size_t count)
+        {
+            ::operator delete(pointer, std::align_val_t{ CacheLineSize });
+        }
+
+        friend bool operator==(const CacheLineAllocator&, const CacheLineAllocator&)
+        {
+            return true;
+        }
+    };
+
+    // Asks the CPU to start loading the cache line of the address without waiting for it.
+    void Prefetch(const void* address)
+    {
+#if defined(_MSC_VER)
+        _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+        __builtin_prefetch(address);
+#endif
+    }
+}
+
+class EytzingerArray
+{
+public:
+    // Nodes 4 levels below a node, which fit in one cache line.
+    static constexpr std::size_t PrefetchDescendants = CacheLineSize / sizeof(int);
+
+    explicit EytzingerArray(std::span<const int> sortedData)
+        : m_keys(sortedData.size() + 1)
+    {
+        INSTRUMENT_ZONE("EytzingerArray build");
+
+        std::size_t sortedIndex = 0;
+        Build(sortedData, sortedIndex, 1);
+    }
+
+    // Find key in the array. O(log n)
+    // Returns null if the key doesn't exist.
+    const int* Find(int data) const
+    {
+        const std::size_t keyCount = m_keys.size();
+
+        // Goes down the tree without branches, left when the key is lower or
+        // equal to the node, right otherwise, until it falls out of the array.
+        std::size_t k = 1;
+        while (k < keyCount)
+        {
+            if (k * PrefetchDescendants < keyCount)
+            {
+                Prefetch(&m_keys[k * PrefetchDescendants]);
+            }
+            k = 2 * k + (m_keys[k] < data);
+        }
+
+        // The trailing 1s of k are the right turns taken after the last left turn,
+        // removing them and that last left turn gives the first key not lower than data.
+        k >>= std::countr_one(k) + 1;
+
+        return (k != 0 && m_keys[k] == data)
+            ? &m_keys[k]
+            : nullptr;
+    }
+
+    std::size_t GetSize() const
+    {
+        return m_keys.size() - 1;
+    }
+
+private:
+    // Assigns the sorted keys doing an in order traversal of the implicit tree.
+    // Recursion depth is only log n.
+    void Build(std::span<const int> sortedData, std::size_t& sortedIndex, std::size_t k)
+    {
+        if (k < m_keys.size())
+        {
+            Build(sortedData, sortedIndex, 2 * k);
+            m_keys[k] = sortedData[sortedIndex++];
+            Build(sortedData, sortedIndex, 2 * k + 1);
+        }
+    }
+
+    std::vector<int, CacheLineAllocator<int>> m_keys; // Index 0 is not used
+};
+
+void EytzingerLayout()
+{
+    const std::vector<int> sortedData = { 11, 23, 24, 25, 30, 31, 35, 42 };
+
+    const EytzingerArray eytzingerArray(sortedData);
+
+    std::printf("Eytzinger Find: ");
+    for (int data : { 11, 25, 42, 12, 50 })
+    {
+        const int* key = eytzingerArray.Find(data);
+        std::printf("%d %s, ", data, key ? "found" : "not found");
+    }
+    std::printf("\n\n");
+}
+
+// --------------------------------------------------------------------------------
+// B-Tree
+// 
+// Generalization of BST where each node can hold more than 1 keys (data). In B-Trees,
+// a node with n keys have n+1 children nodes. The benefit of B-Trees is that each node
+// holds more information, this reduces the height of the tree, and in case memory
+// is an issue and cannot fit the entire tree in memory, it might be able to keep one node
+// in memory and do operations with it.
+// 
+// For more details on B-Tress see https://algorithmtutor.com/Data-Structures/Tree/B-Trees/
+// 
+// B-Tree implementations:
+// - 2-3 Tree (https://algorithmtutor.com/Data-Structures/Tree/2-3-Trees/)
+// - 2-3-4 Tree (https://algorithmtutor.com/Data-Structures/Tree/2-3-4-Trees/)
+// --------------------------------------------------------------------------------
+
+// Static B-Tree: immutable B-Tree built from sorted data, where each node is 16 keys
+// that fill exactly one cache line. Searching a node compares data with its 16 keys
+// without branches, which compilers turn into a few SIMD instructions, so a search reads
+// only one cache line per level for a tree with a height of log17(n) instead of log2(n).
+// 
+// As with the Eytzinger layout, nodes don't have pointers to their children. The
+// nodes are in an array in breadth first order: the 17 children of node k start at
+// index 17k + 1. The last node is filled with the maximum int value when not full.
+// 
+// https://algorithmica.org/en/b-tree
+class StaticBTree
+{
+public:
+    static constexpr int KeysPerNode = CacheLineSize / sizeof(int);
+
+    explicit StaticBTree(std::span<const int> sortedData)
+        : m_nodes((sortedData.size() + KeysPerNode - 1) / KeysPerNode)
+        , m_size(sortedData.size())
+        , m_hasMaxKey(!sortedData.empty() && sortedData.back() == std::numeric_limits<int>::max())
+    {
+        INSTRUMENT_ZONE("StaticBTree build");
+
+        std::size_t sortedIndex = 0;
+        Build(sortedData, sortedIndex, 0);
+    }
+
+    // Find key in the tree. O(log n)
+    // Returns null if the key doesn't exist.
+    const int* Find(int data) const
+    {
+        // Padding keys are the maximum int value, they are not real keys.
+        if (data == std::numeric_limits<int>::max() && !m_hasMaxKey)
+        {
+            return nullptr;
+        }
+
+        const int* lowerBound = nullptr;
+        for (std::size_t k = 0; k < m_nodes.size(); )
+        {
+            const Node& node = m_nodes[k];
+
+            // Number of keys lower than data, which is also the child to go next.
+            int i = 0;
+            for (int j = 0; j < KeysPerNode; ++j)
+            {
+                i += (node.m_keys[j] < data);
+            }
+
+            if (i < KeysPerNode)
+            {
+                lowerBound = &node.m_keys[i];
+            }
+            k = k * (KeysPerNode + 1) + i + 1;
+        }
+
+        return (lowerBound && *lowerBound == data)
+            ? lowerBound
+            : nullptr;
+    }
+
+    std::size_t GetSize() const
+    {
+        return m_size;
+    }
+
+private:
+    struct alignas(CacheLineSize) Node
+    {
+        int m_keys[KeysPerNode];
+    };
+
+    // Assigns the sorted keys doing an in order traversal of the implicit tree.
+    // Recursion depth is only log17(n).
+    void Build(std::span<const int> sortedData, std::size_t& sortedIndex, std::size_t k)
+    {
+        if (k >= m_nodes.size())
+        {
+            return;
+        }
+
+        for (int j = 0; j < KeysPerNode; ++j)
+        {
+            Build(sortedData, sortedIndex, k * (KeysPerNode + 1) + j + 1);
+            m_nodes[k].m_keys[j] = (sortedIndex < sortedData.size())
+                ? sortedData[sortedIndex++]
+                : std::numeric_limits<int>::max();
+        }
+        Build(sortedData, sortedIndex, k * (KeysPerNode + 1) + KeysPerNode + 1);
+    }
+
+    std::vector<Node, CacheLineAllocator<Node>> m_nodes;
+    std::size_t m_size = 0;
+    bool m_hasMaxKey = false;
+};
+
+void BTree()
+{
+    std::vector<int> sortedData(100);
+    std::iota(sortedData.begin(), sortedData.end(), 0);
+    std::ranges::for_each(sortedData, [](int& data) { data *= 2; }); // Even numbers
+
+    const StaticBTree tree(sortedData);
+
+    std::printf("StaticBTree Find: ");
+    for (int data : { 0, 50, 198, 51, 200 })
+    {
+        const int* key = tree.Find(data);
+        std::printf("%d %s, ", data, key ? "found" : "not found");
+    }
+    std::printf("\n\n");
+}
+
+// --------------------------------------------------------------------------------
+// Trie. Aka digital tree, radix tree or prefix tree.
+// 
 // Useful to make dictionaries (words, phone numbers, etc.).
 // Nodes do not store their associated key, instead a node's position defines its
 // associated key.
@@ -546,3 +1568,254 @@ void BinarySearchTree()
 // 
 // STL offers std::priority_queue as an implementation of a heap (see DataStructures.cpp)
 // --------------------------------------------------------------------------------
+
+// --------------------------------------------------------------------------------
+// Benchmarks (run by bench executable)
+// --------------------------------------------------------------------------------
+
+void BenchmarkTrees()
+{
+    const int nodeCount = 1 << 20;
+
+    // Random order keeps the BST balanced enough for the recursive functions.
+    std::vector<int> keys(nodeCount);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::ranges::shuffle(keys, std::mt19937(42));
+
+    // Visits all the nodes in order without printing.
+    auto sumInOrder = [](const NodeBST* root)
+    {
+        long long sum = 0;
+        for (int data : InOrder(root))
+        {
+            sum += data;
+        }
+        return sum;
+    };
+
+    // Arena is null for new/delete.
+    auto benchmarkBST = [&](const char* allocationName, std::pmr::memory_resource* arena, auto freeTree)
+    {
+        char name[64];
+        NodeBST* root = nullptr;
+
+        const double insertTime = MeasureMilliseconds([&]()
+            {
+                root = NodeBST::Create(keys[0], nullptr, arena);
+                for (int i = 1; i < nodeCount; ++i)
+                {
+                    root->Insert(keys[i]);
+                }
+            });
+        std::snprintf(name, sizeof(name), "BST Insert (%s)", allocationName);
+        PrintBenchmark(name, insertTime, nodeCount);
+
+        const double findTime = MeasureMilliseconds([&]()
+            {
+                for (int key : keys)
+                {
+                    DoNotOptimize(root->Find(key));
+                }
+            });
+        std::snprintf(name, sizeof(name), "BST Find (%s)", allocationName);
+        PrintBenchmark(name, findTime, nodeCount);
+
+        const double traverseTime = MeasureMilliseconds([&]()
+            {
+                DoNotOptimize(sumInOrder(root));
+            });
+        std::snprintf(name, sizeof(name), "BST Traverse in order (%s)", allocationName);
+        PrintBenchmark(name, traverseTime, nodeCount);
+
+        const double freeTime = MeasureMilliseconds([&]()
+            {
+                freeTree(root);
+            });
+        std::snprintf(name, sizeof(name), "BST Free (%s)", allocationName);
+        PrintBenchmark(name, freeTime, nodeCount);
+    };
+
+    benchmarkBST("new/delete", nullptr, [](NodeBST* root) { delete root; });
+
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkBST("monotonic arena", &arena, [&arena](NodeBST*) { arena.release(); });
+    }
+
+    {
+        std::pmr::unsynchronized_pool_resource arena;
+        benchmarkBST("pool arena", &arena, [&arena](NodeBST*) { arena.release(); });
+    }
+
+    {
+        BumpResource arena;
+        benchmarkBST("BumpResource", &arena, [&arena](NodeBST*) { arena.Release(); });
+    }
+
+    {
+        PoolResource arena;
+        benchmarkBST("PoolResource", &arena, [&arena](NodeBST*) { arena.Release(); });
+    }
+
+    // Sorted keys (like timestamps) would overflow the stack with NodeBST.
+    std::vector<int> sortedKeys(nodeCount);
+    std::iota(sortedKeys.begin(), sortedKeys.end(), 0);
+
+    {
+        AVLTree tree;
+        const double insertTime = MeasureMilliseconds([&]()
+            {
+                // Around the whole batch, a zone per Insert would mostly measure itself.
+                INSTRUMENT_ZONE("AVLTree::Insert batch");
+                for (int key : sortedKeys)
+                {
+                    tree.Insert(key);
+                }
+            });
+        PrintBenchmark("AVL Insert sorted (new/delete)", insertTime, nodeCount);
+
+        const double findTime = MeasureMilliseconds([&]()
+            {
+                for (int key : keys)
+                {
+                    DoNotOptimize(tree.Find(key));
+                }
+            });
+        PrintBenchmark("AVL Find (new/delete)", findTime, nodeCount);
+    }
+
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        const double buildTime = MeasureMilliseconds([&]()
+            {
+                const AVLTree tree(sortedKeys, &arena);
+                DoNotOptimize(tree.GetRoot());
+            });
+        PrintBenchmark("AVL Build from sorted (monotonic arena)", buildTime, nodeCount);
+    }
+
+    // Trees with 1 to 4 children per node, where SmallNode never allocates its list of children.
+    std::mt19937 randomEngine(42);
+    std::uniform_int_distribution<int> randomChildCount(1, 4);
+    std::vector<int> childCounts(nodeCount);
+    std::ranges::generate(childCounts, [&]() { return randomChildCount(randomEngine); });
+
+    // Arena is null for new/delete.
+    auto benchmarkTree = [&]<typename NodeType>(const char* nodeName, std::pmr::memory_resource* arena, const NodeType*)
+    {
+        char name[64];
+        const char* allocationName = arena ? "monotonic arena" : "new/delete";
+        NodeType* root = nullptr;
+
+        // Breath first, so each node gets all its children before the next node.
+        const double buildTime = MeasureMilliseconds([&]()
+            {
+                std::vector<NodeType*> queue;
+                queue.reserve(nodeCount);
+                root = NodeType::Create(0, nullptr, arena);
+                queue.push_back(root);
+                for (int i = 0; static_cast<int>(queue.size()) < nodeCount; ++i)
+                {
+                    for (int j = 0; j < childCounts[i] && static_cast<int>(queue.size()) < nodeCount; ++j)
+                    {
+                        queue.push_back(queue[i]->AddChild(static_cast<int>(queue.size())));
+                    }
+                }
+            });
+        std::snprintf(name, sizeof(name), "%s Build (%s)", nodeName, allocationName);
+        PrintBenchmark(name, buildTime, nodeCount);
+
+        const double traverseTime = MeasureMilliseconds([&]()
+            {
+                long long sum = 0;
+                for (int data : PreOrder(static_cast<const NodeType*>(root)))
+                {
+                    sum += data;
+                }
+                DoNotOptimize(sum);
+            });
+        std::snprintf(name, sizeof(name), "%s Traverse pre order (%s)", nodeName, allocationName);
+        PrintBenchmark(name, traverseTime, nodeCount);
+
+        // Nodes of an arena are freed with the arena
+        if (!arena)
+        {
+            const double freeTime = MeasureMilliseconds([&]()
+                {
+                    delete root;
+                });
+            std::snprintf(name, sizeof(name), "%s Free (%s)", nodeName, allocationName);
+            PrintBenchmark(name, freeTime, nodeCount);
+        }
+    };
+
+    benchmarkTree("Node", nullptr, static_cast<const Node*>(nullptr));
+    benchmarkTree("SmallNode", nullptr, static_cast<const SmallNode*>(nullptr));
+
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        benchmarkTree("Node", &arena, static_cast<const Node*>(nullptr));
+        arena.release();
+        benchmarkTree("SmallNode", &arena, static_cast<const SmallNode*>(nullptr));
+    }
+
+    std::printf("\n");
+}
+
+void BenchmarkTreeSearch()
+{
+    for (int keyCount : { 1 << 12, 1 << 20 })
+    {
+        // Even keys, so odd keys can be searched to miss.
+        std::vector<int> sortedKeys(keyCount);
+        for (int i = 0; i < keyCount; ++i)
+        {
+            sortedKeys[i] = 2 * i;
+        }
+
+        const int queryCount = 1 << 20;
+        std::mt19937 randomEngine(42);
+        std::uniform_int_distribution<int> randomKey(0, 2 * keyCount - 1);
+        std::vector<int> queries(queryCount);
+        std::ranges::generate(queries, [&]() { return randomKey(randomEngine); });
+
+        std::vector<int> shuffledKeys = sortedKeys;
+        std::ranges::shuffle(shuffledKeys, randomEngine);
+
+        std::pmr::monotonic_buffer_resource arena;
+        NodeBST* bstRoot = NodeBST::Create(shuffledKeys[0], nullptr, &arena);
+        std::ranges::for_each(shuffledKeys | std::views::drop(1), [bstRoot](int key) { bstRoot->Insert(key); });
+
+        const AVLTree avlTree(sortedKeys, &arena);
+        const std::set<int> set(sortedKeys.begin(), sortedKeys.end());
+        const EytzingerArray eytzingerArray(sortedKeys);
+        const StaticBTree staticBTree(sortedKeys);
+
+        // Finds all the queries with the find function, which returns if the key was found.
+        auto benchmarkFind = [keyCount, &queries](const char* structureName, auto find)
+        {
+            char name[64];
+            int foundCount = 0;
+            const double findTime = MeasureMilliseconds([&]()
+                {
+                    for (int query : queries)
+                    {
+                        foundCount += find(query);
+                    }
+                });
+            DoNotOptimize(foundCount);
+
+            std::snprintf(name, sizeof(name), "Find %d keys (%s)", keyCount, structureName);
+            PrintBenchmark(name, findTime, queries.size());
+        };
+
+        benchmarkFind("NodeBST", [bstRoot](int key) { return bstRoot->Find(key) != nullptr; });
+        benchmarkFind("AVLTree", [&avlTree](int key) { return avlTree.Find(key) != nullptr; });
+        benchmarkFind("std::set", [&set](int key) { return set.contains(key); });
+        benchmarkFind("std::ranges::binary_search", [&sortedKeys](int key) { return std::ranges::binary_search(sortedKeys, key); });
+        benchmarkFind("EytzingerArray", [&eytzingerArray](int key) { return eytzingerArray.Find(key) != nullptr; });
+        benchmarkFind("StaticBTree", [&staticBTree](int key) { return staticBTree.Find(key) != nullptr; });
+    }
+
+    std::printf("\n");
+}
@@ -1,6 +1,9 @@
 #include <cstdio>
 
+#include "Instrumentation.h"
+
 void Arrays();
+void SmallVectorsAndStaticVectors();
 void LinkedLists();
 void Stacks();
 void Queues();
@@ -8,17 +11,24 @@ void PriorityQueues();
 void Deques();
 void Sets();
 void Maps();
+void FlatMapsAndFlatSets();
 void UnorderedSets();
 void UnorderedMaps();
+void FlatHashTables();
+void Arenas();
 
 void Threads();
 void Mutex();
 void LockMultipleMutex();
 void SharedMutex();
+void ReadMostlyData();
 void Atomics();
+void ShardedCounters();
 void ConditionalVariables();
 void Semaphores();
 void PromiseAndFuture();
+void ThreadPools();
+void LockFreeQueues();
 
 void Reduce();
 void TransformReduceWith2Ranges();
@@ -35,9 +45,11 @@ void OtherAlgorithms();
 void File();
 void FileStreams();
 void FileSystem();
+void MemoryMappedFiles();
 
 void StandardStreamObjects();
 void StringStreams();
+void CharConversions();
 
 void Traits();
 void TraitsConcepts();
@@ -45,6 +57,7 @@ void TraitsConcepts();
 void ThreeWayComparisonOperator();
 void Concepts();
 void Coroutines();
+void CoroutineTasks();
 void Modules();
 
 void Ranges();
@@ -55,11 +68,18 @@ void RangeFactories();
 
 void Trees();
 void BinarySearchTree();
+void SelfBalancingBinarySearchTree();
+void EytzingerLayout();
+void BTree();
 
 void GraphsAsEdgeList();
 void GraphsAsAdjacencyMatrix();
 void GraphsAsAdjacencyList();
+void GraphsAsCSR();
 void GraphsTraverse();
+void GraphsParallelBreathFirstSearch();
+void GraphsDijkstra();
+void GraphsAStar();
 
 int main(int argc, char* argsv[])
 {
@@ -67,6 +87,7 @@ int main(int argc, char* argsv[])
 
     // Data Structures
     Arrays();
+    SmallVectorsAndStaticVectors();
     LinkedLists();
     Stacks();
     Queues();
@@ -74,18 +95,25 @@ int main(int argc, char* argsv[])
     Deques();
     Sets();
     Maps();
+    FlatMapsAndFlatSets();
     UnorderedSets();
     UnorderedMaps();
+    FlatHashTables();
+    Arenas();
 
     // Concurrency
     Threads();
     Mutex();
     LockMultipleMutex();
     SharedMutex();
+    ReadMostlyData();
     Atomics();
+    ShardedCounters();
     ConditionalVariables();
     Semaphores();
     PromiseAndFuture();
+    ThreadPools();
+    LockFreeQueues();
 
     // Algorithms
     Reduce(); TransformReduceWith2Ranges();        // Index 1 / Accumulator YES / Operation Reduce
@@ -102,10 +130,12 @@ int main(int argc, char* argsv[])
     File();
     FileStreams();
     FileSystem();
+    MemoryMappedFiles();
 
     // Streams
     StandardStreamObjects();
     StringStreams();
+    CharConversions();
 
     // Traits
     Traits();
@@ -115,6 +145,7 @@ int main(int argc, char* argsv[])
     ThreeWayComparisonOperator();
     Concepts();
     Coroutines();
+    CoroutineTasks();
     Modules();
 
     // C++20 Ranges
@@ -127,12 +158,22 @@ int main(int argc, char* argsv[])
     // Trees
     Trees();
     BinarySearchTree();
+    SelfBalancingBinarySearchTree();
+    EytzingerLayout();
+    BTree();
 
     // Graphs
     GraphsAsEdgeList();
     GraphsAsAdjacencyMatrix();
     GraphsAsAdjacencyList();
+    GraphsAsCSR();
     GraphsTraverse();
+    GraphsParallelBreathFirstSearch();
+    GraphsDijkstra();
+    GraphsAStar();
+
+    // Measurements of the instrumented zones, empty unless INSTRUMENTATION_ENABLED is 1
+    Instrumentation::PrintZones();
 
     return 0;
 }